@@ -0,0 +1,124 @@
+#include "imu_adv_registry.h"
+#include <algorithm>
+#include <cstdio>
+
+// Hex digit values, 0xFF for anything else. A table rather than range
+// compares: the digits of random addresses defeat the branch predictor.
+struct HexTable {
+    uint8_t v[256];
+    constexpr HexTable() : v() {
+        for (int c = 0; c < 256; ++c) v[c] = 0xFF;
+        for (int c = 0; c < 10; ++c) v['0' + c] = uint8_t(c);
+        for (int c = 0; c < 6; ++c) v['a' + c] = v['A' + c] = uint8_t(10 + c);
+    }
+};
+static constexpr HexTable kHex;
+
+uint64_t imu_pack_mac(const std::string& text) {
+    if (text.size() != 17) return kInvalidMac;
+    const auto* p = reinterpret_cast<const unsigned char*>(text.data());
+    uint64_t mac = 0;
+    unsigned bad = 0;
+    for (size_t i = 0; i < 17; i += 3) {
+        const uint8_t hi = kHex.v[p[i]], lo = kHex.v[p[i + 1]];
+        bad |= (hi | lo) & 0xF0u;
+        if (i + 2 < 17) bad |= unsigned(p[i + 2] != ':' && p[i + 2] != '-');
+        mac = (mac << 8) | uint64_t(hi << 4 | lo);
+    }
+    return bad ? kInvalidMac : mac;
+}
+
+std::string imu_format_mac(uint64_t mac) {
+    char buf[18];
+    std::snprintf(buf, sizeof(buf), "%02x:%02x:%02x:%02x:%02x:%02x",
+                  unsigned(mac >> 40) & 0xFFu, unsigned(mac >> 32) & 0xFFu, unsigned(mac >> 24) & 0xFFu,
+                  unsigned(mac >> 16) & 0xFFu, unsigned(mac >> 8) & 0xFFu, unsigned(mac) & 0xFFu);
+    return buf;
+}
+
+ImuAdvRegistry::ImuAdvRegistry(const ImuScanConfig& cfg) : cfg_(cfg) {
+    cfg_.rssi_alpha = std::clamp(cfg_.rssi_alpha, 0.01, 1.0);
+}
+
+void ImuAdvRegistry::set_targets(const std::vector<std::string>& macs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    targets_.clear();
+    for (const auto& m : macs) {
+        const uint64_t mac = imu_pack_mac(m);
+        if (mac != kInvalidMac) targets_.insert(mac);
+    }
+    // Earlier verdicts may not hold for the new list
+    ignored_.clear();
+    entries_.clear();
+}
+
+size_t ImuAdvRegistry::target_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return targets_.size();
+}
+
+void ImuAdvRegistry::set_excluded(const std::vector<uint64_t>& macs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    excluded_.clear();
+    excluded_.insert(macs.begin(), macs.end());
+}
+
+bool ImuAdvRegistry::prefilter(const std::string& name, const std::vector<std::string>& services) const {
+    auto starts_with = [](const std::string& s, const std::string& prefix) {
+        if (s.size() < prefix.size()) return false;
+        for (size_t i = 0; i < prefix.size(); ++i) {
+            if (std::tolower(static_cast<unsigned char>(s[i])) != std::tolower(static_cast<unsigned char>(prefix[i]))) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (!cfg_.name_prefix.empty() && starts_with(name, cfg_.name_prefix)) return true;
+    if (!cfg_.service_uuid.empty()) {
+        for (const auto& s : services) {
+            if (starts_with(s, cfg_.service_uuid)) return true;
+        }
+    }
+    return false;
+}
+
+std::vector<uint64_t> ImuAdvRegistry::strongest(size_t n, double now) const {
+    std::vector<std::pair<double, uint64_t>> seen;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [mac, e] : entries_) {
+            if (fresh(e, now) && !excluded_.count(mac)) seen.emplace_back(e.rssi_avg, mac);
+        }
+    }
+    std::sort(seen.begin(), seen.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    std::vector<uint64_t> out;
+    for (size_t i = 0; i < seen.size() && i < n; ++i) out.push_back(seen[i].second);
+    return out;
+}
+
+size_t ImuAdvRegistry::visible(double now) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t n = 0;
+    for (const auto& [mac, e] : entries_) n += fresh(e, now) && !excluded_.count(mac);
+    return n;
+}
+
+bool ImuAdvRegistry::entry(uint64_t mac, Entry& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(mac);
+    if (it == entries_.end()) return false;
+    out = it->second;
+    return true;
+}
+
+uint64_t ImuAdvRegistry::adverts() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return adverts_;
+}
+
+size_t ImuAdvRegistry::advertisers() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size() + ignored_.size();
+}
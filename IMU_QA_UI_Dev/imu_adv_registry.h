@@ -0,0 +1,99 @@
+#pragma once
+#include "imu_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// "c6:22:d5:9e:0c:53" (either case, ':' or '-') as a 48-bit integer;
+// kInvalidMac when malformed
+constexpr uint64_t kInvalidMac = ~uint64_t(0);
+uint64_t    imu_pack_mac(const std::string& text);
+std::string imu_format_mac(uint64_t mac);   // lowercase, ':' separated
+
+// What discovery has heard, keyed by packed MAC. Each advertisement costs a
+// MAC parse and a hash lookup; an advertiser is classified once (target
+// set, excluded set, prefilter) and remembered either way, so names and
+// service lists are only fetched for addresses never seen before. Wanted
+// units keep an RSSI moving average and their last-seen time, and when
+// more are visible than there are slots the strongest are offered first.
+// Thread-safe; the scan callbacks may run on the BLE stack's thread.
+class ImuAdvRegistry {
+public:
+    struct Entry {
+        double   rssi_avg;
+        int16_t  rssi_last;
+        double   first_seen_s;
+        double   last_seen_s;
+        uint32_t adverts;
+    };
+
+    explicit ImuAdvRegistry(const ImuScanConfig& cfg = ImuScanConfig{});
+
+    // Only these units are wanted; empty = any unit passing the prefilter
+    void set_targets(const std::vector<std::string>& macs);
+    size_t target_count() const;
+    // Connected units, ignored until set again without them
+    void set_excluded(const std::vector<uint64_t>& macs);
+
+    bool has_prefilter() const { return !cfg_.name_prefix.empty() || !cfg_.service_uuid.empty(); }
+    bool prefilter(const std::string& name, const std::vector<std::string>& services) const;
+
+    // One advertisement at host time t. passes() runs the prefilter and is
+    // only called for an address seen for the first time. True when the
+    // advertisement is from a wanted unit.
+    template <class Prefilter>
+    bool observe(uint64_t mac, int16_t rssi, double t, Prefilter&& passes);
+
+    // Up to n wanted units heard within stale_s of now, strongest first
+    std::vector<uint64_t> strongest(size_t n, double now) const;
+    size_t visible(double now) const;
+    bool   entry(uint64_t mac, Entry& out) const;
+
+    uint64_t adverts() const;
+    size_t   advertisers() const;   // distinct addresses classified
+
+private:
+    // Rotating private addresses would grow the ignore set without bound
+    static constexpr size_t kMaxIgnored = 65536;
+
+    ImuScanConfig cfg_;
+    mutable std::mutex mutex_;
+    std::unordered_set<uint64_t> targets_;
+    std::unordered_set<uint64_t> excluded_;
+    std::unordered_set<uint64_t> ignored_;
+    std::unordered_map<uint64_t, Entry> entries_;
+    uint64_t adverts_ = 0;
+
+    bool fresh(const Entry& e, double now) const { return now - e.last_seen_s <= cfg_.stale_s; }
+};
+
+template <class Prefilter>
+bool ImuAdvRegistry::observe(uint64_t mac, int16_t rssi, double t, Prefilter&& passes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++adverts_;
+    // Most of a busy range is not ours: settle those with one lookup
+    if (mac == kInvalidMac || ignored_.count(mac)) return false;
+    if (!excluded_.empty() && excluded_.count(mac)) return false;
+
+    auto it = entries_.find(mac);
+    if (it == entries_.end()) {
+        const bool wanted = (targets_.empty() || targets_.count(mac)) && (!has_prefilter() || passes());
+        if (!wanted) {
+            if (ignored_.size() >= kMaxIgnored) ignored_.clear();
+            ignored_.insert(mac);
+            return false;
+        }
+        it = entries_.emplace(mac, Entry{double(rssi), rssi, t, t, 0}).first;
+    }
+
+    Entry& e = it->second;
+    e.rssi_avg += cfg_.rssi_alpha * (double(rssi) - e.rssi_avg);
+    e.rssi_last   = rssi;
+    e.last_seen_s = t;
+    ++e.adverts;
+    return true;
+}
@@ -0,0 +1,1783 @@
+// Standalone benchmarks for the QA pipeline hot paths. Needs no BLE hardware
+// and does not link SimpleBLE.
+#include "imu_adv_registry.h"
+#include "imu_block_codec.h"
+#include "imu_calibration.h"
+#include "imu_device_session.h"
+#include "imu_burst_capture.h"
+#include "imu_capture_file.h"
+#include "imu_differential_eval.h"
+#include "imu_evaluate.h"
+#include "imu_event_bus.h"
+#include "imu_executor.h"
+#include "imu_frame.h"
+#include "imu_link_emulator.h"
+#include "imu_live_stream.h"
+#include "imu_lockfree_queue.h"
+#include "imu_orientation.h"
+#include "imu_recoil_analyzer.h"
+#include "imu_result_exporter.h"
+#include "imu_results_db.h"
+#include "imu_sample_buffer.h"
+#include "imu_settle.h"
+#include "imu_shot_detector.h"
+#include "imu_spectrum.h"
+#include "imu_types.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <deque>
+#include <memory>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+using bench_clock = std::chrono::steady_clock;
+
+// Accel and gyro frames arrive separately, so every sample has one half zeroed
+static std::vector<ImuSample> make_samples(size_t n, double rate_hz = 200.0) {
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> noise(0.0f, 6.0f);
+    std::vector<ImuSample> out(n);
+    for (size_t i = 0; i < n; ++i) {
+        ImuSample s{};
+        s.timestamp_s = 1000.0 + double(i) / rate_hz;
+        if (i % 2 == 0) {
+            s.ax = 16.0f * int16_t(noise(rng)) / 32768.0f;
+            s.ay = 16.0f * int16_t(noise(rng)) / 32768.0f;
+            s.az = 16.0f * int16_t(2048 + noise(rng)) / 32768.0f;
+        } else {
+            s.gx = 500.0f * int16_t(noise(rng)) / 28571.0f;
+            s.gy = 500.0f * int16_t(noise(rng)) / 28571.0f;
+            s.gz = 500.0f * int16_t(noise(rng)) / 28571.0f;
+        }
+        out[i] = s;
+    }
+    return out;
+}
+
+static double seconds_since(bench_clock::time_point t0) {
+    return std::chrono::duration<double>(bench_clock::now() - t0).count();
+}
+
+// Headline figures for --json, one per (bench, metric), so two commits can
+// be compared by key
+struct BenchRecord {
+    std::string bench;
+    std::string metric;
+    double      value;
+    const char* unit;
+};
+static std::vector<BenchRecord> g_records;
+
+static void record(const std::string& bench, const std::string& metric, double value, const char* unit) {
+    g_records.push_back({bench, metric, value, unit});
+}
+
+// "loaded, pinned + SCHED_FIFO 50" -> "loaded_pinned_sched_fifo_50"
+static std::string bench_key(const std::string& label) {
+    std::string key;
+    for (char c : label) {
+        if (std::isalnum(static_cast<unsigned char>(c))) key += char(std::tolower(static_cast<unsigned char>(c)));
+        else if (!key.empty() && key.back() != '_') key += '_';
+    }
+    while (!key.empty() && key.back() == '_') key.pop_back();
+    return key;
+}
+
+static bool write_json(const std::string& path, const std::string& label, size_t n) {
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) {
+        std::fprintf(stderr, "[bench] cannot write %s\n", path.c_str());
+        return false;
+    }
+    std::string esc;
+    for (char c : label) {
+        if (c == '"' || c == '\\') esc += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) esc += c;
+    }
+    std::fprintf(f, "{\n  \"label\": \"%s\",\n  \"samples\": %zu,\n  \"hardware_threads\": %u,\n"
+                    "  \"results\": [", esc.c_str(), n, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < g_records.size(); ++i) {
+        const auto& r = g_records[i];
+        const double v = std::isfinite(r.value) ? r.value : 0.0;
+        std::fprintf(f, "%s\n    {\"bench\": \"%s\", \"metric\": \"%s\", \"value\": %.6g, \"unit\": \"%s\"}",
+                     i ? "," : "", r.bench.c_str(), r.metric.c_str(), v, r.unit);
+    }
+    std::fprintf(f, "\n  ]\n}\n");
+    const bool ok = std::fclose(f) == 0;
+    std::printf("[bench] %zu results written to %s\n", g_records.size(), path.c_str());
+    return ok;
+}
+
+static void bench_csv_format(const std::vector<ImuSample>& samples) {
+    const std::string id = "c6:22:d5:9e:0c:53";
+    const size_t chunk = 4096;
+    std::string buf;
+    buf.reserve(8u << 20);
+
+    size_t bytes = 0;
+    auto t0 = bench_clock::now();
+    for (size_t i = 0; i < samples.size(); i += chunk) {
+        size_t n = std::min(chunk, samples.size() - i);
+        ImuResultExporter::append_samples_csv(buf, id, samples.data() + i, n);
+        if (buf.size() > (4u << 20)) {
+            bytes += buf.size();
+            buf.clear();
+        }
+    }
+    bytes += buf.size();
+    double dt = seconds_since(t0);
+
+    double rate = samples.size() / dt;
+    std::printf("csv_format        %10zu samples  %8.3f s  %8.2f M samples/s  %7.1f MB/s\n",
+                samples.size(), dt, rate / 1e6, bytes / dt / 1e6);
+    std::printf("  target >= 10 M samples/s: %s\n", rate >= 10e6 ? "OK" : "BELOW TARGET");
+    record("csv_format", "throughput", rate / 1e6, "M samples/s");
+}
+
+static void bench_jsonl_format(const std::vector<ImuSample>& samples) {
+    const std::string id = "c6:22:d5:9e:0c:53";
+    const size_t chunk = 4096;
+    std::string buf;
+    buf.reserve(8u << 20);
+
+    auto t0 = bench_clock::now();
+    for (size_t i = 0; i < samples.size(); i += chunk) {
+        size_t n = std::min(chunk, samples.size() - i);
+        ImuResultExporter::append_samples_jsonl(buf, id, samples.data() + i, n);
+        if (buf.size() > (4u << 20)) buf.clear();
+    }
+    double dt = seconds_since(t0);
+    std::printf("jsonl_format      %10zu samples  %8.3f s  %8.2f M samples/s\n",
+                samples.size(), dt, samples.size() / dt / 1e6);
+    record("jsonl_format", "throughput", samples.size() / dt / 1e6, "M samples/s");
+}
+
+// Full path: acquisition thread submits 1000-sample chunks, writer thread
+// formats and writes to disk. Reports both submit cost and drain throughput.
+static void bench_exporter_end_to_end(const std::vector<ImuSample>& samples) {
+    auto dir = std::filesystem::temp_directory_path() / "imu_bench_export";
+    ImuExportConfig cfg;
+    cfg.directory = dir.string();
+    cfg.jsonl = false;
+    cfg.compressed_samples = false;   // CSV path alone; block_codec measures .imuz
+    // Drain throughput: the whole stream fits the queue (exporter_bounded drops)
+    cfg.max_queued_bytes = samples.size() * (sizeof(ImuSample) + 64);
+
+    ImuResultExporter exporter(cfg);
+    if (!exporter.open("bench")) return;
+
+    const size_t chunk = 1000;
+    double submit_s = 0.0;
+    auto t0 = bench_clock::now();
+    for (size_t i = 0; i < samples.size(); i += chunk) {
+        size_t n = std::min(chunk, samples.size() - i);
+        std::vector<ImuSample> part(samples.begin() + i, samples.begin() + i + n);
+        auto ts = bench_clock::now();
+        exporter.submit_samples("c6:22:d5:9e:0c:53", std::move(part));
+        submit_s += seconds_since(ts);
+    }
+    exporter.close();
+    double dt = seconds_since(t0);
+
+    std::printf("exporter_csv_disk %10zu samples  %8.3f s  %8.2f M samples/s  (submit %.1f ns/chunk)\n",
+                size_t(exporter.samples_written()), dt, exporter.samples_written() / dt / 1e6,
+                submit_s * 1e9 / double((samples.size() + chunk - 1) / chunk));
+    record("exporter_csv_disk", "throughput", exporter.samples_written() / dt / 1e6, "M samples/s");
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
+
+// Same stream against a 1 MiB queue: chunks the writer cannot keep up with
+// are dropped instead of queued, and every sample is either written or
+// counted as dropped.
+static void bench_exporter_bounded(const std::vector<ImuSample>& samples) {
+    auto dir = std::filesystem::temp_directory_path() / "imu_bench_export_bounded";
+    ImuExportConfig cfg;
+    cfg.directory = dir.string();
+    cfg.compressed_samples = false;
+    cfg.max_queued_bytes   = 1u << 20;
+
+    ImuResultExporter exporter(cfg);
+    if (!exporter.open("bench")) return;
+
+    const size_t chunk = 1000;
+    for (size_t i = 0; i < samples.size(); i += chunk) {
+        size_t n = std::min(chunk, samples.size() - i);
+        exporter.submit_samples("c6:22:d5:9e:0c:53",
+                                std::vector<ImuSample>(samples.begin() + i, samples.begin() + i + n));
+    }
+    exporter.close();
+
+    const uint64_t written = exporter.samples_written(), dropped = exporter.samples_dropped();
+    std::printf("exporter_bounded  %10zu samples  %llu written, %llu dropped (queue %.0f KiB)%s\n",
+                samples.size(), (unsigned long long)written, (unsigned long long)dropped,
+                cfg.max_queued_bytes / 1024.0, written + dropped == samples.size() ? "" : "  ❌ lost");
+    record("exporter_bounded", "dropped", 100.0 * double(dropped) / double(samples.size()), "%");
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
+
+// 10 devices streaming accel + gyro at 1 kHz each, one recoil pulse every
+// 0.5 s. Checks every shot is found and reports per-frame cost against the
+// real-time budget of a single core.
+static void bench_shot_detector(size_t frames_per_device) {
+    const int    devices  = 10;
+    const double rate_hz  = 1000.0;   // per sensor stream
+    const size_t shot_every = 500;    // frames per stream between shots
+
+    std::mt19937 rng(99);
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    std::vector<ImuSample> frames(frames_per_device);
+    size_t injected = 0;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        ImuSample s{};
+        const size_t k = i / 2;
+        s.timestamp_s = 1000.0 + double(k) / rate_hz;
+        bool pulse = k >= 1000 && k % shot_every < 6;   // ~6 ms recoil after 1 s warm-up
+        if (pulse && i % 2 == 0 && k % shot_every == 0) ++injected;
+        if (i % 2 == 0) {
+            s.ax = noise(rng) + (pulse ? 6.0f : 0.0f);
+            s.ay = noise(rng);
+            s.az = 1.0f + noise(rng) + (pulse ? 3.0f : 0.0f);
+        } else {
+            s.gx = 20.0f * noise(rng) + (pulse ? 400.0f : 0.0f);
+            s.gy = 20.0f * noise(rng);
+            s.gz = 20.0f * noise(rng);
+        }
+        frames[i] = s;
+    }
+
+    std::vector<ImuShotDetector> det(devices);
+    size_t found = 0;
+    double worst_latency = 0.0;
+    ImuShotEvent ev;
+    auto t0 = bench_clock::now();
+    // Interleave devices frame by frame as the BLE callbacks would
+    for (size_t i = 0; i < frames.size(); ++i) {
+        for (int d = 0; d < devices; ++d) {
+            if (det[d].push(frames[i], ev)) {
+                ++found;
+                worst_latency = std::max(worst_latency, ev.detected_s - ev.timestamp_s - ev.duration_s);
+            }
+        }
+    }
+    double dt = seconds_since(t0);
+
+    const double total  = double(frames.size()) * devices;
+    const double needed = devices * 2.0 * rate_hz;   // frames/s for 10 devices
+    std::printf("shot_detector     %10.0f frames   %8.3f s  %8.2f M frames/s  %5.1f ns/frame\n",
+                total, dt, total / dt / 1e6, dt * 1e9 / total);
+    std::printf("  shots %zu / %zu expected, close latency <= %.1f ms, "
+                "single-core load at 10 x 1 kHz: %.3f%%\n",
+                found, injected * devices, worst_latency * 1000.0, 100.0 * needed * dt / total);
+    record("shot_detector", "cost", dt * 1e9 / total, "ns/frame");
+}
+
+// Rapid string: 12 shots/s on 10 devices at 1 kHz. Each shot is a 6 ms
+// bore pulse plus a known muzzle rise of 5 deg (1000 dps for 5 ms) that
+// recovers at -250 dps over 20 ms, so rise, return to zero and the number
+// of analysed shots can be checked along with the cost per frame.
+static void bench_recoil_analyzer() {
+    const int    devices  = 10;
+    const size_t seconds  = 20;
+    const size_t split_ms = 83;
+    ImuRecoilConfig rcfg;
+    ImuShotConfig   scfg;
+
+    std::mt19937 rng(7);
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    std::vector<ImuSample> frames;
+    frames.reserve(seconds * 2000);
+    size_t injected = 0;
+    for (size_t k = 0; k < seconds * 1000; ++k) {
+        const bool   armed = k >= 1000;
+        const size_t ph    = (k + split_ms - 1000 % split_ms) % split_ms;   // 0 at k = 1000
+        if (armed && ph == 0) ++injected;
+
+        ImuSample a{};
+        a.timestamp_s = 1000.0 + double(k) / 1000.0;
+        a.ax = noise(rng) + (armed && ph < 6 ? 6.0f : 0.0f);
+        a.ay = noise(rng);
+        a.az = 1.0f + noise(rng);
+        frames.push_back(a);
+
+        ImuSample g{};
+        g.timestamp_s = a.timestamp_s + 0.0005;
+        g.gx = 20.0f * noise(rng);
+        g.gy = 20.0f * noise(rng) + (armed ? (ph < 5 ? 1000.0f : ph < 25 ? -250.0f : 0.0f) : 0.0f);
+        g.gz = 20.0f * noise(rng);
+        frames.push_back(g);
+    }
+
+    std::vector<ImuShotDetector>   det(devices, ImuShotDetector(scfg));
+    std::vector<ImuRecoilAnalyzer> ana(devices, ImuRecoilAnalyzer(rcfg, scfg.max_duration_s + scfg.quiet_s));
+    ImuShotStringStats stats;
+    ImuShotMetrics done[ImuRecoilAnalyzer::kMaxPending];
+    ImuShotEvent ev;
+
+    auto t0 = bench_clock::now();
+    for (const auto& f : frames) {
+        for (int d = 0; d < devices; ++d) {
+            if (det[d].push(f, ev)) ana[d].add_shot(ev);
+            int n = ana[d].push(f, done);
+            if (d == 0) for (int j = 0; j < n; ++j) stats.push(done[j]);
+        }
+    }
+    double dt = seconds_since(t0);
+
+    const double total = double(frames.size()) * devices;
+    std::printf("recoil_analyzer   %10.0f frames   %8.3f s  %8.2f M frames/s  %5.1f ns/frame "
+                "(%.0fx real time)\n",
+                total, dt, total / dt / 1e6, dt * 1e9 / total, double(seconds) / dt);
+    std::printf("  %d / %zu shots analysed, rise %.2f±%.3f deg (5.00 expected), RTZ %.1f ms, "
+                "dv %.3f m/s, split %.3f s\n",
+                stats.shots, injected, stats.rise.mean, stats.rise.sigma(),
+                stats.rtz.mean * 1000.0, stats.impulse.mean, stats.split.mean);
+    record("recoil_analyzer", "cost", dt * 1e9 / total, "ns/frame");
+}
+
+// One device at 1 kHz for 60 s with a shot every 5 s: what the burst ring
+// keeps (and writes) compared with continuous capture. The samples carry a
+// 2 % gain, as from a calibration entry; the records must still hold the
+// counts that were sent.
+static void bench_burst_capture() {
+    const size_t seconds = 60;
+    ImuShotConfig  scfg;
+    ImuBurstConfig bcfg;
+    ImuShotDetector det(scfg);
+    ImuBurstCapture cap;
+    cap.configure("c6:22:d5:9e:0c:53", bcfg, scfg.max_duration_s + scfg.quiet_s);
+
+    std::mt19937 rng(3);
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    auto counts = [](double v) { return int16_t(std::clamp(std::lround(v), -32768L, 32767L)); };
+    std::vector<ImuRawFrame> raw;
+    std::vector<ImuSample> frames;
+    raw.reserve(seconds * 2000);
+    frames.reserve(seconds * 2000);
+    auto add = [&](double t, uint8_t cmd, float x, float y, float z) {
+        const double k = cmd == 0x08 ? kAccelCountsPerG : kGyroCountsPerDps;
+        raw.push_back(ImuRawFrame{t, cmd, {counts(x * k), counts(y * k), counts(z * k)}});
+        const auto& f = raw.back();
+        ImuSample s;
+        imu_decode_frame(t, cmd, f.v[0], f.v[1], f.v[2], s);
+        s.ax *= 1.02f; s.ay *= 1.02f; s.az *= 1.02f;
+        s.gx *= 1.02f; s.gy *= 1.02f; s.gz *= 1.02f;
+        frames.push_back(s);
+    };
+    for (size_t k = 0; k < seconds * 1000; ++k) {
+        const bool pulse = k >= 1000 && k % 5000 < 6;
+        const double t = 1000.0 + double(k) / 1000.0;
+        add(t, 0x08, noise(rng) + (pulse ? 6.0f : 0.0f), noise(rng), 1.0f + noise(rng));
+        add(t + 0.0005, 0x0A, 20.0f * noise(rng), 20.0f * noise(rng) + (pulse ? 800.0f : 0.0f),
+            20.0f * noise(rng));
+    }
+
+    size_t records = 0, kept = 0, mismatched = 0;
+    std::string file;
+    ImuBurstRecord rec;
+    std::vector<ImuBurstRecord> recs;
+    ImuShotEvent ev;
+    auto t0 = bench_clock::now();
+    for (size_t i = 0; i < frames.size(); ++i) {
+        if (det.push(frames[i], ev)) cap.trigger(ev.timestamp_s, ImuBurstReason::Shot);
+        if (cap.push(raw[i], frames[i], rec)) {
+            ++records;
+            kept += rec.frames.size();
+            ImuResultExporter::append_burst(file, rec);
+            recs.push_back(std::move(rec));
+        }
+    }
+    double dt = seconds_since(t0);
+
+    // Recorded frames against the counts sent at their time
+    std::unordered_map<int64_t, const ImuRawFrame*> by_us;
+    for (const auto& f : raw) by_us[std::llround(f.t * 1e6)] = &f;
+    for (const auto& r : recs) {
+        for (const auto& b : r.frames) {
+            auto it = by_us.find(std::llround(r.trigger_s * 1e6) + b.t_us);
+            if (it == by_us.end() || it->second->cmd != b.kind || !std::equal(b.v, b.v + 3, it->second->v)) {
+                ++mismatched;
+            }
+        }
+    }
+
+    const double continuous = double(frames.size()) * sizeof(ImuSample);
+    std::printf("burst_capture     %10zu frames   %8.3f s  %5.1f ns/frame  %zu records, %zu frames kept\n",
+                frames.size(), dt, dt * 1e9 / double(frames.size()), records, kept);
+    std::printf("  memory %.1f KiB vs %.1f KiB continuous (%.2f%%), file %.1f KiB\n",
+                kept * sizeof(ImuBurstFrame) / 1024.0, continuous / 1024.0,
+                100.0 * kept * sizeof(ImuBurstFrame) / continuous, file.size() / 1024.0);
+    std::printf("  %zu recorded frame(s) differ from the counts sent%s\n", mismatched,
+                mismatched == 0 ? "" : "  ❌");
+    record("burst_capture", "cost", dt * 1e9 / double(frames.size()), "ns/frame");
+    record("burst_capture", "mismatched", double(mismatched), "frames");
+}
+
+// 10 producer threads (one per device, as the BLE callbacks) publish a
+// shot every 2 ms for one second; a subscriber in this process receives
+// them. Reports publish cost and the BLE-callback -> subscriber histogram.
+static void bench_event_bus() {
+    const int devices  = 10;
+    const int per_dev  = 500;
+    ImuEventConfig cfg;
+    cfg.socket = false;
+    ImuEventBus bus(cfg);
+
+    std::atomic<uint64_t> received{0};
+    bus.subscribe([&](const ImuEvent&) { received.fetch_add(1, std::memory_order_relaxed); });
+    bus.start();
+
+    std::atomic<uint64_t> publish_ns{0};
+    std::vector<std::thread> producers;
+    for (int d = 0; d < devices; ++d) {
+        producers.emplace_back([&, d] {
+            std::string id = "dev" + std::to_string(d);
+            ImuShotEvent shot{};
+            for (int i = 0; i < per_dev; ++i) {
+                shot.detected_s = ImuEventBus::now_s();
+                shot.timestamp_s = shot.detected_s - 0.004;
+                auto t0 = bench_clock::now();
+                bus.publish_shot(id, shot);
+                publish_ns += uint64_t(seconds_since(t0) * 1e9);
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        });
+    }
+    for (auto& t : producers) t.join();
+    bus.stop();
+
+    std::printf("event_bus         %10llu events  publish %.0f ns avg, %llu received, %llu dropped\n",
+                (unsigned long long)bus.published(), double(publish_ns) / double(devices * per_dev),
+                (unsigned long long)received.load(), (unsigned long long)bus.dropped());
+    bus.print_latency(std::cout);
+    record("event_bus", "publish", double(publish_ns) / double(devices * per_dev), "ns/event");
+}
+
+// (1) Raw filter throughput: 16 devices stepped together in one bank.
+// (2) Accuracy: 4 devices at 1 kHz rocking in roll and pitch for 120 s with
+// a constant gyro bias each; the lockstep tracker must hold roll / pitch and
+// recover the bias on the two tilt axes (yaw bias is unobservable from
+// gravity alone and only partly converges).
+static void bench_orientation() {
+    {
+        const size_t devices = 16, steps = 1'000'000;
+        ImuOrientationBank bank(devices);
+        for (size_t d = 0; d < devices; ++d) {
+            bank.add_device();
+            bank.set_accel(d, 0.01f * float(d), 0.0f, 1.0f);
+            bank.set_gyro(d, 0.5f, -0.3f, 0.1f * float(d));
+        }
+        std::vector<float> dt(devices, 0.001f);
+        auto t0 = bench_clock::now();
+        for (size_t k = 0; k < steps; ++k) bank.update(dt.data());
+        double el = seconds_since(t0);
+        const double total = double(devices) * double(steps);
+        std::printf("orientation_bank  %10.0f updates  %8.3f s  %8.2f M updates/s  %5.1f ns/update\n",
+                    total, el, total / el / 1e6, el * 1e9 / total);
+        record("orientation_bank", "cost", el * 1e9 / total, "ns/update");
+    }
+
+    const int    devices = 4;
+    const size_t seconds = 120;
+    const float  kDeg = 3.14159265f / 180.0f;
+    const float  bias[devices][3] = {{0.8f, -0.5f, 0.3f}, {-1.2f, 0.4f, -0.6f},
+                                     {0.3f, 1.0f, 0.9f},  {-0.6f, -0.9f, -0.2f}};
+    std::mt19937 rng(11);
+    std::normal_distribution<float> anoise(0.0f, 0.005f), gnoise(0.0f, 0.05f);
+
+    ImuOrientationConfig ocfg;
+    ImuOrientationTracker tracker(ocfg, devices);
+    for (int d = 0; d < devices; ++d) tracker.add_device();
+
+    // 50 ms chunks per device, as the manager drains them
+    const size_t chunk_ms = 50;
+    std::vector<std::vector<ImuSample>> chunks(devices);
+    std::vector<const ImuSample*> ptrs(devices);
+    std::vector<size_t> counts(devices);
+    double max_err = 0.0, sum_err = 0.0;
+    size_t err_n = 0, frames = 0;
+    double filter_s = 0.0;
+
+    for (size_t k0 = 0; k0 < seconds * 1000; k0 += chunk_ms) {
+        for (int d = 0; d < devices; ++d) {
+            auto& c = chunks[d];
+            c.clear();
+            for (size_t k = k0; k < k0 + chunk_ms; ++k) {
+                const double t  = double(k) / 1000.0;
+                const float  w1 = 2.0f * 3.14159265f * (0.3f + 0.05f * d), w2 = 2.0f * 3.14159265f * 0.2f;
+                const float  roll  = 20.0f * kDeg * std::sin(w1 * float(t));
+                const float  pitch = 10.0f * kDeg * std::sin(w2 * float(t) + d);
+                const float  droll  = 20.0f * kDeg * w1 * std::cos(w1 * float(t));
+                const float  dpitch = 10.0f * kDeg * w2 * std::cos(w2 * float(t) + d);
+
+                ImuSample a{};
+                a.timestamp_s = 1000.0 + t;
+                a.ax = -std::sin(pitch) + anoise(rng);
+                a.ay = std::sin(roll) * std::cos(pitch) + anoise(rng);
+                a.az = std::cos(roll) * std::cos(pitch) + anoise(rng);
+                c.push_back(a);
+
+                // Body rates for yaw = 0 (ZYX Euler)
+                ImuSample g{};
+                g.timestamp_s = a.timestamp_s + 0.0005;
+                g.gx = droll / kDeg + bias[d][0] + gnoise(rng);
+                g.gy = std::cos(roll) * dpitch / kDeg + bias[d][1] + gnoise(rng);
+                g.gz = -std::sin(roll) * dpitch / kDeg + bias[d][2] + gnoise(rng);
+                c.push_back(g);
+            }
+            ptrs[d]   = c.data();
+            counts[d] = c.size();
+            frames += c.size();
+        }
+        auto t0 = bench_clock::now();
+        tracker.process(ptrs.data(), counts.data(), devices);
+        filter_s += seconds_since(t0);
+
+        // Score after 20 s of convergence
+        const double t_end = double(k0 + chunk_ms - 1) / 1000.0;
+        if (t_end < 20.0) continue;
+        for (int d = 0; d < devices; ++d) {
+            const float w1 = 2.0f * 3.14159265f * (0.3f + 0.05f * d), w2 = 2.0f * 3.14159265f * 0.2f;
+            const double roll  = 20.0 * std::sin(w1 * float(t_end));
+            const double pitch = 10.0 * std::sin(w2 * float(t_end) + d);
+            const auto&  bank  = tracker.bank();
+            double e = std::max(std::fabs(bank.roll_deg(d) - roll), std::fabs(bank.pitch_deg(d) - pitch));
+            max_err = std::max(max_err, e);
+            sum_err += e;
+            ++err_n;
+        }
+    }
+
+    double bias_err_xy = 0.0, bias_err_z = 0.0;
+    for (int d = 0; d < devices; ++d) {
+        float b[3];
+        tracker.bank().gyro_bias_dps(d, b);
+        bias_err_xy = std::max({bias_err_xy, double(std::fabs(b[0] - bias[d][0])),
+                                double(std::fabs(b[1] - bias[d][1]))});
+        bias_err_z = std::max(bias_err_z, double(std::fabs(b[2] - bias[d][2])));
+    }
+    std::printf("orientation       %10zu frames   %8.3f s  %5.1f ns/frame  %d devices lockstep\n",
+                frames, filter_s, filter_s * 1e9 / double(frames), devices);
+    std::printf("  roll/pitch error mean %.3f deg, max %.3f deg; bias error x/y %.3f deg/s, z %.3f deg/s\n",
+                sum_err / double(std::max<size_t>(err_n, 1)), max_err, bias_err_xy, bias_err_z);
+    record("orientation", "cost", filter_s * 1e9 / double(frames), "ns/frame");
+    record("orientation", "max_error", max_err, "deg");
+}
+
+// Reference unit plus 10 DUTs at 500 Hz for 120 s on a table that rocks
+// 0.5 deg at 3 Hz and creeps 0.2 deg/min. Each DUT has its own noise and
+// host arrival skew (0..40 ms); DUT 3 drifts 0.3 deg/min on its own. The
+// difference signal must strip the table and keep DUT 3.
+static void bench_differential() {
+    const int    duts    = 10;
+    const size_t seconds = 120, rate = 500, chunk = 25;   // 50 ms drains
+    const double kPi = 3.14159265358979323846;
+    std::mt19937 rng(5);
+    std::normal_distribution<double> noise(0.0, 0.01);
+
+    ImuReferenceConfig cfg;
+    ImuDifferentialEvaluator eval(cfg);
+    for (int d = 0; d <= duts; ++d) eval.add_device();
+    eval.set_reference(0);
+
+    std::vector<std::vector<ImuSample>> chunks(duts + 1);
+    std::vector<const ImuSample*> ptrs(duts + 1);
+    std::vector<size_t> counts(duts + 1);
+    size_t frames = 0;
+    double el = 0.0;
+    for (size_t k0 = 0; k0 < seconds * rate; k0 += chunk) {
+        for (int d = 0; d <= duts; ++d) {
+            auto& c = chunks[d];
+            c.clear();
+            const double skew = d == 0 ? 0.0 : 0.004 * d;
+            for (size_t k = k0; k < k0 + chunk; ++k) {
+                const double t = double(k) / double(rate);
+                double pitch = 0.5 * std::sin(2.0 * kPi * 3.0 * t) + 0.2 * t / 60.0 + noise(rng);
+                if (d == 3) pitch += 0.3 * t / 60.0;
+                const double pr = pitch * kPi / 180.0;
+                ImuSample a{};
+                a.timestamp_s = 1000.0 + t + skew;
+                a.ax = float(-std::sin(pr));
+                a.az = float(std::cos(pr));
+                c.push_back(a);
+                ImuSample g{};
+                g.timestamp_s = a.timestamp_s + 0.001;
+                g.gy = float(0.5 * 2.0 * kPi * 3.0 * std::cos(2.0 * kPi * 3.0 * t));
+                c.push_back(g);
+            }
+            ptrs[d]   = c.data();
+            counts[d] = c.size();
+            frames += c.size();
+        }
+        auto t0 = bench_clock::now();
+        eval.process(ptrs.data(), counts.data(), duts + 1);
+        el += seconds_since(t0);
+    }
+    auto t0 = bench_clock::now();
+    eval.finish();
+    el += seconds_since(t0);
+
+    std::printf("differential      %10zu frames   %8.3f s  %5.1f ns/frame  %d DUTs + reference\n",
+                frames, el, el * 1e9 / double(frames), duts);
+    record("differential", "cost", el * 1e9 / double(frames), "ns/frame");
+    for (int d = 1; d <= duts; d += 2) {
+        auto r = eval.report(d);
+        std::printf("  dut %d skew %2d ms: abs sigma %.3f drift %.3f | diff sigma %.4f drift %.3f deg/min, "
+                    "lag %+.0f ms\n",
+                    d, 4 * d, r.absolute.noise_sigma, r.absolute.drift_deg_per_min,
+                    r.diff.noise_sigma, r.diff.drift_deg_per_min, r.lag_s * 1000.0);
+    }
+}
+
+// (1) Real FFT against a direct DFT, and its cost per transform.
+// (2) Evaluate-phase spectrum of 10 devices, 60 s at 500 accel + 500 gyro
+// frames/s: white noise everywhere, a 37 Hz spur on device 0's gyro y.
+static void bench_spectrum() {
+    const double kPi = 3.14159265358979323846;
+    std::mt19937 rng(9);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    {
+        const size_t n = 256;
+        std::vector<float> x(n);
+        for (auto& v : x) v = noise(rng);
+        ImuRealFft fft(n);
+        std::vector<std::complex<float>> out(n / 2 + 1);
+        fft.forward(x.data(), out.data());
+        double err = 0.0, ref_max = 0.0;
+        for (size_t k = 0; k <= n / 2; ++k) {
+            std::complex<double> acc = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                acc += double(x[i]) * std::polar(1.0, -2.0 * kPi * double(k * i % n) / double(n));
+            }
+            err     = std::max(err, std::abs(acc - std::complex<double>(out[k])));
+            ref_max = std::max(ref_max, std::abs(acc));
+        }
+        const size_t reps = 200'000;
+        auto t0 = bench_clock::now();
+        for (size_t r = 0; r < reps; ++r) {
+            x[r % n] += 1e-3f;
+            fft.forward(x.data(), out.data());
+        }
+        double el = seconds_since(t0);
+        std::printf("real_fft_256      %10zu ffts     %8.3f s  %5.0f ns/fft  max error %.2e of peak\n",
+                    reps, el, el * 1e9 / double(reps), err / ref_max);
+        record("real_fft_256", "cost", el * 1e9 / double(reps), "ns/fft");
+    }
+
+    const int    devices = 10;
+    const size_t seconds = 60, rate = 500;
+    std::vector<std::unique_ptr<ImuSampleChunks>> runs;
+    for (int d = 0; d < devices; ++d) {
+        runs.push_back(std::make_unique<ImuSampleChunks>());
+        for (size_t k = 0; k < seconds * rate; ++k) {
+            const double t = double(k) / double(rate);
+            ImuSample a{};
+            a.timestamp_s = 1000.0 + t;
+            a.ax = 0.002f * noise(rng);
+            a.ay = 0.002f * noise(rng);
+            a.az = 1.0f + 0.002f * noise(rng);
+            runs[d]->push_back(a);
+            ImuSample g{};
+            g.timestamp_s = a.timestamp_s + 0.001;
+            g.gx = 0.05f * noise(rng);
+            g.gy = 0.05f * noise(rng) + (d == 0 ? 0.02f * float(std::sin(2.0 * kPi * 37.0 * t)) : 0.0f);
+            g.gz = 0.05f * noise(rng);
+            runs[d]->push_back(g);
+        }
+    }
+
+    ImuSpectrumConfig cfg;
+    ImuSpectrumAnalyzer an(cfg);
+    std::vector<ImuSpectrumMetrics> m(devices);
+    auto t0 = bench_clock::now();
+    for (int d = 0; d < devices; ++d) m[d] = an.analyze(*runs[d]);
+    double el = seconds_since(t0);
+
+    double clean_spur = 0.0;
+    for (int d = 1; d < devices; ++d) clean_spur = std::max(clean_spur, m[d].spur_db);
+    std::printf("spectrum          %10d devices  %8.3f s  %5.2f ms/device  %zu segments x 6 axes\n",
+                devices, el, el * 1e3 / devices, m[0].segments);
+    std::printf("  device 0: spur %.1f dB at %.1f Hz (axis %d, 37 Hz injected); clean devices <= %.1f dB; "
+                "gyro band %.4f dps rms\n",
+                m[0].spur_db, m[0].spur_hz, m[0].spur_axis, clean_spur, m[1].gyro_band_rms_dps);
+    record("spectrum", "cost", el * 1e3 / devices, "ms/device");
+}
+
+// Tick lateness of a 1 ms executor (the decode tick) for 2 s per setup:
+// idle machine, every core busy with competing threads, and busy with the
+// executor pinned to the last core at SCHED_FIFO 50, the competing threads
+// kept off that core. Setups the machine does not allow are reported as such;
+// with one core the load cannot be kept off the executor's core, so the
+// pinned and loaded cases are not compared.
+static void bench_executor() {
+    const int    cores   = std::max(1, (int)std::thread::hardware_concurrency());
+    const double seconds = 2.0;
+
+    auto measure = [&](const char* label, const ImuThreadPlacement& place, bool load, bool reserve) {
+        std::atomic<bool> stop{false};
+        std::thread spawner;
+        std::vector<std::thread> hogs;
+        auto spawn = [&] {
+            if (reserve && !imu_reserve_cores({place.cpu})) return false;
+            for (int c = 0; c < cores; ++c) {
+                hogs.emplace_back([&] {
+                    volatile double x = 1.0;
+                    while (!stop.load(std::memory_order_relaxed)) x = x * 1.0000001 + 1e-9;
+                });
+            }
+            return true;
+        };
+        bool reserved = true;
+        if (load) {
+            // Spawned from a helper so a reserved mask does not stick to main
+            spawner = std::thread([&] { reserved = spawn(); });
+            spawner.join();
+        }
+
+        ImuExecutor ex(label, place);
+        uint64_t ticks = 0;
+        ex.set_tick(0.001, [&] { ++ticks; });
+        ex.start();
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        ex.stop();
+        stop = true;
+        for (auto& t : hogs) t.join();
+
+        const auto& h = ex.tick_lateness();
+        std::printf("  %-34s ticks %5llu  lateness p50 <= %5.0f us  p99 <= %6.0f us  max %8.0f us%s%s\n",
+                    label, (unsigned long long)ticks, h.percentile_us(0.5), h.percentile_us(0.99),
+                    h.max_us(), ex.placement_applied() ? "" : "  (placement refused)",
+                    reserved ? "" : "  (cores not reserved)");
+        record("executor_jitter", bench_key(label) + ".p99", h.percentile_us(0.99), "us");
+        return h.percentile_us(0.99);
+    };
+
+    std::printf("executor_jitter   1 ms tick, %d cores, isolated CPUs: %s\n", cores,
+                imu_isolated_cpus().empty() ? "none" : imu_isolated_cpus().c_str());
+    ImuThreadPlacement plain, rt;
+    rt.cpu = cores - 1;
+    rt.rt_priority = 50;
+    measure("idle", plain, false, false);
+    const double loaded = measure("loaded", plain, true, false);
+    const double pinned = measure("loaded, pinned + SCHED_FIFO 50", rt, true, cores > 1);
+    if (cores < 2) {
+        std::printf("  1 core: the load shares the executor's core, pinned vs loaded not compared\n");
+    } else {
+        std::printf("  pinned p99 %.0f us vs loaded %.0f us: %s\n", pinned, loaded,
+                    pinned < loaded ? "lower" : pinned == loaded ? "no change" : "HIGHER");
+    }
+}
+
+// Quiescent unit on the fixture as the BLE link delivers it: 400 frames/s
+// alternating accel / gyro, +-3 counts of noise, three frames per 7.5 ms
+// connection event sharing one arrival stamp.
+static ImuFrameColumns make_quiescent_frames(size_t n) {
+    std::mt19937 rng(99);
+    std::normal_distribution<float>      noise(0.0f, 3.0f);
+    std::uniform_int_distribution<int>   jitter(-150, 150);
+    ImuFrameColumns f;
+    f.reserve(n);
+    int64_t t = 1'000'000'000;
+    for (size_t i = 0; i < n; ++i) {
+        if (i % 3 == 0) t += 7500 + jitter(rng);
+        const bool a = i % 2 == 0;
+        f.push(t, a, int16_t(std::lround(noise(rng))), int16_t(std::lround(noise(rng))),
+               int16_t((a ? 2048 : 0) + std::lround(noise(rng))));
+    }
+    return f;
+}
+
+static bool same_frames(const ImuFrameColumns& a, const ImuFrameColumns& b) {
+    return a.t_us == b.t_us && a.accel == b.accel && a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+// Block codec: size against the raw 12-byte frame (ImuBurstFrame) and
+// ImuSample, decode throughput, and a capture file written and read back.
+static void bench_block_codec(size_t n) {
+    struct Case { const char* name; ImuFrameColumns frames; };
+    Case cases[2] = {{"quiescent, BLE stamps", make_quiescent_frames(n)}, {"bench samples", {}}};
+    for (const auto& s : make_samples(n, 400.0)) cases[1].frames.push(s);
+
+    for (auto& c : cases) {
+        ImuBlockEncoder enc;
+        std::vector<uint8_t> blob;
+        auto t0 = bench_clock::now();
+        enc.encode_all(c.frames, blob);
+        const double t_enc = seconds_since(t0);
+
+        ImuBlockDecoder dec;
+        ImuFrameColumns out;
+        out.reserve(c.frames.size());
+        const int reps = 10;
+        double t_dec = 0.0;
+        bool ok = true;
+        for (int r = 0; r < reps; ++r) {
+            out.clear();
+            t0 = bench_clock::now();
+            for (size_t at = 0; at < blob.size();) {
+                const size_t used = dec.decode(blob.data() + at, blob.size() - at, out);
+                if (used == 0) { ok = false; break; }
+                at += used;
+            }
+            t_dec += seconds_since(t0);
+        }
+        t_dec /= reps;
+        ok = ok && same_frames(out, c.frames);
+
+        // One block at a time into reused columns, as a streaming reader
+        // would: the decode itself, without writing the whole run to memory
+        ImuFrameColumns one;
+        one.reserve(ImuBlockEncoder::kBlockFrames);
+        t0 = bench_clock::now();
+        for (int r = 0; r < reps; ++r) {
+            for (size_t at = 0; at < blob.size();) {
+                one.clear();
+                const size_t used = dec.decode(blob.data() + at, blob.size() - at, one);
+                if (used == 0) break;
+                at += used;
+            }
+        }
+        const double t_blk = seconds_since(t0) / reps;
+
+        const double per_frame = double(blob.size()) / double(n);
+        std::printf("block_codec       %-22s %5.2f B/frame  %4.1f:1 vs 12 B raw  %4.1f:1 vs ImuSample  "
+                    "encode %6.1f M/s  decode %6.1f M/s (%.2f GB/s raw)  %s\n",
+                    c.name, per_frame, 12.0 / per_frame, double(sizeof(ImuSample)) / per_frame,
+                    double(n) / t_enc / 1e6, double(n) / t_dec / 1e6, double(n) * 12.0 / t_dec / 1e9,
+                    ok ? "lossless" : "MISMATCH");
+        std::printf("                  %-22s block at a time  decode %6.1f M/s (%.2f GB/s raw)\n", "",
+                    double(n) / t_blk / 1e6, double(n) * 12.0 / t_blk / 1e9);
+        const std::string key = &c == &cases[0] ? "block_codec.quiescent" : "block_codec.bench";
+        record(key, "size", per_frame, "B/frame");
+        record(key, "decode", double(n) / t_dec / 1e6, "M frames/s");
+        record(key, "decode_block", double(n) / t_blk / 1e6, "M frames/s");
+    }
+
+    // Capture file round trip through the writer and imu_read_capture
+    const std::string dir = (std::filesystem::temp_directory_path() / "imu_bench_capture").string();
+    std::filesystem::remove_all(dir);
+    std::vector<ImuSample> in;
+    cases[0].frames.append_to(in);
+    std::string path;
+    {
+        ImuCaptureWriter w(dir, "AA:BB:CC:DD:EE:FF", 0.0);
+        w.write(in.data(), in.size());
+        w.close();
+        for (const auto& e : std::filesystem::directory_iterator(dir)) path = e.path().string();
+        std::printf("  capture file      %zu frames -> %llu bytes (%.2f B/frame)", in.size(),
+                    (unsigned long long)w.bytes_written(), double(w.bytes_written()) / double(in.size()));
+    }
+    std::string id;
+    std::vector<ImuSample> back;
+    const bool read_ok = imu_read_capture(path, id, back);
+    bool equal = read_ok && back.size() == in.size();
+    for (size_t i = 0; equal && i < in.size(); ++i) {
+        equal = in[i].timestamp_s == back[i].timestamp_s && in[i].ax == back[i].ax && in[i].ay == back[i].ay &&
+                in[i].az == back[i].az && in[i].gx == back[i].gx && in[i].gy == back[i].gy && in[i].gz == back[i].gz;
+    }
+    std::printf(", read back %s\n", equal ? "identical" : "DIFFERENT");
+    std::filesystem::remove_all(dir);
+}
+
+// Run storage as compact frames: bytes per frame, append cost, the gravity
+// pass over ImuSample against the kernel on stored counts, and a check that
+// decoding gives back the same samples.
+static void bench_compact_samples(size_t n) {
+    std::vector<ImuSample> in = make_samples(n, 400.0);
+
+    ImuSampleChunks store;
+    auto t0 = bench_clock::now();
+    store.append(in.data(), in.size());
+    const double t_append = seconds_since(t0);
+
+    size_t mismatched = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const ImuSample a = in[i], b = store[i];
+        if (std::fabs(a.timestamp_s - b.timestamp_s) > ImuSampleChunks::kTickS ||
+            a.ax != b.ax || a.ay != b.ay || a.az != b.az ||
+            std::fabs(a.gx - b.gx) > 1e-6f || std::fabs(a.gy - b.gy) > 1e-6f || std::fabs(a.gz - b.gz) > 1e-6f) {
+            ++mismatched;
+        }
+    }
+
+    const int reps = 20;
+    double g_aos = 0.0, g_kernel = 0.0;
+    t0 = bench_clock::now();
+    for (int r = 0; r < reps; ++r) {
+        double sum = 0.0;
+        size_t cnt = 0;
+        for (const auto& s : in) {
+            if (s.ax != 0.0f || s.ay != 0.0f || s.az != 0.0f) {
+                sum += std::sqrt(double(s.ax) * s.ax + double(s.ay) * s.ay + double(s.az) * s.az);
+                ++cnt;
+            }
+        }
+        g_aos = cnt ? sum / double(cnt) : 0.0;
+    }
+    const double t_aos = seconds_since(t0) / reps;
+    t0 = bench_clock::now();
+    for (int r = 0; r < reps; ++r) g_kernel = imu_mean_accel_magnitude(store, nullptr);
+    const double t_kernel = seconds_since(t0) / reps;
+
+    std::printf("compact_samples   %zu frames  %zu B/frame vs %zu  append %6.1f M/s  mismatched %zu\n",
+                n, ImuSampleChunks::kFrameBytes, sizeof(ImuSample), double(n) / t_append / 1e6, mismatched);
+    std::printf("  gravity mean        ImuSample %7.2f ms  counts kernel %7.2f ms  (%.1fx)  |g| %.6f / %.6f\n",
+                t_aos * 1e3, t_kernel * 1e3, t_aos / t_kernel, g_aos, g_kernel);
+    record("compact_samples", "gravity_kernel", t_kernel * 1e9 / double(n), "ns/frame");
+}
+
+// 100 devices x 60 s at 400 frames/s, drained every 10 ms into per-run
+// storage as run_test does: pre-sized ImuSampleBuffers on pool chunks,
+// growing vectors and deques. Peak RSS is measured per variant from a reset
+// high-water mark, with the chunk pool trimmed first so chunks left idle by
+// earlier benches do not hide the arena's growth; the arena runs first so it
+// cannot reuse pages the other variants left resident in the heap.
+static void bench_run_storage() {
+    const int    devices = 100;
+    const size_t ticks   = 6000, per_tick = 4;
+    std::vector<ImuSample> chunk = make_samples(per_tick, 400.0);
+
+    auto settle = [] {
+        ImuChunkPool::shared().trim();
+#ifdef __GLIBC__
+        malloc_trim(0);
+#endif
+        imu_reset_peak_rss();
+        return imu_current_rss_bytes();
+    };
+    auto report = [&](const char* label, size_t base, double fill_s, double release_s) {
+        const double mib = 1024.0 * 1024.0;
+        const std::string key = "run_storage." + bench_key(label);
+        record(key, "fill", fill_s * 1e3, "ms");
+        record(key, "peak_rss", (double(imu_peak_rss_bytes()) - double(base)) / mib, "MiB");
+        std::printf("  %-22s fill %7.1f ms  peak RSS +%6.1f MiB  release %8.3f ms  RSS after +%6.1f MiB\n",
+                    label, fill_s * 1e3, (double(imu_peak_rss_bytes()) - double(base)) / mib,
+                    release_s * 1e3, (double(imu_current_rss_bytes()) - double(base)) / mib);
+    };
+    const double frames = double(devices) * ticks * per_tick;
+    std::printf("run_storage       %d devices, %.1f MiB as ImuSample, %.1f MiB as frames, RSS tracking %s\n",
+                devices, frames * sizeof(ImuSample) / (1024.0 * 1024.0),
+                frames * ImuSampleChunks::kFrameBytes / (1024.0 * 1024.0),
+                imu_peak_rss_bytes() > 0 ? "on" : "unavailable");
+
+    {
+        size_t base = settle();
+        auto t0 = bench_clock::now();
+        ImuBufferConfig cfg;
+        std::vector<std::unique_ptr<ImuSampleBuffer>> runs;
+        for (int d = 0; d < devices; ++d) {
+            runs.push_back(std::make_unique<ImuSampleBuffer>());
+            runs.back()->configure(cfg.session_budget_bytes, cfg, nullptr, "bench");
+            runs.back()->reserve(size_t(cfg.expected_frame_rate_hz * 60.0 * 1.05));
+        }
+        for (size_t t = 0; t < ticks; ++t) {
+            for (auto& r : runs) r->push(chunk.data(), chunk.size());
+        }
+        double fill = seconds_since(t0);
+        t0 = bench_clock::now();
+        runs.clear();   // chunks back to the pool, kept for the next run
+        double release = seconds_since(t0);
+        report("chunk arena", base, fill, release);
+        const size_t idle    = ImuChunkPool::shared().idle_chunks();
+        const size_t trimmed = ImuChunkPool::shared().trim();
+        std::printf("  %-22s %zu chunks idle in the pool for the next run, %.1f MiB freed by trim()\n", "",
+                    idle, double(trimmed) / (1024.0 * 1024.0));
+    }
+    {
+        size_t base = settle();
+        auto t0 = bench_clock::now();
+        std::vector<std::vector<ImuSample>> runs(devices);
+        for (size_t t = 0; t < ticks; ++t) {
+            for (auto& r : runs) r.insert(r.end(), chunk.begin(), chunk.end());
+        }
+        double fill = seconds_since(t0);
+        t0 = bench_clock::now();
+        runs.clear();
+        runs.shrink_to_fit();
+        report("vector insert", base, fill, seconds_since(t0));
+    }
+    {
+        size_t base = settle();
+        auto t0 = bench_clock::now();
+        std::vector<std::deque<ImuSample>> runs(devices);
+        for (size_t t = 0; t < ticks; ++t) {
+            for (auto& r : runs) r.insert(r.end(), chunk.begin(), chunk.end());
+        }
+        double fill = seconds_since(t0);
+        t0 = bench_clock::now();
+        runs.clear();
+        runs.shrink_to_fit();
+        report("deque", base, fill, seconds_since(t0));
+    }
+}
+
+// GMSync notifications as they reach on_notify: 55 AA cmd 06 x y z,
+// alternating accel / gyro
+static std::vector<uint8_t> make_notifications(size_t n) {
+    std::mt19937 rng(21);
+    std::normal_distribution<float> noise(0.0f, 6.0f);
+    std::vector<uint8_t> out(n * 10);
+    for (size_t i = 0; i < n; ++i) {
+        uint8_t* d = out.data() + i * 10;
+        const bool a = i % 2 == 0;
+        d[0] = 0x55;
+        d[1] = 0xAA;
+        d[2] = a ? 0x08 : 0x0A;
+        d[3] = 0x06;
+        for (int k = 0; k < 3; ++k) {
+            const uint16_t v = uint16_t(int16_t((a && k == 2 ? 2048 : 0) + std::lround(noise(rng))));
+            d[4 + 2 * k] = uint8_t(v >> 8);
+            d[5 + 2 * k] = uint8_t(v);
+        }
+    }
+    return out;
+}
+
+// The on_notify -> buffer path without the detectors (clock reads left
+// out): parse + scale alone, inline per frame into the session buffer, and
+// through the raw-frame ring the decode executor empties, pushing each
+// frame as decode_pending does or the whole batch under one lock.
+static void bench_frame_decode(size_t n) {
+    const std::vector<uint8_t> bytes = make_notifications(n);
+    const double dt_frame = 1.0 / 2000.0;
+    const size_t batch = 64;   // frames per decode tick and per drain
+
+    auto row = [&](const char* label, const char* key, double el, double check) {
+        std::printf("  %-30s %6.1f ns/frame  %8.2f M frames/s  (check %.3f)\n",
+                    label, el * 1e9 / double(n), double(n) / el / 1e6, check);
+        record("frame_decode", key, el * 1e9 / double(n), "ns/frame");
+    };
+    std::printf("frame_decode      %10zu frames\n", n);
+
+    {
+        double sum = 0.0;
+        uint8_t cmd;
+        int16_t v[3];
+        ImuSample s;
+        auto t0 = bench_clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            if (imu_parse_frame(bytes.data() + i * 10, 10, cmd, v) &&
+                imu_decode_frame(double(i) * dt_frame, cmd, v[0], v[1], v[2], s)) {
+                sum += s.az + s.gz;
+            }
+        }
+        row("parse + scale", "parse_scale", seconds_since(t0), sum / double(n));
+    }
+    {
+        // A realistic unit: small misalignment, scale error and biases
+        ImuDeviceCal cal;
+        cal.accel.m[0] = 1.004f; cal.accel.m[1] = 0.002f; cal.accel.m[4] = 0.997f; cal.accel.m[8] = 1.001f;
+        cal.accel.bias[0] = 0.012f; cal.accel.bias[2] = -0.008f;
+        cal.gyro.bias[0] = 0.31f; cal.gyro.bias[1] = -0.12f; cal.gyro.bias[2] = 0.05f;
+        const ImuCalKernel kernel(cal);
+
+        for (int batched = 0; batched < 2; ++batched) {
+            uint8_t accel[batch];
+            int16_t x[batch], y[batch], z[batch];
+            float   ox[batch], oy[batch], oz[batch];
+            double  t[batch];
+            double  sum = 0.0;
+            uint8_t cmd;
+            int16_t v[3];
+            size_t  k = 0;
+            auto t0 = bench_clock::now();
+            for (size_t i = 0; i < n; ++i) {
+                if (imu_parse_frame(bytes.data() + i * 10, 10, cmd, v) && imu_is_sample_cmd(cmd)) {
+                    t[k] = double(i) * dt_frame;
+                    accel[k] = cmd == 0x08;
+                    x[k] = v[0];
+                    y[k] = v[1];
+                    z[k] = v[2];
+                    ++k;
+                }
+                if (!batched) {
+                    float o[3] = {0.0f, 0.0f, 0.0f};
+                    if (k) kernel.apply(accel[0], x[0], y[0], z[0], o);
+                    oz[0] = o[2];
+                } else if (k < batch && i + 1 != n) {
+                    continue;
+                } else {
+                    imu_calibrate_frames(kernel, k, accel, x, y, z, ox, oy, oz);
+                }
+                for (size_t j = 0; j < k; ++j) {
+                    ImuSample s{};
+                    s.timestamp_s = t[j];
+                    if (accel[j]) s.az = oz[j];
+                    else          s.gz = oz[j];
+                    sum += s.az + s.gz;
+                }
+                k = 0;
+            }
+            row(batched ? "parse + calibrate, batch of 64" : "parse + calibrate, per frame",
+                batched ? "calibrate_batch" : "calibrate_per_frame", seconds_since(t0), sum / double(n));
+        }
+    }
+    {
+        ImuSampleBuffer buf;
+        size_t drained = 0;
+        uint8_t cmd;
+        int16_t v[3];
+        ImuSample s;
+        auto t0 = bench_clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            if (imu_parse_frame(bytes.data() + i * 10, 10, cmd, v) &&
+                imu_decode_frame(double(i) * dt_frame, cmd, v[0], v[1], v[2], s)) {
+                buf.push(s);
+            }
+            if (i % batch == batch - 1) drained += buf.drain().size();
+        }
+        drained += buf.drain().size();
+        row("inline, per-frame push", "inline_per_frame", seconds_since(t0), double(drained) / double(n));
+    }
+    for (int batched = 0; batched < 2; ++batched) {
+        ImuLockFreeQueue<ImuRawFrame> ring(4096);
+        ImuSampleBuffer buf;
+        std::vector<ImuSample> out(batch);
+        size_t drained = 0;
+        uint8_t cmd;
+        int16_t v[3];
+        ImuRawFrame f;
+        auto t0 = bench_clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            if (imu_parse_frame(bytes.data() + i * 10, 10, cmd, v) && imu_is_sample_cmd(cmd)) {
+                ring.try_push(ImuRawFrame{double(i) * dt_frame, cmd, {v[0], v[1], v[2]}});
+            }
+            if (i % batch != batch - 1 && i + 1 != n) continue;
+            size_t k = 0;
+            while (ring.try_pop(f)) {
+                if (!imu_decode_frame(f.t, f.cmd, f.v[0], f.v[1], f.v[2], out[k])) continue;
+                if (!batched) buf.push(out[k]);
+                else ++k;
+            }
+            if (batched) buf.push(out.data(), k);
+            drained += buf.drain().size();
+        }
+        drained += buf.drain().size();
+        row(batched ? "queued, one push per batch" : "queued, per-frame push",
+            batched ? "queued_batch_push" : "queued_per_frame", seconds_since(t0), double(drained) / double(n));
+    }
+}
+
+// One session buffer per device, each fed frame by frame by its own
+// producer as fast as it can, while one thread drains them all every 10 ms
+// as run_test does. Reports the push cost under that contention, the
+// cost of a drain and that nothing was lost.
+static void bench_buffer_contention() {
+    const ImuSample s = make_samples(1)[0];
+    for (int devices : {1, 4, 10}) {
+        const size_t per_dev = 2'000'000 / size_t(devices);
+        std::vector<std::unique_ptr<ImuSampleBuffer>> bufs;
+        for (int d = 0; d < devices; ++d) bufs.push_back(std::make_unique<ImuSampleBuffer>());
+
+        std::atomic<int> running{devices};
+        std::atomic<uint64_t> push_ns{0};
+        size_t drained = 0, drains = 0;
+        double drain_s = 0.0, drain_max_s = 0.0;
+        std::thread drainer([&] {
+            for (;;) {
+                const bool last = running.load() == 0;
+                for (auto& b : bufs) {
+                    auto t0 = bench_clock::now();
+                    drained += b->drain().size();
+                    const double el = seconds_since(t0);
+                    drain_s += el;
+                    drain_max_s = std::max(drain_max_s, el);
+                    ++drains;
+                }
+                if (last) break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        });
+        std::vector<std::thread> producers;
+        for (int d = 0; d < devices; ++d) {
+            producers.emplace_back([&, d] {
+                auto t0 = bench_clock::now();
+                for (size_t i = 0; i < per_dev; ++i) bufs[d]->push(s);
+                push_ns += uint64_t(seconds_since(t0) * 1e9);
+                --running;
+            });
+        }
+        for (auto& t : producers) t.join();
+        drainer.join();
+
+        const double pushes = double(per_dev) * devices;
+        std::printf("buffer_contention %2d producers  push %6.1f ns  drain %7.1f us avg, %8.1f us max  "
+                    "%zu / %.0f frames drained\n",
+                    devices, double(push_ns) / pushes, drain_s * 1e6 / double(drains), drain_max_s * 1e6,
+                    drained, pushes);
+        const std::string key = "buffer_contention." + std::to_string(devices) + "_producers";
+        record(key, "push", double(push_ns) / pushes, "ns/frame");
+        record(key, "drain_avg", drain_s * 1e6 / double(drains), "us");
+    }
+}
+
+// SpillToDisk with a 64 KiB buffer: 10^6 frames pushed 4 at a time, then
+// the spill file read back. Spilled records followed by what
+// the buffer kept must be the pushed frames, in order.
+static void bench_buffer_spill() {
+    const size_t n = 1'000'000;
+    std::vector<ImuSample> in = make_samples(n, 400.0);
+
+    ImuBufferConfig cfg;
+    cfg.policy          = OverflowPolicy::SpillToDisk;
+    cfg.spill_directory = (std::filesystem::temp_directory_path() / "imu_bench_spill").string();
+    std::error_code ec;
+    std::filesystem::remove_all(cfg.spill_directory, ec);
+
+    std::vector<ImuSample> kept;
+    ImuOverflowStats stats;
+    auto t0 = bench_clock::now();
+    {
+        ImuSampleBuffer buf;
+        buf.configure(64u << 10, cfg, nullptr, "bench");
+        for (size_t i = 0; i < n; i += 4) buf.push(in.data() + i, std::min<size_t>(4, n - i));
+        stats = buf.stats();
+        kept  = buf.drain();
+    }
+    const double t_push = seconds_since(t0);
+
+    std::vector<ImuSample> back;
+    const std::string path = (std::filesystem::path(cfg.spill_directory) / "bench.bin").string();
+    if (std::FILE* f = std::fopen(path.c_str(), "rb")) {
+        ImuSample s;
+        while (std::fread(&s, sizeof(s), 1, f) == 1) back.push_back(s);
+        std::fclose(f);
+    }
+    back.insert(back.end(), kept.begin(), kept.end());
+
+    size_t mismatched = back.size() > n ? back.size() - n : n - back.size();   // missing or extra
+    for (size_t i = 0; i < std::min(n, back.size()); ++i) {
+        const ImuSample a = in[i], b = back[i];
+        if (std::fabs(a.timestamp_s - b.timestamp_s) > ImuSampleChunks::kTickS ||
+            a.ax != b.ax || a.ay != b.ay || a.az != b.az ||
+            std::fabs(a.gx - b.gx) > 1e-6f || std::fabs(a.gy - b.gy) > 1e-6f || std::fabs(a.gz - b.gz) > 1e-6f) {
+            ++mismatched;
+        }
+    }
+    std::printf("buffer_spill      %zu frames  spilled %llu  kept %zu  read back %zu  dropped %llu  "
+                "%6.1f M/s  mismatched %zu%s\n",
+                n, (unsigned long long)stats.spilled, kept.size(), back.size() - kept.size(),
+                (unsigned long long)stats.dropped, double(n) / t_push / 1e6, mismatched,
+                mismatched || back.size() - kept.size() != stats.spilled ? "  SPILL FILE WRONG" : "");
+    record("buffer_spill", "push", t_push * 1e9 / double(n), "ns/frame");
+    std::filesystem::remove_all(cfg.spill_directory, ec);
+}
+
+// evaluate_device (ImuDeviceEvaluator) on one run of 10^3 .. 10^7 stored
+// frames at 400 frames/s, with the default limits and spectrum enabled
+static void bench_evaluate(size_t max_n) {
+    ImuQaConfig cfg;
+    ImuDeviceEvaluator eval(cfg);
+    ImuSampleChunks run;
+    ImuTiltReport tilt;
+    const std::vector<ImuGap> gaps;
+
+    std::mt19937 rng(17);
+    std::normal_distribution<float> noise(0.0f, 6.0f);
+    size_t k = 0;
+    for (size_t n = 1000; n <= max_n; n *= 10) {
+        for (; k < n; ++k) {
+            ImuSample s{};
+            s.timestamp_s = 1000.0 + double(k) / 400.0;
+            if (k % 2 == 0) {
+                s.ax = 16.0f * int16_t(noise(rng)) / 32768.0f;
+                s.ay = 16.0f * int16_t(noise(rng)) / 32768.0f;
+                s.az = 16.0f * int16_t(2048 + noise(rng)) / 32768.0f;
+            } else {
+                s.gx = 500.0f * int16_t(noise(rng)) / 28571.0f;
+                s.gy = 500.0f * int16_t(noise(rng)) / 28571.0f;
+                s.gz = 500.0f * int16_t(noise(rng)) / 28571.0f;
+            }
+            run.push_back(s);
+        }
+        const size_t reps = std::max<size_t>(1, 3'000'000 / n);
+        ImuQaResult res;
+        auto t0 = bench_clock::now();
+        for (size_t r = 0; r < reps; ++r) res = eval.evaluate("bench", run, gaps, double(n) / 400.0, tilt);
+        const double el = seconds_since(t0) / double(reps);
+        std::printf("evaluate_device   %10zu frames   %10.3f ms  %6.1f ns/frame  |g| %.4f  %s\n",
+                    n, el * 1e3, el * 1e9 / double(n), res.gravity_mean_g,
+                    qa_status_name(res.status));
+        record("evaluate_device", "n_" + std::to_string(n), el * 1e3, "ms");
+    }
+}
+
+// Link emulator in stream time: one unit at 400 frames/s for 10 minutes
+// per profile, run twice to check the seed reproduces every decision.
+static void bench_link_emulator() {
+    const double seconds = 600.0, step = 0.001;
+    for (const char* name : {"clean", "busy", "lossy", "flaky", "worst"}) {
+        ImuLinkConditions c;
+        imu_link_profile(name, c);
+        c.seed = 42;
+
+        uint64_t digest[2] = {0, 0};
+        ImuLinkStats st;
+        double el = 0.0;
+        for (int pass = 0; pass < 2; ++pass) {
+            ImuLinkEmulator emu(c);
+            ImuSyntheticSource src(c.seed, c.frame_rate_hz);
+            ImuRawFrame f;
+            src.next(f);
+            uint64_t h = 1469598103934665603ull;
+            auto t0 = bench_clock::now();
+            for (double t = 0.0; t < seconds; t += step) {
+                for (; f.t <= t; src.next(f)) {
+                    uint8_t frame[10];
+                    imu_encode_frame(f.cmd, f.v, frame);
+                    emu.send(f.t, frame, sizeof(frame));
+                }
+                emu.deliver(t, [&](double rx, const uint8_t* d, size_t n) {
+                    h = (h ^ uint64_t(rx * 1e6)) * 1099511628211ull;
+                    for (size_t i = 0; i < n; ++i) h = (h ^ d[i]) * 1099511628211ull;
+                });
+            }
+            el = seconds_since(t0);
+            digest[pass] = h;
+            st = emu.stats();
+        }
+
+        std::printf("link_emulator     %-6s %7llu sent  %6.2f%% delivered  lost %5llu  offline %5llu  "
+                    "reordered %4llu  outages %2llu  spikes %3llu  burst <= %2llu  latency p50 <= %5.0f us  "
+                    "p99 <= %6.0f us  %5.1f ns/frame  %s\n",
+                    name, (unsigned long long)st.sent, 100.0 * double(st.delivered) / double(st.sent),
+                    (unsigned long long)st.lost, (unsigned long long)st.dropped_offline,
+                    (unsigned long long)st.reordered, (unsigned long long)st.outages,
+                    (unsigned long long)st.spikes, (unsigned long long)st.max_burst,
+                    st.latency_p50_us, st.latency_p99_us, el * 1e9 / double(st.sent),
+                    digest[0] == digest[1] ? "reproducible" : "NOT REPRODUCIBLE");
+        const std::string key = std::string("link_emulator.") + name;
+        record(key, "delivered", 100.0 * double(st.delivered) / double(st.sent), "%");
+        record(key, "latency_p99", st.latency_p99_us, "us");
+        record(key, "cost", el * 1e9 / double(st.sent), "ns/frame");
+    }
+}
+
+// Four real sessions on emulated links for 4 s: busy delivery with loss,
+// and an outage from 1.5 s to 2.3 s on every link. The watchdog (0.3 s)
+// must record the gap and reconnect; frames received against those sent
+// measure what the session keeps under those conditions.
+static void bench_session_link() {
+    const int    devices = 4;
+    const double seconds = 4.0;
+    ImuLinkConditions c;
+    imu_link_profile("busy", c);
+    c.loss       = 0.01;
+    c.loss_burst = 3.0;
+    c.outages    = {{1.5, 0.8}};
+
+    std::vector<ImuEmulatedLink*> links;
+    std::vector<std::unique_ptr<ImuDeviceSession>> sessions;
+    for (int d = 0; d < devices; ++d) {
+        c.seed = 100 + uint64_t(d);
+        auto link = std::make_unique<ImuEmulatedLink>(
+            c, std::make_unique<ImuSyntheticSource>(c.seed, c.frame_rate_hz));
+        links.push_back(link.get());
+        sessions.push_back(std::make_unique<ImuDeviceSession>(std::move(link), "emu" + std::to_string(d)));
+        sessions.back()->set_watchdog(0.3, true);
+        sessions.back()->set_decode_queue(8192);
+    }
+
+    auto t0 = bench_clock::now();
+    for (auto& s : sessions) s->start();
+    size_t received = 0;
+    while (seconds_since(t0) < seconds) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        for (auto& s : sessions) {
+            s->decode_pending();
+            received += s->drain_samples().size();
+        }
+    }
+    ImuLinkStats total;
+    size_t gaps = 0;
+    int reconnects = 0;
+    double gap_s = 0.0;
+    for (int d = 0; d < devices; ++d) {
+        for (const auto& g : sessions[d]->gaps()) gap_s += g.end_s - g.start_s;
+        gaps += sessions[d]->gaps().size();
+        reconnects += sessions[d]->reconnect_count();
+        sessions[d]->stop();
+        const ImuLinkStats st = links[d]->stats();
+        total.sent += st.sent;
+        total.delivered += st.delivered;
+        total.lost += st.lost;
+        total.dropped_offline += st.dropped_offline;
+    }
+    std::printf("session_link      %d sessions %.0f s  %zu / %llu frames sent received (%.1f%%), link lost %llu, "
+                "offline %llu; gaps %zu (%.2f s avg), reconnect attempts %d\n",
+                devices, seconds, received, (unsigned long long)total.sent,
+                100.0 * double(received) / double(std::max<uint64_t>(total.sent, 1)),
+                (unsigned long long)total.lost, (unsigned long long)total.dropped_offline, gaps,
+                gaps ? gap_s / double(gaps) : 0.0, reconnects);
+    record("session_link", "received", 100.0 * double(received) / double(std::max<uint64_t>(total.sent, 1)), "%");
+    record("session_link", "gaps", double(gaps), "count");
+}
+
+// A busy range: 500 advertisers (phones, tags, the station's own units),
+// 3 of them targets, each re-advertising. The old scan callback lowercased
+// every address and searched the target, pooled and found lists linearly;
+// the registry parses the MAC once into an integer and does one hash
+// lookup, with the prefilter (name / services) run once per address.
+static void bench_adv_registry() {
+    const size_t advertisers = 500, adverts = 500'000;
+    std::mt19937_64 rng(7);
+    std::vector<std::string> addrs;
+    for (size_t i = 0; i < advertisers; ++i) {
+        const std::string mac = imu_format_mac(rng() & 0xFFFFFFFFFFFFull);
+        std::string upper = mac;
+        std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+        addrs.push_back(i % 2 ? upper : mac);   // stacks report either case
+    }
+    std::vector<std::string> targets = {addrs[10], addrs[200], addrs[499]};
+    std::vector<std::string> pooled  = {addrs[300]};
+    std::vector<uint32_t> order(adverts);
+    std::vector<int16_t>  rssi(adverts);
+    for (size_t i = 0; i < adverts; ++i) {
+        order[i] = uint32_t(rng() % advertisers);
+        rssi[i]  = int16_t(-40 - int(order[i] % 50) - int(rng() % 6));
+    }
+
+    // Old path, as in ImuQaManager::discover_and_connect before the registry
+    std::vector<std::string> lower_targets = targets;
+    for (auto& a : lower_targets) std::transform(a.begin(), a.end(), a.begin(), ::tolower);
+    std::vector<std::string> found;
+    size_t hits_old = 0;
+    auto t0 = bench_clock::now();
+    for (size_t i = 0; i < adverts; ++i) {
+        std::string addr = addrs[order[i]];
+        std::transform(addr.begin(), addr.end(), addr.begin(), ::tolower);
+        if (std::find(lower_targets.begin(), lower_targets.end(), addr) == lower_targets.end()) continue;
+        if (std::find(pooled.begin(), pooled.end(), addr) != pooled.end()) continue;
+        bool dup = false;
+        for (const auto& e : found) {
+            std::string existing = e;
+            std::transform(existing.begin(), existing.end(), existing.begin(), ::tolower);
+            if (existing == addr) { dup = true; break; }
+        }
+        if (!dup) found.push_back(addr);
+        ++hits_old;
+    }
+    const double el_old = seconds_since(t0);
+
+    ImuScanConfig sc;
+    sc.name_prefix = "GMSync";
+    ImuAdvRegistry reg(sc);
+    reg.set_targets(targets);
+    reg.set_excluded({imu_pack_mac(pooled[0])});
+    size_t hits_new = 0, prefilter_calls = 0;
+    t0 = bench_clock::now();
+    for (size_t i = 0; i < adverts; ++i) {
+        const uint32_t k = order[i];
+        hits_new += reg.observe(imu_pack_mac(addrs[k]), rssi[i], double(i) * 1e-4, [&] {
+            ++prefilter_calls;
+            return reg.prefilter(k % 3 ? "GMSync IMU" : "Phone", {});
+        });
+    }
+    const double el_new = seconds_since(t0);
+    const auto best = reg.strongest(2, double(adverts) * 1e-4);
+
+    std::printf("adv_registry      %zu advertisers, %zu adverts: linear %.1f ns/advert (%zu kept), "
+                "registry %.1f ns/advert (%zu kept, %zu prefilter calls), %.1fx; strongest %s\n",
+                advertisers, adverts, el_old * 1e9 / double(adverts), hits_old,
+                el_new * 1e9 / double(adverts), hits_new, prefilter_calls,
+                el_old / std::max(el_new, 1e-12),
+                best.empty() ? "-" : imu_format_mac(best[0]).c_str());
+    record("adv_registry", "linear", el_old * 1e9 / double(adverts), "ns/advert");
+    record("adv_registry", "registry", el_new * 1e9 / double(adverts), "ns/advert");
+}
+
+// A unit placed on the fixture at t = 0: handling motion (a few dps of
+// swing) for motion_s, then at rest with a 0.8 dps zero-rate bias on x.
+// Adaptive settle should end shortly after the motion with the bias
+// recovered; the fixed settle would always take settle_seconds (5 s).
+static void bench_settle() {
+    ImuQaConfig cfg;
+    std::mt19937 rng(11);
+    std::normal_distribution<float> noise(0.0f, 0.05f);
+    for (double motion_s : {0.0, 1.5, 3.0}) {
+        ImuSettleEstimator est(cfg.settle, cfg.gyro_stillness_deg_per_s);
+        est.reset(0.0);
+        double settled_s = -1.0;
+        size_t frames = 0;
+        double el = 0.0;
+        for (double t = 0.0; t < cfg.settle_seconds && settled_s < 0.0; t += 0.01) {
+            // One 10 ms drain: 2 accel + 2 gyro frames
+            ImuSample chunk[4] = {};
+            for (int k = 0; k < 4; ++k) {
+                ImuSample& f = chunk[k];
+                f.timestamp_s = t + 0.0025 * k;
+                const float swing = f.timestamp_s < motion_s ? 4.0f * std::sin(float(f.timestamp_s) * 9.0f) : 0.0f;
+                if (k % 2 == 0) {
+                    f.ax = noise(rng) * 0.01f;
+                    f.ay = noise(rng) * 0.01f;
+                    f.az = 1.0f + noise(rng) * 0.01f;
+                } else {
+                    f.gx = 0.8f + swing + noise(rng);
+                    f.gy = swing * 0.5f + noise(rng);
+                    f.gz = noise(rng);
+                }
+            }
+            auto t0 = bench_clock::now();
+            est.push(chunk, 4);
+            const bool still = est.still();
+            el += seconds_since(t0);
+            frames += 4;
+            if (still) settled_s = t + 0.01;
+        }
+        const auto e = est.estimate();
+        std::printf("settle            motion %.1f s: settled at %s%.2f s (fixed %.1f s), bias x %.3f dps (true 0.800), "
+                    "%s, %.1f ns/frame\n",
+                    motion_s, settled_s < 0.0 ? "timeout " : "", settled_s < 0.0 ? cfg.settle_seconds : settled_s,
+                    cfg.settle_seconds, e.gyro_bias_dps[0], e.valid ? "valid" : "no estimate",
+                    el * 1e9 / double(frames));
+        char label[32];
+        std::snprintf(label, sizeof(label), "motion %.1fs", motion_s);
+        const std::string key = "settle." + bench_key(label);
+        record(key, "settled", settled_s < 0.0 ? cfg.settle_seconds : settled_s, "s");
+        record(key, "bias_error", std::fabs(e.gyro_bias_dps[0] - 0.8), "dps");
+    }
+}
+
+// A year of station output: units tested repeatedly, results appended in
+// time order, then the queries an operator or a yield report makes
+static void bench_results_db() {
+    const size_t units = 2000, per_unit = 250, records = units * per_unit;
+    const std::string path = (std::filesystem::temp_directory_path() / "recoil_bench_results.imur").string();
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    std::filesystem::remove(path + ".idx", ec);
+
+    std::mt19937_64 rng(5);
+    std::vector<std::string> ids;
+    for (size_t u = 0; u < units; ++u) ids.push_back(imu_format_mac(0x0200'0000'0000ull + u));
+    const int64_t t_begin = int64_t(1'700'000'000) * 1'000'000;
+    const int64_t step_us = int64_t(365) * 86400 * 1'000'000 / int64_t(records);
+
+    ImuQaConfig cfg;
+    ImuResultRecord rec;
+    rec.config_hash = imu_config_hash(cfg);
+    rec.firmware    = "2.4.1";
+    rec.profile     = cfg.profile;
+    rec.result      = ImuQaResult{};
+    rec.result.sample_count = 48000;
+    rec.result.coverage     = 1.0;
+
+    double el_append = 0.0;
+    {
+        ImuResultsDb db;
+        if (!db.open(path)) return;
+        auto t0 = bench_clock::now();
+        for (size_t i = 0; i < records; ++i) {
+            rec.time_us = t_begin + int64_t(i) * step_us;
+            rec.result.device_id = ids[rng() % units];
+            rec.result.status    = rng() % 50 == 0 ? QaStatus::FAIL : QaStatus::PASS;
+            rec.result.mac_deg   = double(rng() % 1000) * 1e-4;
+            db.append(rec);
+        }
+        db.sync();
+        el_append = seconds_since(t0);
+    }
+    const uint64_t log_bytes = std::filesystem::file_size(path, ec);
+
+    ImuResultsDb db;
+    auto t0 = bench_clock::now();
+    db.open(path);
+    const double el_open = seconds_since(t0);
+
+    // A unit's latest ten verdicts, full records read from the log
+    const size_t queries = 2000;
+    size_t found = 0;
+    t0 = bench_clock::now();
+    for (size_t q = 0; q < queries; ++q) {
+        for (const auto& e : db.history(ids[(q * 7919) % units], 10)) {
+            ImuResultRecord out;
+            found += db.read(e, out);
+        }
+    }
+    const double el_history = seconds_since(t0);
+
+    // Daily yield over the whole year, from the index alone
+    t0 = bench_clock::now();
+    const auto days = db.yield(t_begin, t_begin + int64_t(365) * 86400 * 1'000'000, int64_t(86400) * 1'000'000);
+    const double el_yield = seconds_since(t0);
+    uint64_t fails = 0;
+    for (const auto& d : days) fails += d.fail;
+
+    t0 = bench_clock::now();
+    const size_t in_month = db.range(t_begin + int64_t(180) * 86400 * 1'000'000,
+                                     t_begin + int64_t(210) * 86400 * 1'000'000).size();
+    const double el_range = seconds_since(t0);
+    db.close();
+
+    // Index lost: everything re-indexed from the log
+    std::filesystem::remove(path + ".idx", ec);
+    t0 = bench_clock::now();
+    db.open(path);
+    const double el_reindex = seconds_since(t0);
+    const size_t reindexed = db.size();
+    db.close();
+    std::filesystem::remove(path, ec);
+    std::filesystem::remove(path + ".idx", ec);
+
+    std::printf("results_db        %zu records (%.0f B each): append %.0f ns, open %.1f ms, "
+                "history(10) %.1f us (%zu read), yield 365 days %.1f ms (%llu FAIL), "
+                "month range %.2f ms (%zu), re-index %.0f ms (%zu)\n",
+                records, double(log_bytes) / double(records), el_append * 1e9 / double(records),
+                el_open * 1e3, el_history * 1e6 / double(queries), found, el_yield * 1e3,
+                (unsigned long long)fails, el_range * 1e3, in_month, el_reindex * 1e3, reindexed);
+    record("results_db", "append", el_append * 1e9 / double(records), "ns/record");
+    record("results_db", "open", el_open * 1e3, "ms");
+    record("results_db", "history_10", el_history * 1e6 / double(queries), "us/query");
+    record("results_db", "yield_year", el_yield * 1e3, "ms");
+    record("results_db", "reindex", el_reindex * 1e3, "ms");
+}
+
+// Dashboard stream during a test: every unit drains 4 frames per 10 ms
+// poll, one update goes out per period. The stream has to stay within the
+// budget however many units there are; past some count the waveform
+// resolution drops instead.
+static void bench_live_stream() {
+    ImuLiveConfig lc;
+    for (size_t devices : {5, 50, 100}) {
+        ImuLiveStream live(lc);
+        std::vector<std::string> ids;
+        for (size_t d = 0; d < devices; ++d) ids.push_back(imu_format_mac(0x0200'0000'0000ull + d));
+        live.begin_run(ids, 0.0);
+        for (size_t d = 0; d < devices; ++d) live.set_phase(d, ImuLivePhase::Testing);
+
+        std::mt19937 rng(3);
+        std::normal_distribution<float> noise(0.0f, 0.02f);
+        const double seconds = 10.0, poll_s = 0.01, period_s = 1.0 / lc.update_hz;
+        std::vector<ImuSample> chunks(devices * 4);
+        std::string frame;
+        size_t frames = 0, updates = 0, bytes = 0;
+        double el_push = 0.0, el_format = 0.0, next_update = period_s;
+        for (double t = 0.0; t < seconds; t += poll_s) {
+            for (size_t i = 0; i < chunks.size(); ++i) {
+                ImuSample& f = chunks[i];
+                f = ImuSample{};
+                f.timestamp_s = t + 0.0025 * double(i % 4);
+                if (i % 2 == 0) {
+                    f.az = 1.0f + noise(rng);
+                } else {
+                    f.gx = noise(rng);
+                }
+            }
+            auto t0 = bench_clock::now();
+            for (size_t d = 0; d < devices; ++d) {
+                live.push(d, chunks.data() + 4 * d, 4);
+                live.tilt(d, t, 0.01 * double(d), -0.01 * double(d));
+            }
+            el_push += seconds_since(t0);
+            frames += chunks.size();
+            if (t + poll_s >= next_update) {
+                frame.clear();
+                auto t0 = bench_clock::now();
+                bytes += live.format(frame, t + poll_s);
+                el_format += seconds_since(t0);
+                ++updates;
+                next_update += period_s;
+            }
+        }
+        std::printf("live_stream       %zu devices: %d points/update, %.1f ns/frame folded, %.1f us/update, "
+                    "%.0f B/update, %.0f KiB/s (budget %zu KiB/s)\n",
+                    devices, live.points(), el_push * 1e9 / double(frames), el_format * 1e6 / double(updates),
+                    double(bytes) / double(updates), double(bytes) / seconds / 1024.0,
+                    lc.budget_bytes_per_s / 1024);
+        const std::string key = "live_stream." + bench_key(std::to_string(devices) + " devices");
+        record(key, "fold", el_push * 1e9 / double(frames), "ns/frame");
+        record(key, "format", el_format * 1e6 / double(updates), "us/update");
+        record(key, "stream", double(bytes) / seconds / 1024.0, "KiB/s");
+    }
+}
+
+// recoil_tracker_bench [samples] [--json file] [--label text] [--filter name,...]
+int main(int argc, char** argv) {
+    size_t n = 10'000'000;
+    std::string json, label, filter;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        if (a == "--json" && i + 1 < argc)        json   = argv[++i];
+        else if (a == "--label" && i + 1 < argc)  label  = argv[++i];
+        else if (a == "--filter" && i + 1 < argc) filter = argv[++i];
+        else if (!a.empty() && std::isdigit(static_cast<unsigned char>(a[0]))) n = std::strtoull(a.c_str(), nullptr, 10);
+        else {
+            std::fprintf(stderr, "usage: %s [samples] [--json file] [--label text] [--filter name,...]\n", argv[0]);
+            return 2;
+        }
+    }
+    n = std::max<size_t>(n, 1000);
+
+    // --filter takes a comma-separated list of name prefixes
+    auto wanted = [&](const char* name) {
+        if (filter.empty()) return true;
+        for (size_t at = 0; at <= filter.size();) {
+            size_t end = filter.find(',', at);
+            if (end == std::string::npos) end = filter.size();
+            const std::string p = filter.substr(at, end - at);
+            if (!p.empty() && std::string(name).compare(0, p.size(), p) == 0) return true;
+            at = end + 1;
+        }
+        return false;
+    };
+
+    std::vector<ImuSample> samples;
+    auto with_samples = [&]() -> const std::vector<ImuSample>& {
+        if (samples.empty()) samples = make_samples(n);
+        return samples;
+    };
+
+    struct Bench { const char* name; std::function<void()> run; };
+    const Bench benches[] = {
+        {"csv_format",        [&] { bench_csv_format(with_samples()); }},
+        {"jsonl_format",      [&] { bench_jsonl_format(with_samples()); }},
+        {"exporter_csv_disk", [&] { bench_exporter_end_to_end(with_samples()); }},
+        {"exporter_bounded",  [&] { bench_exporter_bounded(with_samples()); }},
+        {"frame_decode",      [&] { bench_frame_decode(n); }},
+        {"buffer_contention", [&] { bench_buffer_contention(); }},
+        {"buffer_spill",      [&] { bench_buffer_spill(); }},
+        {"shot_detector",     [&] { bench_shot_detector(std::min<size_t>(n, 2'000'000)); }},
+        {"recoil_analyzer",   [&] { bench_recoil_analyzer(); }},
+        {"burst_capture",     [&] { bench_burst_capture(); }},
+        {"event_bus",         [&] { bench_event_bus(); }},
+        {"orientation",       [&] { bench_orientation(); }},
+        {"differential",      [&] { bench_differential(); }},
+        {"spectrum",          [&] { bench_spectrum(); }},
+        {"link_emulator",     [&] { bench_link_emulator(); }},
+        {"session_link",      [&] { bench_session_link(); }},
+        {"adv_registry",      [&] { bench_adv_registry(); }},
+        {"settle",            [&] { bench_settle(); }},
+        {"results_db",        [&] { bench_results_db(); }},
+        {"live_stream",       [&] { bench_live_stream(); }},
+        {"evaluate_device",   [&] { bench_evaluate(std::min<size_t>(n, 10'000'000)); }},
+        {"executor_jitter",   [&] { bench_executor(); }},
+        {"block_codec",       [&] { bench_block_codec(std::max<size_t>(n, 1000000)); }},
+        {"compact_samples",   [&] { bench_compact_samples(std::max<size_t>(n, 1000000)); }},
+        {"run_storage",       [&] { bench_run_storage(); }},
+    };
+    for (const auto& b : benches) {
+        if (wanted(b.name)) b.run();
+    }
+
+    if (!json.empty() && !write_json(json, label, n)) return 1;
+    return 0;
+}
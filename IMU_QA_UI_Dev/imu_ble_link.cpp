@@ -0,0 +1,47 @@
+#include "imu_ble_link.h"
+
+static const char* kService = "0000b3a0-0000-1000-8000-00805f9b34fb";
+static const char* kNotify  = "0000b3a1-0000-1000-8000-00805f9b34fb";
+static const char* kCommand = "0000b3a2-0000-1000-8000-00805f9b34fb";
+static const char* kDeviceInfo = "0000180a-0000-1000-8000-00805f9b34fb";
+static const char* kFirmwareRevision = "00002a26-0000-1000-8000-00805f9b34fb";
+
+void ImuBleLink::connect() {
+    peripheral_.connect();
+}
+
+void ImuBleLink::disconnect() {
+    peripheral_.disconnect();
+}
+
+bool ImuBleLink::is_connected() {
+    return peripheral_.is_connected();
+}
+
+void ImuBleLink::subscribe(NotifyFn fn) {
+    peripheral_.notify(kService, kNotify, [fn = std::move(fn)](SimpleBLE::ByteArray bytes) {
+        fn(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+    });
+}
+
+void ImuBleLink::unsubscribe() {
+    peripheral_.unsubscribe(kService, kNotify);
+}
+
+void ImuBleLink::write(const std::vector<uint8_t>& bytes) {
+    peripheral_.write_request(kService, kCommand, bytes);
+}
+
+void ImuBleLink::set_on_disconnected(std::function<void()> fn) {
+    peripheral_.set_callback_on_disconnected(std::move(fn));
+}
+
+std::string ImuBleLink::firmware() {
+    try {
+        std::string rev = peripheral_.read(kDeviceInfo, kFirmwareRevision);
+        while (!rev.empty() && (rev.back() == '\0' || rev.back() == ' ')) rev.pop_back();
+        return rev;
+    } catch (const std::exception&) {
+        return {};   // no Device Information service
+    }
+}
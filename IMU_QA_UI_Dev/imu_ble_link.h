@@ -0,0 +1,22 @@
+#pragma once
+#include "imu_link.h"
+#include <simpleble/SimpleBLE.h>
+
+// ImuLink over a SimpleBLE peripheral (GMSync service b3a0: notifications
+// on b3a1, commands to b3a2)
+class ImuBleLink : public ImuLink {
+public:
+    explicit ImuBleLink(SimpleBLE::Peripheral peripheral) : peripheral_(std::move(peripheral)) {}
+
+    void connect() override;
+    void disconnect() override;
+    bool is_connected() override;
+    void subscribe(NotifyFn fn) override;
+    void unsubscribe() override;
+    void write(const std::vector<uint8_t>& bytes) override;
+    void set_on_disconnected(std::function<void()> fn) override;
+    std::string firmware() override;   // Device Information service, 0x2A26
+
+private:
+    SimpleBLE::Peripheral peripheral_;
+};
@@ -0,0 +1,725 @@
+#include "imu_block_codec.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+// x86-64 GCC / Clang: channels also decode with AVX2, chosen at run time
+// so the build needs no -mavx2
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define IMU_CODEC_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Payloads are little endian; the fast unpack loads them directly, so
+// this assumes a little-endian host (x86, ARM)
+constexpr size_t kHeaderBytes = 4 + 2 + 2 + 8;
+
+// Channel mode byte: bit 0 delta-of-delta, bits 1-2 payload layout
+constexpr unsigned kLayoutPacked = 0;
+constexpr unsigned kLayoutVarint = 1;
+constexpr unsigned kLayoutSparse = 2;
+
+inline uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+inline size_t varint_size(uint64_t v) {
+    size_t n = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        ++n;
+    }
+    return n;
+}
+
+inline void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+inline const uint8_t* get_varint(const uint8_t* p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        const uint8_t b = *p++;
+        v |= uint64_t(b & 0x7F) << shift;
+        if (!(b & 0x80)) return p;
+    }
+    return nullptr;
+}
+
+template <class T>
+inline void put_le(std::vector<uint8_t>& out, T v) {
+    for (size_t i = 0; i < sizeof(T); ++i) out.push_back(static_cast<uint8_t>(uint64_t(v) >> (8 * i)));
+}
+
+template <class T>
+inline T get_le(const uint8_t* p) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) v |= uint64_t(p[i]) << (8 * i);
+    return static_cast<T>(v);
+}
+
+inline unsigned bit_width(uint64_t v) {
+    unsigned w = 0;
+    while (v) {
+        ++w;
+        v >>= 1;
+    }
+    return w;
+}
+
+inline int16_t to_counts(float v, double counts_per_unit) {
+    double c = std::round(static_cast<double>(v) * counts_per_unit);
+    return static_cast<int16_t>(std::clamp(c, -32768.0, 32767.0));
+}
+
+// Eight W-bit values occupy exactly W bytes. Every shift is a constant, so
+// the inner loop unrolls into independent load / shift / mask lanes. Reads
+// up to 8 bytes past the group; callers keep that much input in range.
+template <unsigned W>
+void unpack_groups(const uint8_t* in, uint32_t* out, size_t groups) {
+    constexpr uint64_t mask = W == 32 ? 0xFFFFFFFFull : (uint64_t(1) << W) - 1;
+    for (size_t g = 0; g < groups; ++g, in += W, out += 8) {
+        for (unsigned k = 0; k < 8; ++k) {
+            const unsigned bit = k * W;
+            uint64_t v;
+            std::memcpy(&v, in + (bit >> 3), sizeof(v));
+            out[k] = static_cast<uint32_t>((v >> (bit & 7)) & mask);
+        }
+    }
+}
+
+using UnpackFn = void (*)(const uint8_t*, uint32_t*, size_t);
+
+template <size_t... W>
+constexpr std::array<UnpackFn, sizeof...(W)> make_unpack_table(std::index_sequence<W...>) {
+    return {{&unpack_groups<unsigned(W)>...}};
+}
+
+constexpr auto kUnpack = make_unpack_table(std::make_index_sequence<33>{});
+
+// Bounds-checked path for the last groups of a payload
+void unpack_tail(const uint8_t* in, size_t bytes, unsigned w, size_t first, size_t count, uint32_t* out) {
+    for (size_t i = first; i < count; ++i) {
+        const size_t bit = i * w;
+        uint64_t v = 0;
+        for (size_t b = bit >> 3, s = 0; s < (bit & 7) + w && b < bytes; ++b, s += 8) {
+            v |= uint64_t(in[b]) << s;
+        }
+        out[i] = static_cast<uint32_t>((v >> (bit & 7)) & (w == 32 ? 0xFFFFFFFFull : (uint64_t(1) << w) - 1));
+    }
+}
+
+} // namespace
+
+// ---- ImuFrameColumns ---------------------------------------------------------
+
+void ImuFrameColumns::clear() {
+    t_us.clear();
+    accel.clear();
+    x.clear();
+    y.clear();
+    z.clear();
+}
+
+void ImuFrameColumns::reserve(size_t n) {
+    t_us.reserve(n);
+    accel.reserve(n);
+    x.reserve(n);
+    y.reserve(n);
+    z.reserve(n);
+}
+
+void ImuFrameColumns::push(int64_t t, bool a, int16_t vx, int16_t vy, int16_t vz) {
+    t_us.push_back(t);
+    accel.push_back(a ? 1 : 0);
+    x.push_back(vx);
+    y.push_back(vy);
+    z.push_back(vz);
+}
+
+void ImuFrameColumns::push(const ImuSample& s) {
+    const int64_t t = static_cast<int64_t>(std::llround(s.timestamp_s * 1e6));
+    if (s.ax != 0.0f || s.ay != 0.0f || s.az != 0.0f) {
+        push(t, true, to_counts(s.ax, kAccelCountsPerG), to_counts(s.ay, kAccelCountsPerG),
+             to_counts(s.az, kAccelCountsPerG));
+    } else {
+        push(t, false, to_counts(s.gx, kGyroCountsPerDps), to_counts(s.gy, kGyroCountsPerDps),
+             to_counts(s.gz, kGyroCountsPerDps));
+    }
+}
+
+// Same arithmetic as the session's frame decode, so samples compare equal
+void ImuFrameColumns::append_to(std::vector<ImuSample>& out) const {
+    const size_t base = out.size();
+    out.resize(base + size());
+    for (size_t i = 0; i < size(); ++i) {
+        ImuSample s{};
+        s.timestamp_s = double(t_us[i]) * 1e-6;
+        if (accel[i]) {
+            s.ax = 16.0f * x[i] / 32768.0f;
+            s.ay = 16.0f * y[i] / 32768.0f;
+            s.az = 16.0f * z[i] / 32768.0f;
+        } else {
+            s.gx = 500.0f * x[i] / 28571.0f;
+            s.gy = 500.0f * y[i] / 28571.0f;
+            s.gz = 500.0f * z[i] / 28571.0f;
+        }
+        out[base + i] = s;
+    }
+}
+
+// ---- ImuBlockEncoder ---------------------------------------------------------
+
+void ImuBlockEncoder::encode(const ImuFrameColumns& f, size_t first, size_t n,
+                             std::vector<uint8_t>& out) {
+    n = std::min({n, kBlockFrames, f.size() > first ? f.size() - first : size_t(0)});
+    if (n == 0) return;
+
+    size_t n_accel = 0;
+    for (size_t i = first; i < first + n; ++i) n_accel += f.accel[i] ? 1 : 0;
+
+    const size_t start = out.size();
+    put_le(out, uint32_t(0));   // patched below
+    put_le(out, static_cast<uint16_t>(n));
+    put_le(out, static_cast<uint16_t>(n_accel));
+    put_le(out, f.t_us[first]);
+
+    const size_t map_at = out.size();
+    out.resize(map_at + (n + 7) / 8, 0);
+    for (size_t i = 0; i < n; ++i) {
+        if (f.accel[first + i]) out[map_at + i / 8] |= uint8_t(1u << (i % 8));
+    }
+
+    values_.assign(f.t_us.begin() + first, f.t_us.begin() + first + n);
+    channel(n, out);
+
+    for (uint8_t want : {uint8_t(1), uint8_t(0)}) {
+        for (const std::vector<int16_t>* axis : {&f.x, &f.y, &f.z}) {
+            values_.clear();
+            for (size_t i = first; i < first + n; ++i) {
+                if (f.accel[i] == want) values_.push_back((*axis)[i]);
+            }
+            channel(values_.size(), out);
+        }
+    }
+
+    const uint32_t bytes = static_cast<uint32_t>(out.size() - start);
+    for (int i = 0; i < 4; ++i) out[start + i] = static_cast<uint8_t>(bytes >> (8 * i));
+}
+
+void ImuBlockEncoder::encode_all(const ImuFrameColumns& f, std::vector<uint8_t>& out) {
+    for (size_t i = 0; i < f.size(); i += kBlockFrames) encode(f, i, kBlockFrames, out);
+}
+
+// values_[0..count) -> out. The first value is stored as is; the rest as
+// residuals in whichever layout is smallest.
+void ImuBlockEncoder::channel(size_t count, std::vector<uint8_t>& out) {
+    if (count == 0) return;
+    const size_t m = count - 1;
+    delta_.resize(m);
+    dod_.resize(m);
+    int64_t prev_d = 0;
+    for (size_t i = 0; i < m; ++i) {
+        const int64_t d = values_[i + 1] - values_[i];
+        delta_[i] = zigzag(d);
+        dod_[i]   = zigzag(d - prev_d);
+        prev_d    = d;
+    }
+
+    // Cost of each layout for one residual sequence. Packed and sparse
+    // payloads are limited to 32-bit values, which the fast unpack covers.
+    constexpr size_t kNever = ~size_t(0);
+    struct Plan {
+        size_t   cost[3] = {kNever, kNever, kNever};   // packed, varint, sparse
+        unsigned width   = 0;                          // packed
+        unsigned sparse_width = 0;
+        uint64_t sparse_min   = 0;
+    };
+    auto plan = [&](const std::vector<uint64_t>& r) {
+        Plan pl;
+        uint64_t all = 0, lo = ~uint64_t(0), hi = 0;
+        size_t   var = 0, nz = 0;
+        for (uint64_t v : r) {
+            all |= v;
+            var += varint_size(v);
+            if (v) {
+                ++nz;
+                lo = std::min(lo, v);
+                hi = std::max(hi, v);
+            }
+        }
+        pl.width = bit_width(all);
+        if (pl.width <= 32) pl.cost[kLayoutPacked] = (m * pl.width + 7) / 8;
+        pl.cost[kLayoutVarint] = 4 + var;
+        if (nz == 0) lo = hi = 0;
+        pl.sparse_min   = lo;
+        pl.sparse_width = bit_width(hi - lo);
+        if (hi <= 0xFFFFFFFFull) {
+            pl.cost[kLayoutSparse] = (m + 7) / 8 + varint_size(lo) + (nz * pl.sparse_width + 7) / 8;
+        }
+        return pl;
+    };
+    const Plan plans[2] = {plan(delta_), plan(dod_)};
+
+    int dod = 0, layout = kLayoutPacked;
+    for (int d = 0; d < 2; ++d) {
+        for (int l = 0; l < 3; ++l) {
+            if (plans[d].cost[l] < plans[dod].cost[layout]) {
+                dod    = d;
+                layout = l;
+            }
+        }
+    }
+    const Plan& pl = plans[dod];
+    const std::vector<uint64_t>& r = dod ? dod_ : delta_;
+    const unsigned width = layout == kLayoutPacked ? pl.width : layout == kLayoutSparse ? pl.sparse_width : 0;
+
+    out.push_back(static_cast<uint8_t>(dod | (layout << 1)));
+    out.push_back(static_cast<uint8_t>(width));
+    put_varint(out, zigzag(values_[0]));
+
+    if (layout == kLayoutVarint) {
+        put_le(out, static_cast<uint32_t>(pl.cost[kLayoutVarint] - 4));
+        for (uint64_t v : r) put_varint(out, v);
+        return;
+    }
+
+    uint64_t sub = 0;
+    if (layout == kLayoutSparse) {
+        const size_t map_at = out.size();
+        out.resize(map_at + (m + 7) / 8, 0);
+        for (size_t i = 0; i < m; ++i) {
+            if (r[i]) out[map_at + i / 8] |= uint8_t(1u << (i % 8));
+        }
+        put_varint(out, pl.sparse_min);
+        sub = pl.sparse_min;
+    }
+    uint64_t acc  = 0;
+    unsigned bits = 0;
+    for (uint64_t v : r) {
+        if (layout == kLayoutSparse && v == 0) continue;
+        acc |= (v - sub) << bits;
+        bits += width;
+        while (bits >= 8) {
+            out.push_back(static_cast<uint8_t>(acc));
+            acc >>= 8;
+            bits -= 8;
+        }
+    }
+    if (bits > 0) out.push_back(static_cast<uint8_t>(acc));
+}
+
+// ---- ImuBlockDecoder ---------------------------------------------------------
+
+namespace {
+
+template <class Out>
+using RunningSum = std::conditional_t<sizeof(Out) <= 4, uint32_t, uint64_t>;
+
+// Residuals back to values: zigzag, then one (delta) or two (dod) running
+// sums. Sparse channels take residual i from the packed list only where the
+// bitmap has a 1. Int16 channels sum in 32 bits, time in 64; unsigned so
+// damaged input only wraps. Covers residuals [from, m), carrying on from the
+// running value v and delta d, with j the next entry of a sparse list.
+template <bool kDod, bool kSparse, class Out, class R, class U = RunningSum<Out>>
+void rebuild(const R* r, size_t from, size_t m, U v, U d, size_t j, const uint8_t* map, R floor, Out* out) {
+    for (size_t i = from; i < m; ++i) {
+        U z;
+        if constexpr (kSparse) {
+            const unsigned bit = (map[i >> 3] >> (i & 7)) & 1u;
+            z = bit ? static_cast<U>(r[j] + floor) : 0;
+            j += bit;
+        } else {
+            z = static_cast<U>(r[i]);
+        }
+        const U delta = (z >> 1) ^ (U(0) - (z & 1));
+        if constexpr (kDod) {
+            d += delta;
+            v += d;
+        } else {
+            v += delta;
+        }
+        out[i + 1] = static_cast<Out>(v);
+    }
+}
+
+template <class Out, class R, class U = RunningSum<Out>>
+void rebuild_any(bool dod, bool sparse, const R* r, size_t from, size_t m, U v, U d, size_t j,
+                 const uint8_t* map, R floor, Out* out) {
+    if (dod) {
+        sparse ? rebuild<true, true>(r, from, m, v, d, j, map, floor, out)
+               : rebuild<true, false>(r, from, m, v, d, j, map, floor, out);
+    } else {
+        sparse ? rebuild<false, true>(r, from, m, v, d, j, map, floor, out)
+               : rebuild<false, false>(r, from, m, v, d, j, map, floor, out);
+    }
+}
+
+// Bitmap byte -> its eight bits as 0 / 1 bytes, little endian
+constexpr std::array<uint64_t, 256> make_byte_bits() {
+    std::array<uint64_t, 256> t{};
+    for (unsigned b = 0; b < 256; ++b) {
+        for (unsigned k = 0; k < 8; ++k) t[b] |= uint64_t((b >> k) & 1u) << (8 * k);
+    }
+    return t;
+}
+
+constexpr auto kByteBits = make_byte_bits();
+
+// Sum of the 0 / 1 bytes of a kByteBits entry
+inline unsigned count_bits(uint64_t bytes) {
+    return unsigned((bytes * 0x0101010101010101ull) >> 56);
+}
+
+#ifdef IMU_CODEC_AVX2
+// Widest residual the AVX2 unpack covers: a lane reads 32 bits from a
+// byte boundary, so shift (< 8) + width must fit
+constexpr unsigned kAvx2MaxWidth = 25;
+// Input the AVX2 unpack may read past a group (two 16-byte loads)
+constexpr size_t kAvx2Overread = 16;
+
+bool has_avx2() {
+    static const bool yes = __builtin_cpu_supports("avx2");
+    return yes;
+}
+
+// Per sparse bitmap byte: the lane of the byte's packed residuals each set
+// bit takes (lanes of clear bits are masked off)
+struct ExpandTable {
+    uint32_t lane[256][8];
+};
+
+constexpr ExpandTable make_expand_table() {
+    ExpandTable t{};
+    for (unsigned b = 0; b < 256; ++b) {
+        unsigned j = 0;
+        for (unsigned k = 0; k < 8; ++k) {
+            t.lane[b][k] = j;
+            j += (b >> k) & 1u;
+        }
+    }
+    return t;
+}
+
+constexpr ExpandTable kExpand = make_expand_table();
+
+// Eight width-w residuals per group of w bytes: two 16-byte loads (lanes
+// 0-3 from the group start, 4-7 from byte 4w / 8), a byte shuffle
+// gathering each lane's four bytes, per-lane shifts and a mask
+struct Avx2Unpack {
+    __m256i  shuffle, shifts, mask;
+    unsigned hi_byte;
+};
+
+__attribute__((target("avx2"))) inline Avx2Unpack avx2_unpack_setup(unsigned w) {
+    Avx2Unpack u;
+    u.hi_byte = (4 * w) >> 3;
+    alignas(32) uint8_t  shuf[32];
+    alignas(32) uint32_t shift[8];
+    for (unsigned k = 0; k < 8; ++k) {
+        const unsigned bit = k * w - (k < 4 ? 0 : 8 * u.hi_byte);
+        for (unsigned b = 0; b < 4; ++b) shuf[4 * k + b] = uint8_t((bit >> 3) + b);
+        shift[k] = bit & 7;
+    }
+    u.shuffle = _mm256_load_si256(reinterpret_cast<const __m256i*>(shuf));
+    u.shifts  = _mm256_load_si256(reinterpret_cast<const __m256i*>(shift));
+    u.mask    = _mm256_set1_epi32(int((uint64_t(1) << w) - 1));
+    return u;
+}
+
+__attribute__((target("avx2"))) inline __m256i avx2_unpack8(const Avx2Unpack& u, const uint8_t* in) {
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + u.hi_byte));
+    const __m256i z  = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    return _mm256_and_si256(_mm256_srlv_epi32(_mm256_shuffle_epi8(z, u.shuffle), u.shifts), u.mask);
+}
+
+__attribute__((target("avx2"))) inline __m256i avx2_unzigzag(__m256i z) {
+    return _mm256_xor_si256(_mm256_srli_epi32(z, 1),
+                            _mm256_sub_epi32(_mm256_setzero_si256(), _mm256_and_si256(z, _mm256_set1_epi32(1))));
+}
+
+// Inclusive prefix sums across one register: within each 128-bit half,
+// then the low half's total into the high half
+__attribute__((target("avx2"))) inline __m256i avx2_scan32(__m256i x) {
+    // Pairs with a 64-bit shift (off the shuffle port), then each pair's
+    // total into the next pair
+    x = _mm256_add_epi32(x, _mm256_slli_epi64(x, 32));
+    x = _mm256_add_epi32(x, _mm256_blend_epi32(_mm256_setzero_si256(), _mm256_shuffle_epi32(x, 0x55), 0xCC));
+    const __m256i last = _mm256_shuffle_epi32(x, 0xFF);
+    return _mm256_add_epi32(x, _mm256_permute2x128_si256(last, last, 0x08));
+}
+
+__attribute__((target("avx2"))) inline __m256i avx2_scan64(__m256i x) {
+    x = _mm256_add_epi64(x, _mm256_slli_si256(x, 8));
+    return _mm256_add_epi64(x, _mm256_blend_epi32(_mm256_setzero_si256(), _mm256_permute4x64_epi64(x, 0x55), 0xF0));
+}
+
+__attribute__((target("avx2")))
+void unpack_avx2(const uint8_t* in, size_t groups, unsigned w, uint32_t* out) {
+    const Avx2Unpack u = avx2_unpack_setup(w);
+    for (size_t g = 0; g < groups; ++g, in += w, out += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), avx2_unpack8(u, in));
+    }
+}
+
+// Packed int16 channel, 8 * groups residuals of width w (1..kAvx2MaxWidth)
+// unpacked and summed in one pass, eight per register; v and d carry the
+// running sums in and out
+__attribute__((target("avx2")))
+void rebuild16_avx2(const uint8_t* in, size_t groups, unsigned w, bool dod, uint32_t& v, uint32_t& d,
+                    int16_t* out) {
+    const Avx2Unpack u = avx2_unpack_setup(w);
+    const __m256i top = _mm256_set1_epi32(7);
+    // Low two bytes of every lane, then both halves' eight bytes together
+    const __m256i narrow = _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1,
+                                            0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+    __m256i vv = _mm256_set1_epi32(int(v));
+    __m256i dd = _mm256_set1_epi32(int(d));
+    for (size_t g = 0; g < groups; ++g, in += w, out += 8) {
+        __m256i x = avx2_unzigzag(avx2_unpack8(u, in));
+        if (dod) {
+            x  = _mm256_add_epi32(avx2_scan32(x), dd);
+            dd = _mm256_permutevar8x32_epi32(x, top);
+        }
+        x  = _mm256_add_epi32(avx2_scan32(x), vv);
+        vv = _mm256_permutevar8x32_epi32(x, top);
+        const __m256i n16 = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(x, narrow), 0x08);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(n16));
+    }
+    v = uint32_t(_mm256_cvtsi256_si32(vv));
+    d = uint32_t(_mm256_cvtsi256_si32(dd));
+}
+
+// Time channel, 8 * groups residuals from the unpacked list r, eight at a
+// time: sparse groups spread their packed residuals onto the bitmap's set
+// bits (r holds eight entries past the list). Zigzag in 32 bits, sums in 64.
+__attribute__((target("avx2")))
+void rebuild64_avx2(const uint32_t* r, size_t groups, const uint8_t* map, uint32_t floor, bool dod,
+                    uint64_t& v, uint64_t& d, size_t& j, int64_t* out) {
+    const __m256i bit_of = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256i floors = _mm256_set1_epi32(int(floor));
+    __m256i vv = _mm256_set1_epi64x(int64_t(v));
+    __m256i dd = _mm256_set1_epi64x(int64_t(d));
+    for (size_t g = 0; g < groups; ++g, out += 8) {
+        __m256i z;
+        if (map) {
+            const unsigned b = map[g];
+            const __m256i set  = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(int(b)), bit_of), bit_of);
+            const __m256i lane = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kExpand.lane[b]));
+            z = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(r + j)), lane);
+            z = _mm256_and_si256(_mm256_add_epi32(z, floors), set);
+            j += count_bits(kByteBits[b]);
+        } else {
+            z = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r + 8 * g));
+        }
+        const __m256i x  = avx2_unzigzag(z);
+        __m256i       lo = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x));
+        __m256i       hi = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1));
+        if (dod) {
+            lo = _mm256_add_epi64(avx2_scan64(lo), dd);
+            hi = _mm256_add_epi64(avx2_scan64(hi), _mm256_permute4x64_epi64(lo, 0xFF));
+            dd = _mm256_permute4x64_epi64(hi, 0xFF);
+        }
+        lo = _mm256_add_epi64(avx2_scan64(lo), vv);
+        hi = _mm256_add_epi64(avx2_scan64(hi), _mm256_permute4x64_epi64(lo, 0xFF));
+        vv = _mm256_permute4x64_epi64(hi, 0xFF);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 4), hi);
+    }
+    v = uint64_t(_mm_cvtsi128_si64(_mm256_castsi256_si128(vv)));
+    d = uint64_t(_mm_cvtsi128_si64(_mm256_castsi256_si128(dd)));
+}
+#endif
+
+// Accel and gyro values back into frame order. Units normally alternate
+// accel / gyro, which is a plain interleave the compiler vectorises; any
+// other order (a dropped frame) walks the kind column.
+void interleave(const uint8_t* kind, size_t n, bool alternating, const int16_t* __restrict a, size_t n_accel,
+                const int16_t* __restrict g, int16_t* __restrict out) {
+    if (alternating) {
+        const size_t n_gyro = n - n_accel;
+        for (size_t j = 0; j < n_gyro; ++j) {
+            out[2 * j]     = a[j];
+            out[2 * j + 1] = g[j];
+        }
+        if (n & 1) out[n - 1] = a[n_accel - 1];
+        return;
+    }
+    size_t ia = 0, ig = 0;
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = kind[i] ? a[ia++] : g[ig++];
+    }
+}
+
+} // namespace
+
+size_t ImuBlockDecoder::decode(const uint8_t* p, size_t avail, ImuFrameColumns& out) {
+    if (avail < kHeaderBytes) return 0;
+    const uint32_t bytes   = get_le<uint32_t>(p);
+    const size_t   n       = get_le<uint16_t>(p + 4);
+    const size_t   n_accel = get_le<uint16_t>(p + 6);
+    const int64_t  t0      = get_le<int64_t>(p + 8);
+    if (bytes > avail || bytes < kHeaderBytes + (n + 7) / 8 || n == 0 ||
+        n > ImuBlockEncoder::kBlockFrames || n_accel > n) {
+        return 0;
+    }
+    const uint8_t* end = p + bytes;
+    const uint8_t* map = p + kHeaderBytes;
+    const uint8_t* q   = map + (n + 7) / 8;
+
+    const size_t base = out.size();
+    out.t_us.resize(base + n);
+    out.accel.resize(base + n);
+    out.x.resize(base + n);
+    out.y.resize(base + n);
+    out.z.resize(base + n);
+
+    // Kind bitmap to one byte per frame, a table entry per bitmap byte.
+    // Alternating accel / gyro (0x55 bytes) merges as a plain interleave.
+    uint8_t kind[ImuBlockEncoder::kBlockFrames + 8];
+    size_t accel_frames = 0;
+    bool   alternating  = true;
+    for (size_t j = 0; j < (n + 7) / 8; ++j) {
+        // Bits past frame n are not part of the block
+        const uint8_t valid = j + 1 < (n + 7) / 8 || n % 8 == 0 ? 0xFF : uint8_t((1u << (n % 8)) - 1);
+        const uint64_t bits = kByteBits[map[j] & valid];
+        std::memcpy(kind + 8 * j, &bits, 8);
+        accel_frames += count_bits(bits);
+        alternating = alternating && (map[j] & valid) == (0x55 & valid);
+    }
+    std::memcpy(out.accel.data() + base, kind, n);
+
+    // Each axis is decoded per sensor stream, then merged into frame order
+    bool ok = accel_frames == n_accel;
+    ok = ok && (q = channel(q, end, n, out.t_us.data() + base)) && out.t_us[base] == t0;
+    streams_.resize(6 * ImuBlockEncoder::kBlockFrames);
+    int16_t* axes[3] = {out.x.data() + base, out.y.data() + base, out.z.data() + base};
+    for (int k = 0; k < 6 && ok; ++k) {
+        ok = (q = channel(q, end, k < 3 ? n_accel : n - n_accel,
+                          streams_.data() + k * ImuBlockEncoder::kBlockFrames)) != nullptr;
+    }
+    for (int k = 0; k < 3 && ok; ++k) {
+        interleave(kind, n, alternating, streams_.data() + k * ImuBlockEncoder::kBlockFrames, n_accel,
+                   streams_.data() + (k + 3) * ImuBlockEncoder::kBlockFrames, axes[k]);
+    }
+    if (!ok) {
+        out.t_us.resize(base);
+        out.accel.resize(base);
+        out.x.resize(base);
+        out.y.resize(base);
+        out.z.resize(base);
+        return 0;
+    }
+    return bytes;
+}
+
+template <class Out>
+const uint8_t* ImuBlockDecoder::channel(const uint8_t* p, const uint8_t* end, size_t count, Out* out) {
+    if (count == 0) return p;
+    if (end - p < 3) return nullptr;
+    const bool     dod    = p[0] & 1u;
+    const unsigned layout = p[0] >> 1;
+    const unsigned width  = p[1];
+    uint64_t first;
+    if (layout > kLayoutSparse || width > 32 || !(p = get_varint(p + 2, end, first))) return nullptr;
+    const size_t m = count - 1;
+
+    out[0] = static_cast<Out>(unzigzag(first));
+    RunningSum<Out> v = static_cast<RunningSum<Out>>(out[0]), d = 0;
+
+    if (layout == kLayoutVarint) {
+        if (end - p < 4) return nullptr;
+        const uint32_t len = get_le<uint32_t>(p);
+        p += 4;
+        if (size_t(end - p) < len) return nullptr;
+        const uint8_t* stop = p + len;
+        wide_.resize(m);
+        for (size_t i = 0; i < m; ++i) {
+            if (!(p = get_varint(p, stop, wide_[i]))) return nullptr;
+        }
+        rebuild_any<Out, uint64_t>(dod, false, wide_.data(), 0, m, v, d, 0, nullptr, 0, out);
+        return stop;
+    }
+
+    // Sparse: bitmap of the non-zero residuals, then those minus a floor
+    const uint8_t* map = nullptr;
+    uint64_t floor = 0;
+    size_t   k = m;
+    if (layout == kLayoutSparse) {
+        if (size_t(end - p) < (m + 7) / 8) return nullptr;
+        map = p;
+        p  += (m + 7) / 8;
+        k = 0;
+        for (size_t i = 0; i < m / 8; ++i) k += count_bits(kByteBits[map[i]]);
+        if (m % 8) k += count_bits(kByteBits[map[m / 8] & ((1u << (m % 8)) - 1)]);
+        if (!(p = get_varint(p, end, floor)) || floor > 0xFFFFFFFFull) return nullptr;
+    }
+
+    const size_t bytes = (k * width + 7) / 8;
+    const size_t room  = size_t(end - p);
+    if (room < bytes) return nullptr;
+    // Eight spare entries: the AVX2 sparse expand loads eight at a time
+    packed_.resize(std::max(m, k) + 8);
+    size_t done = 0, j = 0;
+
+#ifdef IMU_CODEC_AVX2
+    const bool avx2        = has_avx2();
+    const bool avx2_unpack = avx2 && width >= 1 && width <= kAvx2MaxWidth && room >= kAvx2Overread;
+    // Packed int16 channels: unpack and sum in one pass over the groups
+    // whose over-read stays inside the block
+    if constexpr (std::is_same_v<Out, int16_t>) {
+        if (avx2_unpack && !map) {
+            const size_t groups = std::min(m / 8, (room - kAvx2Overread) / width);
+            rebuild16_avx2(p, groups, width, dod, v, d, out + 1);
+            done = groups * 8;
+            unpack_tail(p, bytes, width, done, m, packed_.data());
+            rebuild_any<Out, uint32_t>(dod, false, packed_.data(), done, m, v, d, 0, nullptr, 0, out);
+            return p + bytes;
+        }
+    }
+#endif
+
+    if (width == 0) {
+        std::fill(packed_.begin(), packed_.begin() + k, 0u);
+    } else {
+        // Whole groups whose over-read stays inside the block
+        size_t groups = 0;
+#ifdef IMU_CODEC_AVX2
+        if (avx2_unpack) {
+            groups = std::min(k / 8, (room - kAvx2Overread) / width);
+            unpack_avx2(p, groups, width, packed_.data());
+        } else
+#endif
+        {
+            groups = std::min(k / 8, room >= 8 ? (room - 8) / width : 0);
+            kUnpack[width](p, packed_.data(), groups);
+        }
+        unpack_tail(p, bytes, width, groups * 8, k, packed_.data());
+    }
+
+#ifdef IMU_CODEC_AVX2
+    if constexpr (std::is_same_v<Out, int64_t>) {
+        if (avx2) {
+            rebuild64_avx2(packed_.data(), m / 8, map, static_cast<uint32_t>(floor), dod, v, d, j, out + 1);
+            done = m / 8 * 8;
+        }
+    }
+#endif
+    rebuild_any<Out, uint32_t>(dod, map != nullptr, packed_.data(), done, m, v, d, j, map,
+                               static_cast<uint32_t>(floor), out);
+    return p + bytes;
+}
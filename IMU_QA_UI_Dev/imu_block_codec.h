@@ -0,0 +1,80 @@
+#pragma once
+#include "imu_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Frames of one device as the device sent them, one column per field
+struct ImuFrameColumns {
+    std::vector<int64_t> t_us;
+    std::vector<uint8_t> accel;   // 1 accel, 0 gyro
+    std::vector<int16_t> x, y, z;
+
+    size_t size() const { return t_us.size(); }
+    bool   empty() const { return t_us.empty(); }
+    void   clear();
+    void   reserve(size_t n);
+
+    void push(int64_t t_us, bool accel, int16_t x, int16_t y, int16_t z);
+    // Scaled samples back to counts (accel / gyro told apart as elsewhere)
+    void push(const ImuSample& s);
+    void append_to(std::vector<ImuSample>& out) const;
+};
+
+// Lossless block codec for int16 IMU frames. A block holds up to
+// kBlockFrames frames of one device and decodes on its own:
+//
+//   u32 block_bytes  u16 n  u16 n_accel  i64 t0_us  u8 kind_bitmap[(n+7)/8]
+//   channel t_us over all n frames (base t0_us)
+//   channels ax ay az over the accel frames, gx gy gz over the gyro frames
+//
+// Each channel is: u8 mode  u8 width  varint zigzag(first value)  payload,
+// holding the zigzagged residuals of the remaining values. Mode bit 0
+// selects delta-of-delta over plain delta, bits 1-2 the payload layout:
+//   0 packed   ceil((count-1) * width / 8) bytes of bit-packed residuals
+//   1 varint   u32 length, then one varint per residual
+//   2 sparse   bitmap of the non-zero residuals, varint floor, then the
+//              non-zero residuals minus floor, bit-packed at width
+// The encoder keeps whichever delta / layout pair is smallest per channel;
+// sparse suits arrival stamps, where most frames share their batch's time.
+class ImuBlockEncoder {
+public:
+    static constexpr size_t kBlockFrames = 1024;
+
+    // Appends one block of frames [first, first + n), n <= kBlockFrames
+    void encode(const ImuFrameColumns& f, size_t first, size_t n, std::vector<uint8_t>& out);
+
+    // Whole columns, as consecutive blocks
+    void encode_all(const ImuFrameColumns& f, std::vector<uint8_t>& out);
+
+private:
+    std::vector<int64_t>  values_;
+    std::vector<uint64_t> delta_;
+    std::vector<uint64_t> dod_;
+
+    void channel(size_t count, std::vector<uint8_t>& out);
+};
+
+// Bit-packed channels of width <= 32 unpack eight values at a time with
+// constant shifts, which compilers turn into straight-line SIMD-friendly
+// code, and alternating accel / gyro frames merge back with a plain
+// interleave. On x86-64 CPUs with AVX2 (checked at run time) channels of
+// width <= 25 unpack with byte shuffles and variable shifts, and the
+// zigzag and running sums run eight residuals per register; int16 axes do
+// both in one pass. Scratch buffers are reused, so decoding does not
+// allocate once the columns have grown.
+class ImuBlockDecoder {
+public:
+    // Appends the block at p to out. Returns the bytes consumed, 0 when the
+    // block is truncated or malformed (out is left as it was).
+    size_t decode(const uint8_t* p, size_t avail, ImuFrameColumns& out);
+
+private:
+    std::vector<uint32_t> packed_;
+    std::vector<uint64_t> wide_;      // varint residuals
+    std::vector<int16_t>  streams_;   // ax ay az gx gy gz of one block
+
+    // Writes the channel's count values to out
+    template <class Out>
+    const uint8_t* channel(const uint8_t* p, const uint8_t* end, size_t count, Out* out);
+};
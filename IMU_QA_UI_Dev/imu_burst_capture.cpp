@@ -0,0 +1,98 @@
+#include "imu_burst_capture.h"
+#include <algorithm>
+#include <cmath>
+
+void ImuBurstCapture::configure(const std::string& device_id, const ImuBurstConfig& cfg,
+                                double trigger_latency_s) {
+    device_id_ = device_id;
+    cfg_       = cfg;
+    size_t cap = static_cast<size_t>(std::ceil((cfg.pre_s + trigger_latency_s) * cfg.max_rate_hz));
+    ring_.assign(std::max<size_t>(cap, 16), RingFrame{});
+
+    // Typical record: pre + post at full rate
+    cur_.frames.reserve(static_cast<size_t>((cfg.pre_s + cfg.post_s) * cfg.max_rate_hz));
+    reset();
+}
+
+void ImuBurstCapture::reset() {
+    ring_head_  = 0;
+    ring_count_ = 0;
+    capturing_  = false;
+    cur_.frames.clear();
+    cur_.triggers_us.clear();
+}
+
+void ImuBurstCapture::trigger(double t, ImuBurstReason reason) {
+    if (ring_.empty()) return;
+
+    if (capturing_) {
+        // Retrigger: keep the record going, bounded by max_record_s
+        cur_.triggers_us.push_back(static_cast<int32_t>(std::llround((t - cur_.trigger_s) * 1e6)));
+        end_s_ = std::max(end_s_, std::min(t + cfg_.post_s, cur_.trigger_s + cfg_.max_record_s));
+        return;
+    }
+
+    capturing_ = true;
+    end_s_     = t + cfg_.post_s;
+    cur_.device_id = device_id_;
+    cur_.trigger_s = t;
+    cur_.reason    = reason;
+    cur_.triggers_us.assign(1, 0);
+    cur_.frames.clear();
+
+    // Freeze the pre-trigger window (and whatever already followed the trigger)
+    const size_t cap = ring_.size();
+    const double from = t - cfg_.pre_s;
+    for (size_t i = 0; i < ring_count_; ++i) {
+        const RingFrame& f = ring_[(ring_head_ + cap - ring_count_ + i) % cap];
+        if (f.t >= from) append(f);
+    }
+}
+
+bool ImuBurstCapture::push(const ImuRawFrame& raw, const ImuSample& s, ImuBurstRecord& out) {
+    if (ring_.empty()) return false;
+
+    RingFrame f;
+    f.t    = raw.t;
+    f.kind = raw.cmd;
+    std::copy(raw.v, raw.v + 3, f.v);
+    const bool accel = raw.cmd == 0x08;
+
+    ring_[ring_head_] = f;
+    ring_head_ = (ring_head_ + 1) % ring_.size();
+    if (ring_count_ < ring_.size()) ++ring_count_;
+
+    // Level trigger
+    if (!capturing_ && (cfg_.trigger_g > 0.0 || cfg_.trigger_dps > 0.0)) {
+        bool fire;
+        if (accel) {
+            double mag = std::sqrt(double(s.ax) * s.ax + double(s.ay) * s.ay + double(s.az) * s.az);
+            fire = cfg_.trigger_g > 0.0 && std::fabs(mag - 1.0) > cfg_.trigger_g;
+        } else {
+            double mag = std::sqrt(double(s.gx) * s.gx + double(s.gy) * s.gy + double(s.gz) * s.gz);
+            fire = cfg_.trigger_dps > 0.0 && mag > cfg_.trigger_dps;
+        }
+        if (fire) {
+            trigger(f.t, ImuBurstReason::Threshold);
+            return false;   // this frame was copied from the ring
+        }
+    }
+
+    if (!capturing_) return false;
+    append(f);
+    if (f.t < end_s_) return false;
+
+    capturing_ = false;
+    out = std::move(cur_);
+    cur_ = ImuBurstRecord{};
+    cur_.frames.reserve(out.frames.capacity());
+    return true;
+}
+
+void ImuBurstCapture::append(const RingFrame& f) {
+    ImuBurstFrame b;
+    b.t_us = static_cast<int32_t>(std::llround((f.t - cur_.trigger_s) * 1e6));
+    std::copy(f.v, f.v + 3, b.v);
+    b.kind = f.kind;
+    cur_.frames.push_back(b);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "imu_frame.h"
+#include "imu_types.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class ImuBurstReason : uint8_t {
+    Shot      = 1,
+    Threshold = 2
+};
+
+// One frame as the device sent it: 12 bytes instead of sizeof(ImuSample)
+struct ImuBurstFrame {
+    int32_t t_us;    // relative to the record's trigger_s
+    int16_t v[3];    // raw counts
+    uint8_t kind;    // 0x08 accel / 0x0A gyro
+};
+
+// Frozen window around one trigger (plus any retriggers inside it)
+struct ImuBurstRecord {
+    std::string                device_id;
+    double                     trigger_s = 0.0;   // host time of the first trigger
+    ImuBurstReason             reason    = ImuBurstReason::Shot;
+    std::vector<int32_t>       triggers_us;       // every trigger, relative to trigger_s
+    std::vector<ImuBurstFrame> frames;
+};
+
+// Oscilloscope-style capture for one device.
+//
+// Every frame goes into a pre-trigger ring sized for pre_s (+ the latency
+// of a late trigger such as a shot, which is reported after it started).
+// trigger() or the optional level trigger freezes the ring from
+// trigger - pre_s and keeps recording until post_s after the last trigger,
+// bounded by max_record_s. The completed record is handed out by push().
+// Not thread safe; fed from one notification thread.
+class ImuBurstCapture {
+public:
+    void configure(const std::string& device_id, const ImuBurstConfig& cfg,
+                   double trigger_latency_s);
+    void reset();
+
+    // Trigger at host time t (may lie in the past, within the ring)
+    void trigger(double t, ImuBurstReason reason);
+
+    // Feed every frame: raw as the device sent it (what is recorded, so
+    // calibration never touches a record) and s, its decoded sample (level
+    // trigger). True when a record completed into `out`.
+    bool push(const ImuRawFrame& raw, const ImuSample& s, ImuBurstRecord& out);
+
+    bool capturing() const { return capturing_; }
+
+private:
+    struct RingFrame {
+        double  t;
+        int16_t v[3];
+        uint8_t kind;
+    };
+
+    std::string    device_id_;
+    ImuBurstConfig cfg_;
+
+    std::vector<RingFrame> ring_;
+    size_t ring_head_  = 0;
+    size_t ring_count_ = 0;
+
+    bool           capturing_ = false;
+    double         end_s_     = 0.0;
+    ImuBurstRecord cur_;
+
+    void append(const RingFrame& f);
+};
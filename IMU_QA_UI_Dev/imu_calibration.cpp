@@ -0,0 +1,121 @@
+#include "imu_calibration.h"
+#include "imu_adv_registry.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+bool ImuSensorCal::is_identity() const {
+    static const ImuSensorCal nominal;
+    return std::equal(m, m + 9, nominal.m) && std::equal(bias, bias + 3, nominal.bias);
+}
+
+static void fold(const ImuSensorCal& s, double counts_per_unit, float k[9], float c[3]) {
+    for (int r = 0; r < 3; ++r) {
+        double off = 0.0;
+        for (int j = 0; j < 3; ++j) {
+            k[r * 3 + j] = float(double(s.m[r * 3 + j]) / counts_per_unit);
+            off -= double(s.m[r * 3 + j]) * double(s.bias[j]);
+        }
+        c[r] = float(off);
+    }
+}
+
+ImuCalKernel::ImuCalKernel() : ImuCalKernel(ImuDeviceCal{}) {}
+
+ImuCalKernel::ImuCalKernel(const ImuDeviceCal& cal) {
+    fold(cal.gyro, kGyroCountsPerDps, k[0], c[0]);
+    fold(cal.accel, kAccelCountsPerG, k[1], c[1]);
+}
+
+void imu_calibrate_frames(const ImuCalKernel& kernel, size_t n, const uint8_t* accel,
+                          const int16_t* x, const int16_t* y, const int16_t* z,
+                          float* ox, float* oy, float* oz) {
+    // Coefficients in locals: the compiler cannot otherwise rule out that
+    // the outputs alias the kernel
+    float kg[9], ka[9], cg[3], ca[3];
+    std::copy(kernel.k[0], kernel.k[0] + 9, kg);
+    std::copy(kernel.k[1], kernel.k[1] + 9, ka);
+    std::copy(kernel.c[0], kernel.c[0] + 3, cg);
+    std::copy(kernel.c[1], kernel.c[1] + 3, ca);
+
+    for (size_t i = 0; i < n; ++i) {
+        const bool  a  = accel[i] != 0;
+        const float vx = x[i], vy = y[i], vz = z[i];
+        ox[i] = (a ? ka[0] : kg[0]) * vx + (a ? ka[1] : kg[1]) * vy + (a ? ka[2] : kg[2]) * vz + (a ? ca[0] : cg[0]);
+        oy[i] = (a ? ka[3] : kg[3]) * vx + (a ? ka[4] : kg[4]) * vy + (a ? ka[5] : kg[5]) * vz + (a ? ca[1] : cg[1]);
+        oz[i] = (a ? ka[6] : kg[6]) * vx + (a ? ka[7] : kg[7]) * vy + (a ? ka[8] : kg[8]) * vz + (a ? ca[2] : cg[2]);
+    }
+}
+
+bool ImuCalibrationStore::load(const std::string& path) {
+    rows_.clear();
+    std::ifstream f(path);
+    if (!f) return false;
+
+    std::string line;
+    int line_no = 0, skipped = 0;
+    while (std::getline(f, line)) {
+        ++line_no;
+        if (line.empty() || line[0] == '#' || line.compare(0, 4, "mac,") == 0) continue;
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream in(line);
+        std::string mac_text, sensor;
+        ImuSensorCal s;
+        in >> mac_text >> sensor;
+        for (float& v : s.m) in >> v;
+        for (float& v : s.bias) in >> v;
+        const uint64_t mac = imu_pack_mac(mac_text);
+        if (!in || mac == kInvalidMac || (sensor != "accel" && sensor != "gyro")) {
+            std::cerr << "[cal] " << path << ":" << line_no << ": malformed row skipped\n";
+            ++skipped;
+            continue;
+        }
+        auto it = std::lower_bound(rows_.begin(), rows_.end(), mac,
+                                   [](const Row& r, uint64_t m) { return r.mac < m; });
+        if (it == rows_.end() || it->mac != mac) it = rows_.insert(it, Row{mac, ImuDeviceCal{}});
+        (sensor == "accel" ? it->cal.accel : it->cal.gyro) = s;
+    }
+    std::cout << "[cal] " << rows_.size() << " unit(s) calibrated from " << path;
+    if (skipped) std::cout << " (" << skipped << " rows skipped)";
+    std::cout << "\n";
+    return true;
+}
+
+bool ImuCalibrationStore::save(const std::string& path) const {
+    // Write aside and rename, so a crash never leaves half a table
+    const std::string tmp = path + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "mac,sensor,m00,m01,m02,m10,m11,m12,m20,m21,m22,b0,b1,b2\n");
+    for (const auto& r : rows_) {
+        for (int k = 0; k < 2; ++k) {
+            const ImuSensorCal& s = k ? r.cal.gyro : r.cal.accel;
+            if (s.is_identity()) continue;
+            std::fprintf(f, "%s,%s", imu_format_mac(r.mac).c_str(), k ? "gyro" : "accel");
+            for (float v : s.m) std::fprintf(f, ",%.9g", v);
+            for (float v : s.bias) std::fprintf(f, ",%.9g", v);
+            std::fprintf(f, "\n");
+        }
+    }
+    if (std::fclose(f) != 0) return false;
+    std::remove(path.c_str());   // Windows rename does not replace
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+const ImuDeviceCal* ImuCalibrationStore::find(const std::string& mac) const {
+    const uint64_t key = imu_pack_mac(mac);
+    auto it = std::lower_bound(rows_.begin(), rows_.end(), key,
+                               [](const Row& r, uint64_t m) { return r.mac < m; });
+    return it != rows_.end() && it->mac == key ? &it->cal : nullptr;
+}
+
+void ImuCalibrationStore::set(const std::string& mac, const ImuDeviceCal& cal) {
+    const uint64_t key = imu_pack_mac(mac);
+    if (key == kInvalidMac) return;
+    auto it = std::lower_bound(rows_.begin(), rows_.end(), key,
+                               [](const Row& r, uint64_t m) { return r.mac < m; });
+    if (it != rows_.end() && it->mac == key) it->cal = cal;
+    else rows_.insert(it, Row{key, cal});
+}
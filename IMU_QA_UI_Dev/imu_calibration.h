@@ -0,0 +1,74 @@
+#pragma once
+#include "imu_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One sensor of one unit: calibrated = m * (nominal - bias), nominal being
+// the counts at the datasheet scale (g or dps), m row-major. Covers
+// per-axis scale, cross-axis misalignment and offset / zero-rate bias.
+struct ImuSensorCal {
+    float m[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    float bias[3] = {0, 0, 0};
+
+    bool is_identity() const;
+};
+
+struct ImuDeviceCal {
+    ImuSensorCal accel;
+    ImuSensorCal gyro;
+};
+
+// Both sensors folded to counts -> units: out = k * counts + c. Accel and
+// gyro coefficients sit side by side so a batch of interleaved frames
+// selects per lane instead of branching.
+struct ImuCalKernel {
+    float k[2][9];   // [0] gyro, [1] accel
+    float c[2][3];
+
+    ImuCalKernel();   // nominal scale
+    explicit ImuCalKernel(const ImuDeviceCal& cal);
+
+    // One frame, for callers that decode as frames arrive
+    void apply(bool accel, int16_t x, int16_t y, int16_t z, float out[3]) const {
+        const float* m = k[accel];
+        const float* o = c[accel];
+        for (int r = 0; r < 3; ++r) out[r] = m[r * 3] * x + m[r * 3 + 1] * y + m[r * 3 + 2] * z + o[r];
+    }
+};
+
+// Frames of one unit in columns, in and out. accel[i] is 1 for an accel
+// frame, 0 for gyro. Straight-line per lane, so the compiler vectorises it.
+void imu_calibrate_frames(const ImuCalKernel& kernel, size_t n, const uint8_t* accel,
+                          const int16_t* x, const int16_t* y, const int16_t* z,
+                          float* ox, float* oy, float* oz);
+
+// Calibrations by unit, read once at startup. Rows are kept sorted by
+// packed MAC in one contiguous array; a session looks its unit up once
+// and keeps a copy of the folded kernel.
+//
+// File: CSV, '#' comments, one row per unit and sensor (a missing sensor
+// stays nominal):
+//   mac,sensor,m00,m01,m02,m10,m11,m12,m20,m21,m22,b0,b1,b2
+//   c6:22:d5:9e:0c:53,accel,1.002,0,0,0,0.998,0,0,0,1.001,0.004,-0.002,0.011
+class ImuCalibrationStore {
+public:
+    // Replaces the contents; false when the file cannot be read (a missing
+    // file leaves the store empty). Malformed rows are skipped and logged.
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    // nullptr when the unit has no calibration
+    const ImuDeviceCal* find(const std::string& mac) const;
+    void set(const std::string& mac, const ImuDeviceCal& cal);
+
+    size_t size() const { return rows_.size(); }
+
+private:
+    struct Row {
+        uint64_t     mac;
+        ImuDeviceCal cal;
+    };
+    std::vector<Row> rows_;   // sorted by mac
+};
@@ -0,0 +1,131 @@
+#include "imu_capture_file.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+
+constexpr uint8_t kVersion    = 2;
+constexpr size_t  kFlushBytes = 64u << 10;
+
+} // namespace
+
+ImuCaptureWriter::ImuCaptureWriter(const std::string& directory,
+                                   const std::string& device_id,
+                                   double roll_seconds)
+    : directory_(directory), device_id_(device_id), roll_seconds_(roll_seconds) {
+    out_.reserve(2 * kFlushBytes);
+    pending_.reserve(ImuBlockEncoder::kBlockFrames);
+}
+
+ImuCaptureWriter::~ImuCaptureWriter() {
+    close();
+}
+
+void ImuCaptureWriter::write(const ImuSample* samples, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const ImuSample& s = samples[i];
+        if (!fp_ || (roll_seconds_ > 0.0 && s.timestamp_s - file_start_s_ >= roll_seconds_)) {
+            if (!open_next(s.timestamp_s)) return;
+        }
+        pending_.push(s);
+        ++samples_;
+        if (pending_.size() == ImuBlockEncoder::kBlockFrames) {
+            encode_pending();
+            if (out_.size() >= kFlushBytes) flush();
+        }
+    }
+}
+
+void ImuCaptureWriter::close() {
+    if (!fp_) return;
+    encode_pending();
+    flush();
+    std::fclose(fp_);
+    fp_ = nullptr;
+}
+
+bool ImuCaptureWriter::open_next(double t_s) {
+    close();
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+
+    std::string name = device_id_;
+    std::replace(name.begin(), name.end(), ':', '-');
+    std::time_t now = std::time(nullptr);
+    std::tm tm{};
+#ifdef _WIN32
+    localtime_s(&tm, &now);
+#else
+    localtime_r(&now, &tm);
+#endif
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &tm);
+    auto path = std::filesystem::path(directory_) /
+                (name + "_" + stamp + "_" + std::to_string(files_ + 1) + ".imuc");
+
+    fp_ = std::fopen(path.string().c_str(), "wb");
+    if (!fp_) {
+        std::cerr << "[capture] Cannot open " << path.string() << "\n";
+        return false;
+    }
+    ++files_;
+    file_start_s_ = t_s;
+
+    // Header goes straight to the file; out_ only ever holds blocks
+    const int64_t base_us = static_cast<int64_t>(std::llround(t_s * 1e6));
+    const size_t id_len = std::min<size_t>(device_id_.size(), 255);
+    uint8_t head[6 + 255 + 8];
+    size_t  n = 0;
+    head[n++] = 'I'; head[n++] = 'M'; head[n++] = 'U'; head[n++] = 'C';
+    head[n++] = kVersion;
+    head[n++] = static_cast<uint8_t>(id_len);
+    std::copy(device_id_.begin(), device_id_.begin() + id_len, head + n);
+    n += id_len;
+    for (int i = 0; i < 8; ++i) head[n++] = static_cast<uint8_t>(uint64_t(base_us) >> (8 * i));
+    file_bytes_ += std::fwrite(head, 1, n, fp_);
+    out_.clear();
+    return true;
+}
+
+void ImuCaptureWriter::encode_pending() {
+    if (pending_.empty()) return;
+    encoder_.encode(pending_, 0, pending_.size(), out_);
+    pending_.clear();
+}
+
+void ImuCaptureWriter::flush() {
+    if (!fp_ || out_.empty()) return;
+    file_bytes_ += std::fwrite(out_.data(), 1, out_.size(), fp_);
+    out_.clear();
+}
+
+bool imu_read_capture(const std::string& path, std::string& device_id, std::vector<ImuSample>& out) {
+    std::FILE* fp = std::fopen(path.c_str(), "rb");
+    if (!fp) return false;
+    std::vector<uint8_t> data;
+    uint8_t buf[64u << 10];
+    size_t  n;
+    while ((n = std::fread(buf, 1, sizeof(buf), fp)) > 0) data.insert(data.end(), buf, buf + n);
+    std::fclose(fp);
+
+    if (data.size() < 6 || std::memcmp(data.data(), "IMUC", 4) != 0 || data[4] != kVersion) return false;
+    const size_t id_len = data[5];
+    size_t at = 6 + id_len + 8;
+    if (data.size() < at) return false;
+    device_id.assign(reinterpret_cast<const char*>(data.data() + 6), id_len);
+
+    ImuBlockDecoder decoder;
+    ImuFrameColumns frames;
+    while (at < data.size()) {
+        const size_t used = decoder.decode(data.data() + at, data.size() - at, frames);
+        if (used == 0) break;
+        at += used;
+    }
+    frames.append_to(out);
+    return at == data.size();
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "imu_block_codec.h"
+#include "imu_types.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Rolling compressed raw capture for one device.
+//
+// Samples are stored as the int16 counts the device sent (recovered from the
+// scaled floats) in ImuBlockEncoder blocks of up to kBlockFrames frames. A
+// new file is started every roll_seconds; each file, and each block in it,
+// decodes on its own.
+//
+// File layout:
+//   "IMUC" u8 version (2) u8 id_len id[id_len] i64 base_time_us
+//   blocks, see imu_block_codec.h
+class ImuCaptureWriter {
+public:
+    ImuCaptureWriter(const std::string& directory, const std::string& device_id,
+                     double roll_seconds);
+    ~ImuCaptureWriter();
+
+    ImuCaptureWriter(const ImuCaptureWriter&) = delete;
+    ImuCaptureWriter& operator=(const ImuCaptureWriter&) = delete;
+
+    void write(const ImuSample* samples, size_t count);
+    void close();
+
+    uint64_t samples_written() const { return samples_; }
+    uint64_t bytes_written() const   { return file_bytes_; }
+    int      files_written() const   { return files_; }
+
+private:
+    std::string directory_;
+    std::string device_id_;
+    double      roll_seconds_;
+
+    std::FILE*           fp_ = nullptr;
+    double               file_start_s_ = 0.0;
+    std::vector<uint8_t> out_;       // encoded blocks not yet written
+    ImuFrameColumns      pending_;   // frames of the next block
+    ImuBlockEncoder      encoder_;
+
+    uint64_t samples_    = 0;
+    uint64_t file_bytes_ = 0;
+    int      files_      = 0;
+
+    bool open_next(double t_s);
+    void encode_pending();
+    void flush();
+};
+
+// Reads a whole capture file back into samples (appended to out).
+// Returns false if the file cannot be read or a block is damaged; the
+// samples of the blocks before the damage are kept.
+bool imu_read_capture(const std::string& path, std::string& device_id, std::vector<ImuSample>& out);
@@ -1,48 +1,73 @@
 #include "imu_device_session.h"
+#include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <iterator>
+#include <thread>
 
-static int16_t be16(const uint8_t* p) {
-    return static_cast<int16_t>((p[0] << 8) | p[1]);
+// Host time base shared by sample timestamps, gaps and the watchdog
+static double now_s() {
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
-ImuDeviceSession::ImuDeviceSession(SimpleBLE::Peripheral peripheral,
+ImuDeviceSession::ImuDeviceSession(std::unique_ptr<ImuLink> link,
                                    const std::string& id)
-    : peripheral_(std::move(peripheral)), id_(id) {}
+    : link_(std::move(link)), id_(id) {}
 
 ImuDeviceSession::~ImuDeviceSession() {
     stop();
 }
 
 bool ImuDeviceSession::start() {
+    {
+        std::lock_guard<std::mutex> lock(link_mutex_);
+        if (!connect_link()) return false;
+        firmware_ = link_->firmware();
+        armed_ = true;
+        if (!enable_sensors()) {
+            armed_ = false;
+            return false;
+        }
+    }
+
+    last_rx_s_ = now_s();
+    running_ = true;
+    start_watchdog();
+    std::cout << "[" << id_ << "] Session started successfully\n";
+    return true;
+}
+
+bool ImuDeviceSession::connect_link() {
     try {
-        peripheral_.connect();
-    } catch (const SimpleBLE::Exception::OperationFailed& e) {
+        link_->connect();
+    } catch (const std::exception& e) {
         std::cerr << "[" << id_ << "] Connect failed: " << e.what() << "\n";
         return false;
     }
-    if (!peripheral_.is_connected()) {
+    if (!link_->is_connected()) {
         std::cerr << "[" << id_ << "] Not connected after connect().\n";
         return false;
     }
 
-    // 🔥 FIX: Callback ko STRONG CAPTURE karo with shared_ptr
-    // Device ID ko capture karo taake pata rahe kis device ka data hai
-    auto self_id = id_;
-    auto cb = [this, self_id](SimpleBLE::ByteArray bytes) {
-        // std::cout << "[" << self_id << "] Received " << bytes.size() << " bytes\n";
-        this->on_notify(bytes);
+    auto cb = [this](const uint8_t* data, size_t size) {
+        this->on_notify(data, size);
     };
 
     try {
-        peripheral_.notify("0000b3a0-0000-1000-8000-00805f9b34fb",
-                           "0000b3a1-0000-1000-8000-00805f9b34fb",
-                           cb);
+        link_->subscribe(cb);
     } catch (const std::exception& e) {
         std::cerr << "[" << id_ << "] Notify setup failed: " << e.what() << "\n";
         return false;
     }
 
+    link_->set_on_disconnected([this]() { link_lost_ = true; });
+    link_lost_ = false;
+    return true;
+}
+
+// Callers set armed_ first so frames arriving right after 0x08 are kept
+bool ImuDeviceSession::enable_sensors() {
     // enable accel + gyro
     try {
         send_cmd(0x08, 0x00, {});
@@ -53,35 +78,225 @@ bool ImuDeviceSession::start() {
         std::cerr << "[" << id_ << "] Failed to enable sensors: " << e.what() << "\n";
         return false;
     }
+    return true;
+}
 
-    running_ = true;
-    std::cout << "[" << id_ << "] Session started successfully\n";
+bool ImuDeviceSession::is_connected() {
+    std::lock_guard<std::mutex> lock(link_mutex_);
+    try {
+        return link_->is_connected();
+    } catch (...) {
+        return false;
+    }
+}
+
+bool ImuDeviceSession::rearm(bool reset) {
+    if (!running_ || !is_connected()) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(link_mutex_);
+        if (reset) {
+            try {
+                send_cmd(0xF0, 0x00, {});
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            } catch (const std::exception& e) {
+                std::cerr << "[" << id_ << "] Reset failed: " << e.what() << "\n";
+                return false;
+            }
+        }
+
+        armed_ = true;
+        if (!enable_sensors()) {
+            armed_ = false;
+            return false;
+        }
+    }
+
+    // New run: forget outages from the previous one
+    last_rx_s_ = now_s();
+    {
+        std::lock_guard<std::mutex> lock(gaps_mutex_);
+        gaps_.clear();
+        gap_open_ = false;
+        reconnects_ = 0;
+    }
+
+    // Drop anything received while idle so the next run starts clean
+    if (raw_) {
+        ImuRawFrame f;
+        while (raw_->try_pop(f)) {}
+    }
+    raw_dropped_ = 0;
+    buffer_.clear();
+    buffer_.reset_stats();
+    detector_reset_ = true;
+    {
+        std::lock_guard<std::mutex> lock(shots_mutex_);
+        shots_.clear();
+        shot_metrics_.clear();
+        bursts_.clear();
+        bursts_dropped_ = 0;
+    }
     return true;
 }
 
+void ImuDeviceSession::disarm() {
+    if (!armed_) return;
+    armed_ = false;
+    std::lock_guard<std::mutex> lock(link_mutex_);
+    try {
+        send_cmd(0xF0, 0x00, {});
+    } catch (...) {}
+}
+
+bool ImuDeviceSession::reconnect() {
+    std::cout << "[" << id_ << "] Reconnecting...\n";
+    stop();
+    return start();
+}
+
 void ImuDeviceSession::stop() {
     if (!running_) return;
     running_ = false;
+    armed_ = false;
 
     std::cout << "[" << id_ << "] Stopping session...\n";
+    stop_watchdog();
 
+    std::lock_guard<std::mutex> lock(link_mutex_);
     try {
         // stop all sensors
         send_cmd(0xF0, 0x00, {});
     } catch (...) {}
 
     try {
-        peripheral_.unsubscribe("0000b3a0-0000-1000-8000-00805f9b34fb",
-                                "0000b3a1-0000-1000-8000-00805f9b34fb");
+        link_->unsubscribe();
     } catch (...) {}
 
-    if (peripheral_.is_connected()) {
-        try { peripheral_.disconnect(); } catch (...) {}
-    }
+    try {
+        if (link_->is_connected()) link_->disconnect();
+    } catch (...) {}
 
     std::cout << "[" << id_ << "] Session stopped\n";
 }
 
+void ImuDeviceSession::set_buffer_limits(const ImuBufferConfig& cfg,
+                                         ImuMemoryBudget* station) {
+    buffer_.configure(cfg.session_queue_bytes, cfg, station, id_ + "_queue");
+}
+
+void ImuDeviceSession::set_watchdog(double stall_timeout_s, bool auto_reconnect) {
+    stall_timeout_s_ = stall_timeout_s;
+    auto_reconnect_  = auto_reconnect;
+}
+
+void ImuDeviceSession::start_watchdog() {
+    if (stall_timeout_s_ <= 0.0 || watchdog_.joinable()) return;
+    watchdog_stop_ = false;
+    watchdog_ = std::thread(&ImuDeviceSession::watchdog_loop, this);
+}
+
+void ImuDeviceSession::stop_watchdog() {
+    {
+        std::lock_guard<std::mutex> lock(watchdog_mutex_);
+        watchdog_stop_ = true;
+    }
+    watchdog_cv_.notify_all();
+    if (watchdog_.joinable()) watchdog_.join();
+}
+
+void ImuDeviceSession::watchdog_loop() {
+    int    attempt  = 0;
+    double next_try = 0.0;
+
+    std::unique_lock<std::mutex> lock(watchdog_mutex_);
+    while (!watchdog_stop_) {
+        watchdog_cv_.wait_for(lock, std::chrono::milliseconds(100),
+                              [this] { return watchdog_stop_; });
+        if (watchdog_stop_) break;
+
+        // Only a streaming session is expected to deliver frames
+        if (!armed_) {
+            if (gap_open_) close_gap(now_s());
+            attempt = 0;
+            continue;
+        }
+
+        const double now  = now_s();
+        const double last = last_rx_s_;
+        const bool   lost = link_lost_;
+        if (!lost && now - last < stall_timeout_s_) {
+            if (!gap_open_) attempt = 0;
+            continue;
+        }
+
+        if (!gap_open_) {
+            std::lock_guard<std::mutex> g(gaps_mutex_);
+            gaps_.push_back({last, now, true});
+            gap_open_ = true;
+            std::cerr << "[" << id_ << "] ⚠️  " << (lost ? "Link lost" : "Stream stalled")
+                      << " (" << (now - last) << "s without data)\n";
+        }
+
+        if (!auto_reconnect_ || now < next_try) continue;
+
+        // First try just re-enabling the sensors; escalate to a full
+        // reconnect if the link is down or that did not help.
+        lock.unlock();
+        bool ok = restore_link(lost || attempt > 0);
+        lock.lock();
+
+        ++attempt;
+        next_try = now_s() + std::min(0.5 * (1 << std::min(attempt, 4)), 5.0);
+        if (!ok) {
+            std::cerr << "[" << id_ << "] Recovery attempt " << attempt << " failed\n";
+        }
+    }
+}
+
+bool ImuDeviceSession::restore_link(bool full) {
+    std::lock_guard<std::mutex> lock(link_mutex_);
+    if (!armed_) return false;   // disarmed while we were waiting
+    {
+        std::lock_guard<std::mutex> g(gaps_mutex_);
+        ++reconnects_;
+    }
+
+    try {
+        if (full || !link_->is_connected()) {
+            std::cout << "[" << id_ << "] Reconnecting in background...\n";
+            if (link_->is_connected()) link_->disconnect();
+            if (!connect_link()) return false;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[" << id_ << "] Reconnect failed: " << e.what() << "\n";
+        return false;
+    }
+    return enable_sensors();
+}
+
+std::vector<ImuGap> ImuDeviceSession::gaps() const {
+    std::lock_guard<std::mutex> lock(gaps_mutex_);
+    std::vector<ImuGap> out = gaps_;
+    if (!out.empty() && out.back().open) out.back().end_s = now_s();
+    return out;
+}
+
+int ImuDeviceSession::reconnect_count() const {
+    std::lock_guard<std::mutex> lock(gaps_mutex_);
+    return reconnects_;
+}
+
+void ImuDeviceSession::close_gap(double t) {
+    std::lock_guard<std::mutex> lock(gaps_mutex_);
+    if (!gap_open_ || gaps_.empty()) return;
+    gaps_.back().end_s = t;
+    gaps_.back().open  = false;
+    gap_open_ = false;
+    std::cout << "[" << id_ << "] Gap closed (" << (t - gaps_.back().start_s)
+              << "s without data)\n";
+}
+
 void ImuDeviceSession::send_cmd(uint8_t cmd, uint8_t len,
                                 const std::vector<uint8_t>& payload) {
     std::vector<uint8_t> buf;
@@ -92,62 +307,194 @@ void ImuDeviceSession::send_cmd(uint8_t cmd, uint8_t len,
     buf.push_back(len);
     buf.insert(buf.end(), payload.begin(), payload.end());
 
-    peripheral_.write_request("0000b3a0-0000-1000-8000-00805f9b34fb",
-                              "0000b3a2-0000-1000-8000-00805f9b34fb",
-                              buf);
+    link_->write(buf);
 }
 
-void ImuDeviceSession::on_notify(SimpleBLE::ByteArray bytes) {
-    if (bytes.size() < 10) return;
-    const uint8_t* d = reinterpret_cast<const uint8_t*>(bytes.data());
-    if (d[0] != 0x55 || d[1] != 0xAA) return;
+void ImuDeviceSession::on_notify(const uint8_t* data, size_t size) {
+    if (!armed_) return;   // in-flight frames after 0xF0
+    uint8_t cmd;
+    int16_t v[3];
+    if (!imu_parse_frame(data, size, cmd, v)) return;
 
-    uint8_t cmd = d[2];
-    uint8_t len = d[3];
-    if (len != 0x06) return;
+    double t = now_s();
+    last_rx_s_.store(t, std::memory_order_relaxed);
+    if (gap_open_.load(std::memory_order_relaxed)) close_gap(t);
 
-    const uint8_t* p = d + 4;
-    int16_t rx = be16(p);
-    int16_t ry = be16(p + 2);
-    int16_t rz = be16(p + 4);
-
-    double t = std::chrono::duration<double>(
-        std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (!imu_is_sample_cmd(cmd)) return;
+    if (raw_) {
+        if (!raw_->try_push(ImuRawFrame{t, cmd, {v[0], v[1], v[2]}})) {
+            raw_dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+    process_frame(t, cmd, v[0], v[1], v[2]);
+}
 
+// Calibrated axes into the accel or gyro half of a sample
+static ImuSample calibrated_sample(double t, bool accel, float x, float y, float z) {
     ImuSample s{};
     s.timestamp_s = t;
-    s.temp = 0.0f;
-
-    if (cmd == 0x08) { // accel
-        s.ax = 16.0f * rx / 32768.0f;
-        s.ay = 16.0f * ry / 32768.0f;
-        s.az = 16.0f * rz / 32768.0f;
-        
-        // // Debug print for accel data
-        // std::cout << "[" << id_ << "] ACCEL: ax=" << s.ax 
-        //           << " ay=" << s.ay << " az=" << s.az << "\n";
-    } else if (cmd == 0x0A) { // gyro
-        s.gx = 500.0f * rx / 28571.0f;
-        s.gy = 500.0f * ry / 28571.0f;
-        s.gz = 500.0f * rz / 28571.0f;
-        
-        // // Debug print for gyro data
-        // std::cout << "[" << id_ << "] GYRO: gx=" << s.gx 
-        //           << " gy=" << s.gy << " gz=" << s.gz << "\n";
+    if (accel) {
+        s.ax = x; s.ay = y; s.az = z;
     } else {
+        s.gx = x; s.gy = y; s.gz = z;
+    }
+    return s;
+}
+
+size_t ImuDeviceSession::decode_pending() {
+    if (!raw_) return 0;
+    if (!calibrated_) {
+        size_t n = 0;
+        ImuRawFrame f;
+        while (raw_->try_pop(f)) {
+            process_frame(f.t, f.cmd, f.v[0], f.v[1], f.v[2]);
+            ++n;
+        }
+        return n;
+    }
+
+    // Calibrated units go through the kernel a batch of columns at a time
+    size_t total = 0;
+    DecodeBatch& b = batch_;
+    for (;;) {
+        size_t n = 0;
+        ImuRawFrame f;
+        while (n < kDecodeBatch && raw_->try_pop(f)) {
+            b.t[n]     = f.t;
+            b.accel[n] = f.cmd == 0x08;
+            b.x[n] = f.v[0];
+            b.y[n] = f.v[1];
+            b.z[n] = f.v[2];
+            ++n;
+        }
+        imu_calibrate_frames(cal_, n, b.accel, b.x, b.y, b.z, b.ox, b.oy, b.oz);
+        for (size_t i = 0; i < n; ++i) {
+            const ImuRawFrame raw{b.t[i], uint8_t(b.accel[i] ? 0x08 : 0x0A), {b.x[i], b.y[i], b.z[i]}};
+            process_sample(calibrated_sample(b.t[i], b.accel[i], b.ox[i], b.oy[i], b.oz[i]), raw);
+        }
+        total += n;
+        if (n < kDecodeBatch) return total;
+    }
+}
+
+void ImuDeviceSession::set_calibration(const ImuDeviceCal* cal) {
+    calibrated_ = cal != nullptr;
+    cal_src_ = cal ? *cal : ImuDeviceCal{};
+    cal_ = ImuCalKernel(cal_src_);
+}
+
+void ImuDeviceSession::set_decode_queue(size_t frames) {
+    raw_ = frames > 0 ? std::make_unique<ImuLockFreeQueue<ImuRawFrame>>(frames) : nullptr;
+}
+
+ImuOverflowStats ImuDeviceSession::buffer_stats() const {
+    ImuOverflowStats st = buffer_.stats();
+    st.dropped += raw_dropped_.load(std::memory_order_relaxed);
+    return st;
+}
+
+void ImuDeviceSession::process_frame(double t, uint8_t cmd, int16_t rx, int16_t ry, int16_t rz) {
+    ImuSample s;
+    if (calibrated_) {
+        if (!imu_is_sample_cmd(cmd)) return;
+        const bool accel = cmd == 0x08;
+        float o[3];
+        cal_.apply(accel, rx, ry, rz, o);
+        s = calibrated_sample(t, accel, o[0], o[1], o[2]);
+    } else if (!imu_decode_frame(t, cmd, rx, ry, rz, s)) {
         return;
     }
+    process_sample(s, ImuRawFrame{t, cmd, {rx, ry, rz}});
+}
 
-    {
-        std::lock_guard<std::mutex> lock(buffer_mutex_);
-        buffer_.push_back(s);
+void ImuDeviceSession::process_sample(const ImuSample& s, const ImuRawFrame& raw) {
+    const double t = s.timestamp_s;
+    if (detector_reset_.exchange(false, std::memory_order_relaxed)) {
+        detector_.reset();
+        motion_.reset();
+        analyzer_.reset();
+        burst_.reset();
+    }
+    if (detect_shots_) {
+        ImuShotEvent shot;
+        if (detector_.push(s, shot)) {
+            if (events_) events_->publish_shot(id_, shot);
+            if (analyze_recoil_) analyzer_.add_shot(shot);
+            if (capture_bursts_) burst_.trigger(shot.timestamp_s, ImuBurstReason::Shot);
+            std::lock_guard<std::mutex> lock(shots_mutex_);
+            shots_.push_back(shot);
+        }
+        if (analyze_recoil_) {
+            ImuShotMetrics done[ImuRecoilAnalyzer::kMaxPending];
+            int n = analyzer_.push(s, done);
+            for (int k = 0; k < n; ++k) {
+                if (events_) events_->publish_metrics(id_, done[k]);
+                std::lock_guard<std::mutex> lock(shots_mutex_);
+                shot_metrics_.push_back(done[k]);
+            }
+        }
+    }
+    if (capture_bursts_) {
+        ImuBurstRecord rec;
+        if (burst_.push(raw, s, rec)) {
+            std::lock_guard<std::mutex> lock(shots_mutex_);
+            bursts_.push_back(std::move(rec));
+            if (bursts_.size() > max_bursts_) {
+                bursts_.pop_front();
+                ++bursts_dropped_;
+            }
+        }
     }
+    if (events_) {
+        float rate = 0.0f;
+        int change = motion_.push(s, rate);
+        if (change != 0) events_->publish_motion(id_, change > 0, t, rate);
+    }
+
+    buffer_.push(s);
 }
 
 std::vector<ImuSample> ImuDeviceSession::drain_samples() {
-    std::vector<ImuSample> out;
-    std::lock_guard<std::mutex> lock(buffer_mutex_);
-    out.assign(buffer_.begin(), buffer_.end());
-    buffer_.clear();
+    return buffer_.drain();
+}
+
+void ImuDeviceSession::set_shot_detector(const ImuShotConfig& cfg, const ImuRecoilConfig& recoil) {
+    detect_shots_ = cfg.enabled;
+    detector_.configure(cfg);
+    analyze_recoil_ = cfg.enabled && recoil.enabled;
+    analyzer_.configure(recoil, cfg.max_duration_s + cfg.quiet_s);
+}
+
+void ImuDeviceSession::set_burst_capture(const ImuBurstConfig& cfg, double trigger_latency_s) {
+    capture_bursts_ = cfg.enabled;
+    max_bursts_     = std::max<size_t>(cfg.max_pending, 1);
+    burst_.configure(id_, cfg, trigger_latency_s);
+}
+
+std::vector<ImuBurstRecord> ImuDeviceSession::drain_bursts() {
+    std::lock_guard<std::mutex> lock(shots_mutex_);
+    std::vector<ImuBurstRecord> out(std::make_move_iterator(bursts_.begin()),
+                                    std::make_move_iterator(bursts_.end()));
+    bursts_.clear();
     return out;
-}
\ No newline at end of file
+}
+
+void ImuDeviceSession::set_event_bus(ImuEventBus* bus, const ImuEventConfig& cfg) {
+    events_ = bus;
+    motion_.configure(cfg.motion_dps, cfg.motion_hold_s);
+}
+
+std::vector<ImuShotEvent> ImuDeviceSession::drain_shots() {
+    std::lock_guard<std::mutex> lock(shots_mutex_);
+    std::vector<ImuShotEvent> out;
+    out.swap(shots_);
+    return out;
+}
+
+std::vector<ImuShotMetrics> ImuDeviceSession::drain_shot_metrics() {
+    std::lock_guard<std::mutex> lock(shots_mutex_);
+    std::vector<ImuShotMetrics> out;
+    out.swap(shot_metrics_);
+    return out;
+}
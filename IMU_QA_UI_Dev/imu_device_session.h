@@ -1,13 +1,24 @@
 #pragma once
 #include "imu_types.h"
-#include <simpleble/SimpleBLE.h>
+#include "imu_sample_buffer.h"
+#include "imu_burst_capture.h"
+#include "imu_calibration.h"
+#include "imu_event_bus.h"
+#include "imu_frame.h"
+#include "imu_link.h"
+#include "imu_lockfree_queue.h"
+#include "imu_recoil_analyzer.h"
+#include "imu_shot_detector.h"
 #include <atomic>
+#include <condition_variable>
 #include <mutex>
 #include <deque>
+#include <memory>
+#include <thread>
 
 class ImuDeviceSession {
 public:
-    ImuDeviceSession(SimpleBLE::Peripheral peripheral,
+    ImuDeviceSession(std::unique_ptr<ImuLink> link,
                      const std::string& id);
 
     ~ImuDeviceSession();
@@ -15,21 +26,144 @@ public:
     bool start();
     void stop();
 
+    // Keep the link up between test cycles: disarm() stops streaming (0xF0),
+    // rearm() re-enables accel + gyro (optionally after a 0xF0 reset) and
+    // discards anything buffered before it.
+    bool rearm(bool reset = false);
+    void disarm();
+
+    // Reconnect without rescanning, e.g. when the link dropped between runs
+    bool reconnect();
+
+    bool is_connected();
+    bool is_armed() const { return armed_; }
+
+    // Watchdog (call before start): if no frame arrives for stall_timeout_s
+    // while armed, or the link drops, the outage is recorded as a gap and the
+    // session re-enables / reconnects itself in the background.
+    void set_watchdog(double stall_timeout_s, bool auto_reconnect);
+
+    // Outages since the last rearm(); an ongoing one has open=true, end=now
+    std::vector<ImuGap> gaps() const;
+    int reconnect_count() const;
+
+    // Bound the callback -> drain queue (call before start); station is shared
+    void set_buffer_limits(const ImuBufferConfig& cfg, ImuMemoryBudget* station);
+    ImuOverflowStats buffer_stats() const;
+    size_t buffered() const { return buffer_.size(); }
+
+    // Recoil detection on every decoded frame, ahead of the sample queue so
+    // a full queue never delays it, plus per-shot analytics (call before start)
+    void set_shot_detector(const ImuShotConfig& cfg, const ImuRecoilConfig& recoil);
+    // Keep pre/post-trigger windows around shots and level triggers (call
+    // before start). trigger_latency_s: how late a shot is reported.
+    void set_burst_capture(const ImuBurstConfig& cfg, double trigger_latency_s);
+    // Completed records since the last call / rearm(); the oldest are
+    // dropped beyond cfg.max_pending
+    std::vector<ImuBurstRecord> drain_bursts();
+    uint64_t bursts_dropped() const { return bursts_dropped_; }
+
+    // Publish shots and motion start / stop as they are detected (not owned)
+    void set_event_bus(ImuEventBus* bus, const ImuEventConfig& cfg);
+    // Shots since the last call / rearm()
+    std::vector<ImuShotEvent> drain_shots();
+    // Analysed shots since the last call / rearm(); each arrives once its
+    // recovery window has been seen
+    std::vector<ImuShotMetrics> drain_shot_metrics();
+
+    // Defer decoding to another thread (call before start): the BLE
+    // callback only stamps and queues the raw frame, decode_pending() does
+    // the rest. A full queue drops the frame and counts it as dropped.
+    void set_decode_queue(size_t frames);
+    // Decode and process queued frames; returns how many (decode thread)
+    size_t decode_pending();
+
+    // Per-unit scale / misalignment / bias applied as frames are decoded
+    // (call before start); nullptr = nominal datasheet scale
+    void set_calibration(const ImuDeviceCal* cal);
+    bool is_calibrated() const { return calibrated_; }
+    const ImuDeviceCal& calibration() const { return cal_src_; }   // nominal when not calibrated
+
     std::string id() const { return id_; }
+    // Read from the unit at start(); empty if it does not report one
+    const std::string& firmware() const { return firmware_; }
 
     // Pull samples since last call (for QA processing)
     std::vector<ImuSample> drain_samples();
 
 private:
-    SimpleBLE::Peripheral peripheral_;
+    std::unique_ptr<ImuLink> link_;
     std::string id_;
 
     std::atomic<bool> running_{false};
+    std::atomic<bool> armed_{false};
+
+    ImuSampleBuffer buffer_;   // bounded by set_buffer_limits(), unbounded otherwise
+
+    // Serialises link_ commands between the caller and the watchdog
+    std::mutex link_mutex_;
+    std::atomic<bool> link_lost_{false};
+
+    // Stream watchdog
+    double stall_timeout_s_ = 0.0;   // 0 = disabled
+    bool   auto_reconnect_  = true;
+    std::atomic<double> last_rx_s_{0.0};
+    std::thread watchdog_;
+    std::mutex watchdog_mutex_;
+    std::condition_variable watchdog_cv_;
+    bool watchdog_stop_ = false;
+
+    mutable std::mutex gaps_mutex_;
+    std::vector<ImuGap> gaps_;
+    std::atomic<bool> gap_open_{false};
+    int reconnects_ = 0;
+
+    // Shot / motion detection; detectors are only touched from on_notify
+    bool              detect_shots_ = false;
+    ImuShotDetector   detector_;
+    ImuMotionDetector motion_;
+    bool              analyze_recoil_ = false;
+    ImuRecoilAnalyzer analyzer_;
+    bool              capture_bursts_ = false;
+    size_t            max_bursts_     = 0;
+    ImuBurstCapture   burst_;
+    std::atomic<bool> detector_reset_{false};
+    ImuEventBus*      events_ = nullptr;
+    std::mutex        shots_mutex_;
+    std::vector<ImuShotEvent> shots_;
+    std::vector<ImuShotMetrics> shot_metrics_;
+    std::deque<ImuBurstRecord>  bursts_;
+    std::atomic<uint64_t>       bursts_dropped_{0};
+
+    // Raw frames between the BLE callback and the decode executor
+    std::unique_ptr<ImuLockFreeQueue<ImuRawFrame>> raw_;
+    std::atomic<uint64_t> raw_dropped_{0};
+
+    std::string firmware_;
 
-    std::mutex buffer_mutex_;
-    std::deque<ImuSample> buffer_;   // unbounded is fine for 60s at 100 Hz
+    // Calibration and the columns decode_pending() runs it over
+    bool         calibrated_ = false;
+    ImuDeviceCal cal_src_;
+    ImuCalKernel cal_;
+    static constexpr size_t kDecodeBatch = 64;
+    struct DecodeBatch {
+        double  t[kDecodeBatch];
+        uint8_t accel[kDecodeBatch];
+        int16_t x[kDecodeBatch], y[kDecodeBatch], z[kDecodeBatch];
+        float   ox[kDecodeBatch], oy[kDecodeBatch], oz[kDecodeBatch];
+    } batch_;
 
-    void on_notify(SimpleBLE::ByteArray bytes);
+    bool connect_link();
+    bool enable_sensors();
+    bool restore_link(bool full);
+    void close_gap(double t);
+    void start_watchdog();
+    void stop_watchdog();
+    void watchdog_loop();
+    void on_notify(const uint8_t* data, size_t size);
+    void process_frame(double t, uint8_t cmd, int16_t rx, int16_t ry, int16_t rz);
+    // raw: the frame s was decoded from, for the burst record
+    void process_sample(const ImuSample& s, const ImuRawFrame& raw);
     void send_cmd(uint8_t cmd, uint8_t len,
                   const std::vector<uint8_t>& payload);
 };
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "imu_differential_eval.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Closed reference bins kept for lookup, power of two. 2.5 s at the default
+// 10 ms grid, far more than the drain skew between devices.
+constexpr size_t kRingBins = 256;
+constexpr size_t kMaxPending = kRingBins;
+
+inline bool is_accel(const ImuSample& s) {
+    return s.ax != 0.0f || s.ay != 0.0f || s.az != 0.0f;
+}
+
+} // namespace
+
+void ImuDifferentialEvaluator::Tilt::push(double t, double p, double r) {
+    if (pitch.n == 0) {
+        ref_pitch = p;
+        ref_roll  = r;
+    }
+    pitch.push(p);
+    roll.push(r);
+    pitch_trend.push(t, p);
+    roll_trend.push(t, r);
+    mac = std::max(mac, std::max(std::fabs(p - ref_pitch), std::fabs(r - ref_roll)));
+}
+
+ImuTiltMetrics ImuDifferentialEvaluator::Tilt::metrics() const {
+    ImuTiltMetrics m;
+    m.mac_deg           = mac;
+    m.noise_sigma       = std::max(pitch.sigma(), roll.sigma());
+    // Slopes are per second
+    m.drift_deg_per_min = 60.0 * std::max(std::fabs(pitch_trend.slope()),
+                                          std::fabs(roll_trend.slope()));
+    m.bins              = pitch.n;
+    return m;
+}
+
+ImuDifferentialEvaluator::ImuDifferentialEvaluator(const ImuReferenceConfig& cfg) : cfg_(cfg) {
+    cfg_.bin_s = std::max(cfg_.bin_s, 1e-3);
+    lag_bins_  = std::max(0, static_cast<int>(std::lround(cfg_.max_lag_s / cfg_.bin_s)));
+    lag_bins_  = std::min(lag_bins_, static_cast<int>(kRingBins / 4));
+}
+
+int ImuDifferentialEvaluator::add_device() {
+    Device d;
+    d.ring.resize(kRingBins);
+    d.lags.resize(static_cast<size_t>(2 * lag_bins_ + 1));
+    dev_.push_back(std::move(d));
+    return static_cast<int>(dev_.size() - 1);
+}
+
+void ImuDifferentialEvaluator::set_reference(int slot) {
+    ref_ = slot >= 0 && static_cast<size_t>(slot) < dev_.size() ? slot : -1;
+}
+
+void ImuDifferentialEvaluator::process(const ImuSample* const* chunks, const size_t* counts,
+                                       size_t devices) {
+    devices = std::min(devices, dev_.size());
+    if (!have_t0_) {
+        // Grid origin: earliest frame of the first non-empty round
+        for (size_t i = 0; i < devices; ++i) {
+            if (counts[i] == 0) continue;
+            t0_ = have_t0_ ? std::min(t0_, chunks[i][0].timestamp_s) : chunks[i][0].timestamp_s;
+            have_t0_ = true;
+        }
+        if (!have_t0_) return;
+    }
+
+    for (size_t i = 0; i < devices; ++i) {
+        for (size_t k = 0; k < counts[i]; ++k) push_frame(dev_[i], chunks[i][k]);
+    }
+    if (ref_ < 0) return;
+    for (size_t i = 0; i < devices; ++i) {
+        if (static_cast<int>(i) != ref_) compare(dev_[i], false);
+    }
+}
+
+void ImuDifferentialEvaluator::finish() {
+    // Reference first so the DUTs' last bins still find it
+    if (ref_ >= 0) close_bin(dev_[ref_]);
+    for (size_t i = 0; i < dev_.size(); ++i) {
+        if (static_cast<int>(i) == ref_) continue;
+        close_bin(dev_[i]);
+        if (ref_ >= 0) compare(dev_[i], true);
+    }
+}
+
+void ImuDifferentialEvaluator::push_frame(Device& d, const ImuSample& s) {
+    if (!is_accel(s)) return;
+    const int64_t b = static_cast<int64_t>(std::floor((s.timestamp_s - t0_) / cfg_.bin_s));
+    if (d.cur < 0) {
+        d.cur = std::max<int64_t>(b, 0);
+    } else if (b > d.cur) {
+        close_bin(d);
+        d.cur = b;
+    }
+    d.sum_p += imu_pitch_deg(s.ax, s.ay, s.az);
+    d.sum_r += imu_roll_deg(s.ay, s.az);
+    ++d.n;
+}
+
+void ImuDifferentialEvaluator::close_bin(Device& d) {
+    if (d.n == 0) return;
+    Bin bin;
+    bin.index = d.cur;
+    bin.pitch = static_cast<float>(d.sum_p / d.n);
+    bin.roll  = static_cast<float>(d.sum_r / d.n);
+    d.absolute.push(double(d.cur) * cfg_.bin_s, bin.pitch, bin.roll);
+
+    if (ref_ >= 0 && &d == &dev_[ref_]) {
+        d.ring[static_cast<size_t>(bin.index) & (kRingBins - 1)] = bin;
+    } else if (ref_ >= 0) {
+        // Reference stalled: the oldest waiting bins can no longer be matched
+        if (d.pending.size() - d.pending_head >= kMaxPending) ++d.pending_head;
+        d.pending.push_back(bin);
+    }
+    d.last_bin = d.cur;
+    d.sum_p = d.sum_r = 0.0;
+    d.n = 0;
+}
+
+void ImuDifferentialEvaluator::compare(Device& d, bool flush) {
+    const Device& r = dev_[ref_];
+    while (d.pending_head < d.pending.size()) {
+        const Bin& b = d.pending[d.pending_head];
+        if (!flush && r.last_bin < b.index + lag_bins_) break;   // reference not there yet
+
+        const double t = double(b.index) * cfg_.bin_s;
+        for (int l = -lag_bins_; l <= lag_bins_; ++l) {
+            const int64_t idx = b.index + l;
+            if (idx < 0) continue;
+            const Bin& rb = r.ring[static_cast<size_t>(idx) & (kRingBins - 1)];
+            if (rb.index != idx) continue;   // reference has no data there (gap)
+            d.lags[static_cast<size_t>(l + lag_bins_)].push(t, double(b.pitch) - rb.pitch,
+                                                            double(b.roll) - rb.roll);
+        }
+        ++d.pending_head;
+    }
+
+    // Keep the waiting list compact without shifting on every bin
+    if (d.pending_head > 0 && d.pending_head * 2 >= d.pending.size()) {
+        d.pending.erase(d.pending.begin(), d.pending.begin() + static_cast<ptrdiff_t>(d.pending_head));
+        d.pending_head = 0;
+    }
+}
+
+ImuTiltReport ImuDifferentialEvaluator::report(size_t slot) const {
+    ImuTiltReport rep;
+    if (slot >= dev_.size()) return rep;
+    const Device& d = dev_[slot];
+    rep.absolute = d.absolute.metrics();
+    if (ref_ < 0 || static_cast<int>(slot) == ref_) return rep;
+
+    // Offsets seen with too little overlap (reference gaps) are not trusted
+    uint64_t most = 0;
+    for (const auto& t : d.lags) most = std::max(most, t.pitch.n);
+    int    best     = -1;
+    double best_var = 0.0;
+    for (size_t k = 0; k < d.lags.size(); ++k) {
+        const Tilt& t = d.lags[k];
+        if (t.pitch.n < 2 || t.pitch.n * 2 < most) continue;
+        const double var = t.pitch.variance() + t.roll.variance();
+        if (best < 0 || var < best_var) {
+            best     = static_cast<int>(k);
+            best_var = var;
+        }
+    }
+    if (best < 0) return rep;
+
+    rep.has_diff = true;
+    rep.diff     = d.lags[static_cast<size_t>(best)].metrics();
+    rep.lag_s    = double(best - lag_bins_) * cfg_.bin_s;
+    return rep;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "imu_stream_stats.h"
+#include "imu_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Tilt stability over one run: max deviation from the first attitude,
+// sigma and linear drift of pitch / roll
+struct ImuTiltMetrics {
+    double   mac_deg           = 0.0;
+    double   noise_sigma       = 0.0;
+    double   drift_deg_per_min = 0.0;
+    uint64_t bins              = 0;
+};
+
+struct ImuTiltReport {
+    ImuTiltMetrics absolute;
+    bool           has_diff = false;   // false for the reference itself / no reference
+    ImuTiltMetrics diff;               // DUT minus reference
+    double         lag_s    = 0.0;     // reference bin offset that matched best
+};
+
+// Streaming differential evaluation against a golden unit.
+//
+// Every device's accel tilt is averaged onto a common grid of bin_s bins
+// (all streams are stamped with the same host clock). Once the reference
+// has closed the bins around a DUT bin, the DUT bin is compared with the
+// reference at every offset in +-max_lag_s and folded into one set of
+// running stats per offset; nothing is kept beyond a short ring, so the
+// cost per device is linear in its data. At the end the offset with the
+// smallest difference variance is reported, which absorbs the per-unit BLE
+// arrival skew.
+class ImuDifferentialEvaluator {
+public:
+    explicit ImuDifferentialEvaluator(const ImuReferenceConfig& cfg = ImuReferenceConfig{});
+
+    int  add_device();              // slot, matches the order chunks are passed in
+    void set_reference(int slot);   // -1 = absolute only
+    int  reference() const { return ref_; }
+
+    // chunks[i] / counts[i]: new frames of device i (may be empty)
+    void process(const ImuSample* const* chunks, const size_t* counts, size_t devices);
+
+    // Close the open bins and compare whatever the reference still covers
+    void finish();
+
+    ImuTiltReport report(size_t slot) const;
+
+private:
+    struct Tilt {
+        ImuRunningStats pitch, roll;
+        ImuLinearTrend  pitch_trend, roll_trend;
+        double ref_pitch = 0.0, ref_roll = 0.0;
+        double mac       = 0.0;
+
+        void push(double t, double p, double r);
+        ImuTiltMetrics metrics() const;
+    };
+
+    struct Bin {
+        int64_t index = -1;
+        float   pitch = 0.0f, roll = 0.0f;
+    };
+
+    struct Device {
+        // Bin being filled
+        int64_t cur      = -1;
+        double  sum_p    = 0.0, sum_r = 0.0;
+        int     n        = 0;
+        int64_t last_bin = -1;   // latest closed bin
+
+        Tilt absolute;
+        std::vector<Bin>  ring;      // reference: closed bins by index
+        std::vector<Bin>  pending;   // DUT: closed bins waiting for the reference
+        size_t            pending_head = 0;
+        std::vector<Tilt> lags;      // one per offset, -K..K
+    };
+
+    ImuReferenceConfig  cfg_;
+    int                 lag_bins_ = 0;
+    int                 ref_      = -1;
+    bool                have_t0_  = false;
+    double              t0_       = 0.0;
+    std::vector<Device> dev_;
+
+    void push_frame(Device& d, const ImuSample& s);
+    void close_bin(Device& d);
+    void compare(Device& d, bool flush);
+};
@@ -0,0 +1,93 @@
+#include "imu_evaluate.h"
+#include <algorithm>
+#include <limits>
+
+ImuDeviceEvaluator::ImuDeviceEvaluator(const ImuQaConfig& cfg)
+    : cfg_(cfg), spectrum_(cfg.spectrum) {}
+
+ImuQaResult ImuDeviceEvaluator::evaluate(
+    const std::string& id,
+    const ImuSampleChunks& samples,
+    const std::vector<ImuGap>& gaps,
+    double window_s,
+    const ImuTiltReport& tilt
+) {
+    ImuQaResult res{};
+    res.device_id = id;
+    res.sample_count = samples.size();
+    res.diff_mac_deg           = std::numeric_limits<double>::quiet_NaN();
+    res.diff_noise_sigma       = std::numeric_limits<double>::quiet_NaN();
+    res.diff_drift_deg_per_min = std::numeric_limits<double>::quiet_NaN();
+    res.reference_lag_s        = std::numeric_limits<double>::quiet_NaN();
+    res.gyro_band_rms_dps      = 0.0;
+    res.accel_band_rms_g       = 0.0;
+    res.spur_db                = 0.0;
+    res.spur_hz                = 0.0;
+    res.spur_axis              = -1;
+
+    // Samples are simply absent during a gap; what matters is whether the
+    // rest of the window still holds test_seconds worth of data
+    res.gap_count   = (int)gaps.size();
+    res.gap_seconds = 0.0;
+    for (const auto& g : gaps) res.gap_seconds += g.end_s - g.start_s;
+    res.coverage = cfg_.test_seconds > 0.0
+        ? std::min(1.0, std::max(0.0, window_s - res.gap_seconds) / cfg_.test_seconds)
+        : 1.0;
+
+    if (samples.empty()) {
+        res.status            = QaStatus::FAIL;
+        res.mac_deg           = 0.0;
+        res.noise_sigma       = 0.0;
+        res.drift_deg_per_min = 0.0;
+        res.gravity_mean_g    = 0.0;
+        res.abnormal_count    = 0;
+        return res;
+    }
+
+    // Average gravity magnitude, straight from the stored counts
+    res.gravity_mean_g = imu_mean_accel_magnitude(samples, nullptr);
+
+    // Tilt on the common bin grid. Absolute numbers include whatever the
+    // fixture does, so they are only graded through the difference signal.
+    res.mac_deg           = tilt.absolute.mac_deg;
+    res.noise_sigma       = tilt.absolute.noise_sigma;
+    res.drift_deg_per_min = tilt.absolute.drift_deg_per_min;
+    res.abnormal_count    = 0;
+    res.status            = QaStatus::PASS;
+
+    if (tilt.has_diff) {
+        res.diff_mac_deg           = tilt.diff.mac_deg;
+        res.diff_noise_sigma       = tilt.diff.noise_sigma;
+        res.diff_drift_deg_per_min = tilt.diff.drift_deg_per_min;
+        res.reference_lag_s        = tilt.lag_s;
+        if (res.diff_mac_deg > cfg_.max_mac_deg ||
+            res.diff_noise_sigma > cfg_.max_noise_sigma_deg ||
+            res.diff_drift_deg_per_min > cfg_.max_drift_deg_per_min) {
+            res.status = QaStatus::FAIL;
+        }
+    }
+
+    // Resonances and spurs a single sigma cannot show
+    if (cfg_.spectrum.enabled) {
+        auto spec = spectrum_.analyze(samples);
+        res.gyro_band_rms_dps = spec.gyro_band_rms_dps;
+        res.accel_band_rms_g  = spec.accel_band_rms_g;
+        res.spur_db           = spec.spur_db;
+        res.spur_hz           = spec.spur_hz;
+        res.spur_axis         = spec.spur_axis;
+        if ((cfg_.spectrum.max_gyro_band_dps > 0.0 && res.gyro_band_rms_dps > cfg_.spectrum.max_gyro_band_dps) ||
+            (cfg_.spectrum.max_accel_band_g > 0.0 && res.accel_band_rms_g > cfg_.spectrum.max_accel_band_g)) {
+            res.status = QaStatus::FAIL;
+        } else if (cfg_.spectrum.max_spur_db > 0.0 && res.spur_db > cfg_.spectrum.max_spur_db &&
+                   res.status == QaStatus::PASS) {
+            res.status = QaStatus::WARN;
+        }
+    }
+
+    // Too little data to grade: don't let partial data PASS
+    if (res.coverage < cfg_.min_coverage) {
+        res.status = QaStatus::FAIL;
+    }
+
+    return res;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "imu_differential_eval.h"
+#include "imu_sample_arena.h"
+#include "imu_spectrum.h"
+#include "imu_types.h"
+#include <string>
+#include <vector>
+
+// Grades one device's run window against the QA limits: coverage after
+// gaps, gravity, tilt (through the difference signal when a reference is
+// set) and the spectrum. Kept apart from ImuQaManager so it can be driven
+// without a BLE stack. Not thread-safe; the spectrum scratch is reused.
+class ImuDeviceEvaluator {
+public:
+    explicit ImuDeviceEvaluator(const ImuQaConfig& cfg);
+
+    ImuQaResult evaluate(const std::string& id,
+                         const ImuSampleChunks& samples,
+                         const std::vector<ImuGap>& gaps,
+                         double window_s,
+                         const ImuTiltReport& tilt);
+
+private:
+    ImuQaConfig         cfg_;
+    ImuSpectrumAnalyzer spectrum_;
+};
@@ -0,0 +1,265 @@
+#include "imu_event_bus.h"
+#include "imu_executor.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+// Longest the dispatcher sleeps without a wake-up; also the accept interval
+constexpr auto kIdleWait = std::chrono::milliseconds(20);
+
+} // namespace
+
+// ---- ImuLatencyHistogram -------------------------------------------------
+
+void ImuLatencyHistogram::record(double seconds) {
+    const uint64_t ns = seconds > 0.0 ? static_cast<uint64_t>(seconds * 1e9) : 0;
+    uint64_t us = ns / 1000;
+    int b = 0;
+    while (us > 1 && b < kBuckets - 1) {
+        us >>= 1;
+        ++b;
+    }
+    buckets_[b].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t prev = max_ns_.load(std::memory_order_relaxed);
+    while (ns > prev && !max_ns_.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {}
+}
+
+void ImuLatencyHistogram::reset() {
+    for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    max_ns_.store(0, std::memory_order_relaxed);
+}
+
+double ImuLatencyHistogram::percentile_us(double p) const {
+    const uint64_t n = count();
+    if (n == 0) return 0.0;
+    const uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(p, 0.0, 1.0) * double(n)));
+    uint64_t seen = 0;
+    for (int b = 0; b < kBuckets; ++b) {
+        seen += buckets_[b].load(std::memory_order_relaxed);
+        if (seen >= std::max<uint64_t>(rank, 1)) {
+            return std::min(double(uint64_t(2) << b), max_us());
+        }
+    }
+    return max_us();
+}
+
+void ImuLatencyHistogram::print(std::ostream& os, const char* label) const {
+    const uint64_t n = count();
+    os << label << ": " << n << " events";
+    if (n == 0) {
+        os << "\n";
+        return;
+    }
+    // The caller's stream: its format is put back afterwards
+    const std::ios_base::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << std::fixed << std::setprecision(0)
+       << ", p50 <= " << percentile_us(0.50) << " us"
+       << ", p99 <= " << percentile_us(0.99) << " us"
+       << ", max " << max_us() << " us\n";
+    for (int b = 0; b < kBuckets; ++b) {
+        uint64_t c = buckets_[b].load(std::memory_order_relaxed);
+        if (c == 0) continue;
+        uint64_t lo = b == 0 ? 0 : (uint64_t(1) << b);
+        os << "  " << std::setw(8) << lo << " us  " << std::setw(8) << c << "  "
+           << std::string(static_cast<size_t>(1 + 39 * c / n), '#') << "\n";
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
+
+// ---- ImuEventBus ---------------------------------------------------------
+
+ImuEventBus::ImuEventBus(const ImuEventConfig& cfg)
+    : cfg_(cfg), queue_(cfg.queue_capacity) {}
+
+ImuEventBus::~ImuEventBus() {
+    stop();
+}
+
+double ImuEventBus::now_s() {
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool ImuEventBus::start() {
+    if (running_) return true;
+    if (cfg_.socket && server_.open(cfg_.socket_path, cfg_.tcp_port)) {
+        std::cout << "[events] Streaming shot events on " << server_.endpoint() << "\n";
+    }
+    running_ = true;
+    dispatcher_ = std::thread(&ImuEventBus::dispatch_loop, this);
+    return true;
+}
+
+void ImuEventBus::stop() {
+    if (!running_) return;
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        running_ = false;
+        wake_    = true;
+    }
+    wake_cv_.notify_one();
+    if (dispatcher_.joinable()) dispatcher_.join();
+    server_.close();
+    socket_clients_ = 0;
+}
+
+bool ImuEventBus::publish(const ImuEvent& ev) {
+    if (!queue_.try_push(ev)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    published_.fetch_add(1, std::memory_order_relaxed);
+
+    // Pairs with the fence in dispatch_loop: either the dispatcher sees the
+    // event before sleeping, or we see it sleeping and wake it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed)) {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            wake_ = true;
+        }
+        wake_cv_.notify_one();
+    }
+    return true;
+}
+
+bool ImuEventBus::publish_shot(const std::string& device_id, const ImuShotEvent& shot) {
+    ImuEvent ev{};
+    ev.type     = ImuEventType::Shot;
+    std::strncpy(ev.device_id, device_id.c_str(), sizeof(ev.device_id) - 1);
+    ev.source_s = shot.detected_s;
+    ev.shot     = shot;
+    return publish(ev);
+}
+
+bool ImuEventBus::publish_motion(const std::string& device_id, bool started, double t, float rate_dps) {
+    ImuEvent ev{};
+    ev.type     = started ? ImuEventType::MotionStart : ImuEventType::MotionStop;
+    std::strncpy(ev.device_id, device_id.c_str(), sizeof(ev.device_id) - 1);
+    ev.source_s = t;
+    ev.rate_dps = rate_dps;
+    return publish(ev);
+}
+
+bool ImuEventBus::publish_metrics(const std::string& device_id, const ImuShotMetrics& m) {
+    ImuEvent ev{};
+    ev.type     = ImuEventType::ShotMetrics;
+    std::strncpy(ev.device_id, device_id.c_str(), sizeof(ev.device_id) - 1);
+    ev.source_s = m.completed_s;
+    ev.metrics  = m;
+    return publish(ev);
+}
+
+int ImuEventBus::subscribe(Subscriber cb) {
+    std::lock_guard<std::mutex> lock(subs_mutex_);
+    int token = next_token_++;
+    subs_.emplace_back(token, std::move(cb));
+    return token;
+}
+
+void ImuEventBus::unsubscribe(int token) {
+    std::lock_guard<std::mutex> lock(subs_mutex_);
+    subs_.erase(std::remove_if(subs_.begin(), subs_.end(),
+                               [token](const auto& s) { return s.first == token; }),
+                subs_.end());
+}
+
+void ImuEventBus::reset_stats() {
+    callback_latency_.reset();
+    socket_latency_.reset();
+    published_ = 0;
+    dropped_   = 0;
+}
+
+void ImuEventBus::print_latency(std::ostream& os) const {
+    os << "Event latency, BLE callback -> subscriber (" << published() << " published, "
+       << dropped() << " dropped)\n";
+    callback_latency_.print(os, "in-process");
+    if (socket_latency_.count() > 0) socket_latency_.print(os, "socket");
+}
+
+void ImuEventBus::dispatch_loop() {
+    imu_apply_thread_placement(placement_, "imu-events");
+    ImuEvent ev;
+    while (running_) {
+        bool any = false;
+        while (queue_.try_pop(ev)) {
+            deliver(ev);
+            any = true;
+        }
+        if (server_.poll_accept() > 0) {
+            socket_clients_ = server_.client_count();
+            std::cout << "[events] Socket client connected (" << server_.client_count() << ")\n";
+        }
+        if (any) continue;
+
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (queue_.empty() && running_) {
+            wake_cv_.wait_for(lock, kIdleWait, [this] { return wake_; });
+        }
+        wake_ = false;
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+
+    // Deliver what was already queued
+    while (queue_.try_pop(ev)) deliver(ev);
+}
+
+void ImuEventBus::deliver(const ImuEvent& ev) {
+    {
+        std::lock_guard<std::mutex> lock(subs_mutex_);
+        if (!subs_.empty()) {
+            callback_latency_.record(now_s() - ev.source_s);
+            for (auto& s : subs_) s.second(ev);
+        }
+    }
+
+    if (server_.client_count() > 0) {
+        char line[512];
+        size_t n = format_json(ev, line, sizeof(line));
+        server_.broadcast(line, n);
+        socket_latency_.record(now_s() - ev.source_s);
+        socket_clients_ = server_.client_count();
+    }
+}
+
+size_t ImuEventBus::format_json(const ImuEvent& ev, char* out, size_t cap) {
+    int n;
+    if (ev.type == ImuEventType::Shot) {
+        n = std::snprintf(out, cap,
+            "{\"type\":\"shot\",\"device\":\"%s\",\"source_s\":%.6f,\"t\":%.6f,"
+            "\"peak_g\":%.3f,\"peak_dps\":%.1f,\"duration_ms\":%.2f}\n",
+            ev.device_id, ev.source_s, ev.shot.timestamp_s,
+            ev.shot.peak_g, ev.shot.peak_dps, ev.shot.duration_s * 1000.0);
+    } else if (ev.type == ImuEventType::ShotMetrics) {
+        const ImuShotMetrics& m = ev.metrics;
+        char rtz[32] = "null";
+        if (!std::isnan(m.return_to_zero_s)) {
+            std::snprintf(rtz, sizeof(rtz), "%.1f", m.return_to_zero_s * 1000.0);
+        }
+        n = std::snprintf(out, cap,
+            "{\"type\":\"shot_metrics\",\"device\":\"%s\",\"source_s\":%.6f,\"t\":%.6f,"
+            "\"string\":%d,\"shot\":%d,\"split_s\":%.3f,\"rise_deg\":%.3f,\"rtz_ms\":%s,"
+            "\"lateral_deg\":%.3f,\"impulse_mps\":%.4f}\n",
+            ev.device_id, ev.source_s, m.timestamp_s, m.string_index, m.shot_index,
+            m.split_s, m.muzzle_rise_deg, rtz, m.lateral_deg, m.impulse_mps);
+    } else {
+        n = std::snprintf(out, cap,
+            "{\"type\":\"%s\",\"device\":\"%s\",\"source_s\":%.6f,\"rate_dps\":%.1f}\n",
+            imu_event_type_name(ev.type), ev.device_id, ev.source_s, ev.rate_dps);
+    }
+    return n < 0 ? 0 : std::min(static_cast<size_t>(n), cap - 1);
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include "imu_local_socket.h"
+#include "imu_lockfree_queue.h"
+#include "imu_types.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class ImuEventType : uint8_t {
+    Shot,
+    MotionStart,
+    MotionStop,
+    ShotMetrics
+};
+
+inline const char* imu_event_type_name(ImuEventType t) {
+    return t == ImuEventType::Shot        ? "shot" :
+           t == ImuEventType::MotionStart ? "motion_start" :
+           t == ImuEventType::MotionStop  ? "motion_stop" : "shot_metrics";
+}
+
+// Fixed size so it can live in the lock-free ring
+struct ImuEvent {
+    ImuEventType type;
+    char         device_id[24];   // MAC, NUL terminated
+    double       source_s;        // host time of the BLE callback that produced it
+    ImuShotEvent shot;            // Shot only
+    float        rate_dps;        // Motion: |w| at the transition
+    ImuShotMetrics metrics;       // ShotMetrics only
+};
+
+// Latency histogram with log2 microsecond buckets: bucket i holds
+// [2^i, 2^(i+1)) us, bucket 0 everything below 2 us. Recording is one
+// relaxed atomic add, so it can be read while the dispatcher runs.
+class ImuLatencyHistogram {
+public:
+    static constexpr int kBuckets = 24;   // last bucket is open ended (> 8 s)
+
+    void record(double seconds);
+    void reset();
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    double   max_us() const { return max_ns_.load(std::memory_order_relaxed) / 1000.0; }
+    // Upper edge of the bucket holding the p-th percentile (0..1)
+    double   percentile_us(double p) const;
+
+    void print(std::ostream& os, const char* label) const;
+
+private:
+    std::atomic<uint64_t> buckets_[kBuckets] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> max_ns_{0};
+};
+
+// Pushes shot and motion events to subscribers as they happen.
+//
+// Producers (BLE notification threads) publish into a lock-free ring and
+// never block; a full ring drops the event and counts it. One dispatcher
+// thread delivers to in-process subscribers and, as JSON lines, to clients
+// of the local socket (see ImuLocalServer). Latency from the BLE callback
+// to delivery is recorded per path.
+//
+// Socket line format:
+//   {"type":"shot","device":"..","source_s":..,"t":..,"peak_g":..,
+//    "peak_dps":..,"duration_ms":..}
+//   {"type":"motion_start"|"motion_stop","device":"..","source_s":..,"rate_dps":..}
+//   {"type":"shot_metrics","device":"..","source_s":..,"t":..,"string":..,"shot":..,
+//    "split_s":..,"rise_deg":..,"rtz_ms":..|null,"lateral_deg":..,"impulse_mps":..}
+// source_s is steady-clock seconds, comparable with the host's monotonic
+// clock for end-to-end latency on the client side.
+class ImuEventBus {
+public:
+    using Subscriber = std::function<void(const ImuEvent&)>;
+
+    explicit ImuEventBus(const ImuEventConfig& cfg = ImuEventConfig{});
+    ~ImuEventBus();
+
+    ImuEventBus(const ImuEventBus&) = delete;
+    ImuEventBus& operator=(const ImuEventBus&) = delete;
+
+    // Core / priority of the dispatcher (call before start)
+    void set_thread_placement(const ImuThreadPlacement& p) { placement_ = p; }
+
+    bool start();
+    void stop();
+    bool running() const { return running_; }
+
+    // Lock free, callable from any thread; false when the event was dropped
+    bool publish(const ImuEvent& ev);
+    bool publish_shot(const std::string& device_id, const ImuShotEvent& shot);
+    bool publish_motion(const std::string& device_id, bool started, double t, float rate_dps);
+    bool publish_metrics(const std::string& device_id, const ImuShotMetrics& m);
+
+    // Subscribers run on the dispatcher thread and must not (un)subscribe
+    // from inside the callback. Returns a token for unsubscribe().
+    int  subscribe(Subscriber cb);
+    void unsubscribe(int token);
+
+    const ImuLatencyHistogram& callback_latency() const { return callback_latency_; }
+    const ImuLatencyHistogram& socket_latency() const   { return socket_latency_; }
+    uint64_t published() const { return published_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const   { return dropped_.load(std::memory_order_relaxed); }
+    size_t   socket_clients() const { return socket_clients_.load(std::memory_order_relaxed); }
+    void     reset_stats();
+    void     print_latency(std::ostream& os) const;
+
+    // Time base of ImuEvent::source_s (same as sample timestamps)
+    static double now_s();
+
+private:
+    ImuEventConfig cfg_;
+    ImuThreadPlacement placement_;
+    ImuLockFreeQueue<ImuEvent> queue_;
+
+    std::atomic<bool> running_{false};
+    std::thread dispatcher_;
+
+    // Dispatcher sleeps only when the ring is empty; producers wake it
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::atomic<bool> sleeping_{false};
+    bool wake_ = false;
+
+    std::mutex subs_mutex_;
+    std::vector<std::pair<int, Subscriber>> subs_;
+    int next_token_ = 1;
+
+    ImuLocalServer server_;   // dispatcher thread only once started
+    std::atomic<size_t> socket_clients_{0};
+
+    ImuLatencyHistogram callback_latency_;
+    ImuLatencyHistogram socket_latency_;
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    void dispatch_loop();
+    void deliver(const ImuEvent& ev);
+    static size_t format_json(const ImuEvent& ev, char* out, size_t cap);
+};
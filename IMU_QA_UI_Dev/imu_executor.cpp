@@ -0,0 +1,218 @@
+#include "imu_executor.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+bool imu_apply_thread_placement(const ImuThreadPlacement& p, const char* name) {
+    bool ok = true;
+#ifdef _WIN32
+    if (p.cpu >= 0) {
+        if (p.cpu >= 64 || SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << p.cpu) == 0) {
+            std::cerr << "[exec] " << name << ": cannot pin to CPU " << p.cpu << "\n";
+            ok = false;
+        }
+    }
+    if (p.rt_priority > 0 && !SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)) {
+        std::cerr << "[exec] " << name << ": cannot raise priority\n";
+        ok = false;
+    }
+#else
+#ifdef __linux__
+    if (name && *name) {
+        char short_name[16];   // kernel limit incl. terminator
+        std::strncpy(short_name, name, sizeof(short_name) - 1);
+        short_name[sizeof(short_name) - 1] = '\0';
+        pthread_setname_np(pthread_self(), short_name);
+    }
+    if (p.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (p.cpu >= CPU_SETSIZE) {
+            ok = false;
+        } else {
+            CPU_SET(p.cpu, &set);
+            ok = pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+        }
+        if (!ok) std::cerr << "[exec] " << name << ": cannot pin to CPU " << p.cpu << "\n";
+    }
+#else
+    // macOS has no hard affinity; priority still applies
+    if (p.cpu >= 0) {
+        std::cerr << "[exec] " << name << ": CPU pinning not supported on this platform\n";
+        ok = false;
+    }
+#endif
+    if (p.rt_priority > 0) {
+        sched_param sp{};
+        sp.sched_priority = std::clamp(p.rt_priority, sched_get_priority_min(SCHED_FIFO),
+                                       sched_get_priority_max(SCHED_FIFO));
+        const int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+        if (err != 0) {
+            std::cerr << "[exec] " << name << ": SCHED_FIFO " << sp.sched_priority
+                      << " refused (" << std::strerror(err)
+                      << "; needs CAP_SYS_NICE or an rtprio limit)\n";
+            ok = false;
+        }
+    }
+#endif
+    return ok;
+}
+
+bool imu_reserve_cores(const std::vector<int>& cpus) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) return false;
+    for (int c : cpus) {
+        if (c >= 0 && c < CPU_SETSIZE) CPU_CLR(c, &set);
+    }
+    if (CPU_COUNT(&set) == 0) {
+        std::cerr << "[exec] Not reserving cores: nothing would be left for other threads\n";
+        return false;
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+std::string imu_isolated_cpus() {
+#ifdef __linux__
+    std::ifstream f("/sys/devices/system/cpu/isolated");
+    std::string line;
+    if (f && std::getline(f, line)) return line;
+#endif
+    return std::string();
+}
+
+// ---- ImuExecutor -----------------------------------------------------------
+
+ImuExecutor::ImuExecutor(std::string name, const ImuThreadPlacement& placement)
+    : name_(std::move(name)), placement_(placement) {}
+
+ImuExecutor::~ImuExecutor() {
+    stop();
+}
+
+void ImuExecutor::set_tick(double period_s, std::function<void()> fn) {
+    period_s_ = period_s;
+    tick_     = std::move(fn);
+}
+
+bool ImuExecutor::start() {
+    if (running_) return true;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = false;
+    }
+    running_ = true;
+    worker_  = std::thread(&ImuExecutor::loop, this);
+    return true;
+}
+
+void ImuExecutor::stop() {
+    if (!running_) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) worker_.join();
+    running_ = false;
+}
+
+bool ImuExecutor::post(std::function<void()> fn) {
+    if (!running_) return false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(Task{std::move(fn), clock::now()});
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void ImuExecutor::run(const std::function<void()>& fn) {
+    if (!running_ || std::this_thread::get_id() == worker_.get_id()) {
+        fn();
+        return;
+    }
+    std::promise<void> done;
+    auto finished = done.get_future();
+    // An exception reaches the caller, as it would if fn ran inline
+    auto task = [&] {
+        try {
+            fn();
+            done.set_value();
+        } catch (...) {
+            done.set_exception(std::current_exception());
+        }
+    };
+    if (!post(task)) {
+        fn();
+        return;
+    }
+    finished.get();
+}
+
+void ImuExecutor::reset_stats() {
+    tick_late_.reset();
+    queue_delay_.reset();
+}
+
+void ImuExecutor::print_stats(std::ostream& os) const {
+    const std::string prefix = "[" + name_ + "] ";
+    if (tick_ && tick_late_.count() > 0) tick_late_.print(os, (prefix + "tick lateness").c_str());
+    if (queue_delay_.count() > 0) queue_delay_.print(os, (prefix + "queue delay").c_str());
+}
+
+void ImuExecutor::loop() {
+    placed_ = imu_apply_thread_placement(placement_, name_.c_str());
+
+    const auto period = std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double>(period_s_));
+    const bool ticking = tick_ && period.count() > 0;
+    auto next = clock::now() + period;
+
+    std::deque<Task> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto ready = [&] { return stop_ || !queue_.empty(); };
+            if (ticking) cv_.wait_until(lock, next, ready);
+            else         cv_.wait(lock, ready);
+            if (stop_ && queue_.empty()) break;
+            batch.swap(queue_);
+        }
+
+        for (auto& t : batch) {
+            queue_delay_.record(std::chrono::duration<double>(clock::now() - t.posted).count());
+            t.fn();
+        }
+        batch.clear();
+
+        if (ticking) {
+            const auto now = clock::now();
+            if (now >= next) {
+                tick_late_.record(std::chrono::duration<double>(now - next).count());
+                tick_();
+                next += period;
+                // Overran by more than a period: skip ahead instead of bursting
+                if (next < now) next = now + period;
+            }
+        }
+    }
+}
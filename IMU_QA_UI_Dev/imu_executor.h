@@ -0,0 +1,88 @@
+#pragma once
+#include "imu_event_bus.h"
+#include "imu_types.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Pin / prioritise the calling thread and give it a name. Failures (no
+// CAP_SYS_NICE, core out of range) are reported and leave the thread as it
+// was; returns false if anything could not be applied.
+bool imu_apply_thread_placement(const ImuThreadPlacement& p, const char* name);
+
+// Take the given cores out of the calling thread's affinity. Threads it
+// creates afterwards inherit the mask, so calling this before the BLE stack
+// starts keeps its threads off the cores the executors are pinned to.
+// Linux only; false elsewhere.
+bool imu_reserve_cores(const std::vector<int>& cpus);
+
+// Kernel isolcpus list ("" when none or unknown)
+std::string imu_isolated_cpus();
+
+// One worker thread with a task queue and an optional periodic tick.
+//
+// post() hands work over without waiting; run() waits for it and rethrows
+// what it threw (and runs inline when the executor is not started, so
+// callers need no second code path). Every task's queueing delay and every tick's lateness against its
+// deadline go into histograms, which is the scheduling jitter this thread
+// actually sees.
+class ImuExecutor {
+public:
+    explicit ImuExecutor(std::string name, const ImuThreadPlacement& placement = ImuThreadPlacement{});
+    ~ImuExecutor();
+
+    ImuExecutor(const ImuExecutor&) = delete;
+    ImuExecutor& operator=(const ImuExecutor&) = delete;
+
+    // Call before start(); fn runs every period_s on the worker
+    void set_tick(double period_s, std::function<void()> fn);
+
+    bool start();
+    void stop();   // runs what is queued, then joins
+    bool running() const { return running_; }
+
+    bool post(std::function<void()> fn);   // false when not running
+    void run(const std::function<void()>& fn);
+
+    const std::string& name() const { return name_; }
+    bool placement_applied() const  { return placed_; }
+
+    const ImuLatencyHistogram& tick_lateness() const { return tick_late_; }
+    const ImuLatencyHistogram& queue_delay() const   { return queue_delay_; }
+    void reset_stats();
+    void print_stats(std::ostream& os) const;
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct Task {
+        std::function<void()> fn;
+        clock::time_point     posted;
+    };
+
+    std::string        name_;
+    ImuThreadPlacement placement_;
+    std::thread        worker_;
+    std::atomic<bool>  running_{false};
+    std::atomic<bool>  placed_{false};
+
+    std::mutex              mutex_;
+    std::condition_variable cv_;
+    std::deque<Task>        queue_;
+    bool                    stop_ = false;
+
+    double                period_s_ = 0.0;
+    std::function<void()> tick_;
+
+    ImuLatencyHistogram tick_late_;
+    ImuLatencyHistogram queue_delay_;
+
+    void loop();
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include "imu_types.h"
+#include <cstddef>
+#include <cstdint>
+
+// One GMSync notification: 55 AA cmd len, then three big-endian int16
+// (cmd 0x08 accel, 0x0A gyro, len 0x06)
+struct ImuRawFrame {
+    double  t;
+    uint8_t cmd;
+    int16_t v[3];
+};
+
+inline int16_t imu_be16(const uint8_t* p) {
+    return static_cast<int16_t>((p[0] << 8) | p[1]);
+}
+
+// False when the bytes are not a well-formed 6-byte frame. The command is
+// not checked here; the session notes arrival for any frame.
+inline bool imu_parse_frame(const uint8_t* d, size_t n, uint8_t& cmd, int16_t v[3]) {
+    if (n < 10 || d[0] != 0x55 || d[1] != 0xAA || d[3] != 0x06) return false;
+    cmd  = d[2];
+    v[0] = imu_be16(d + 4);
+    v[1] = imu_be16(d + 6);
+    v[2] = imu_be16(d + 8);
+    return true;
+}
+
+// Inverse of imu_parse_frame; out holds 10 bytes
+inline void imu_encode_frame(uint8_t cmd, const int16_t v[3], uint8_t* out) {
+    out[0] = 0x55;
+    out[1] = 0xAA;
+    out[2] = cmd;
+    out[3] = 0x06;
+    for (int k = 0; k < 3; ++k) {
+        const uint16_t u = static_cast<uint16_t>(v[k]);
+        out[4 + 2 * k] = static_cast<uint8_t>(u >> 8);
+        out[5 + 2 * k] = static_cast<uint8_t>(u);
+    }
+}
+
+inline bool imu_is_sample_cmd(uint8_t cmd) { return cmd == 0x08 || cmd == 0x0A; }
+
+// Counts to g / dps; false for commands that carry no sample
+inline bool imu_decode_frame(double t, uint8_t cmd, int16_t rx, int16_t ry, int16_t rz, ImuSample& s) {
+    s = ImuSample{};
+    s.timestamp_s = t;
+    if (cmd == 0x08) {
+        s.ax = 16.0f * rx / 32768.0f;
+        s.ay = 16.0f * ry / 32768.0f;
+        s.az = 16.0f * rz / 32768.0f;
+    } else if (cmd == 0x0A) {
+        s.gx = 500.0f * rx / 28571.0f;
+        s.gy = 500.0f * ry / 28571.0f;
+        s.gz = 500.0f * rz / 28571.0f;
+    } else {
+        return false;
+    }
+    return true;
+}
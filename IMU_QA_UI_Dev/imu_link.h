@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Byte transport under ImuDeviceSession: one GATT link to a GMSync unit.
+// ImuBleLink is the real peripheral, ImuEmulatedLink a synthetic unit
+// behind ImuLinkEmulator. Calls mirror SimpleBLE's and throw a
+// std::exception on failure the same way.
+class ImuLink {
+public:
+    using NotifyFn = std::function<void(const uint8_t* data, size_t size)>;
+
+    virtual ~ImuLink() = default;
+
+    virtual void connect() = 0;
+    virtual void disconnect() = 0;
+    virtual bool is_connected() = 0;
+
+    // IMU frame notifications
+    virtual void subscribe(NotifyFn fn) = 0;
+    virtual void unsubscribe() = 0;
+
+    // 55 AA cmd len [payload] command write
+    virtual void write(const std::vector<uint8_t>& bytes) = 0;
+
+    // Called from the transport's thread when the link drops by itself
+    virtual void set_on_disconnected(std::function<void()> fn) = 0;
+
+    // Firmware revision the unit reports once connected, empty if unknown.
+    // Does not throw.
+    virtual std::string firmware() { return {}; }
+};
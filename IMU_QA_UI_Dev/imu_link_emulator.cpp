@@ -0,0 +1,300 @@
+#include "imu_link_emulator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+constexpr double kNever = std::numeric_limits<double>::infinity();
+}
+
+ImuLinkEmulator::ImuLinkEmulator(const ImuLinkConditions& c) : c_(c), rng_(c.seed) {
+    std::sort(c_.outages.begin(), c_.outages.end(),
+              [](const ImuLinkOutage& a, const ImuLinkOutage& b) { return a.at_s < b.at_s; });
+    if (c_.disconnect_mean_s > 0.0) next_random_down_ = exponential(c_.disconnect_mean_s);
+}
+
+double ImuLinkEmulator::exponential(double mean) {
+    return mean > 0.0 ? -mean * std::log(1.0 - unit_(rng_)) : 0.0;
+}
+
+double ImuLinkEmulator::next_down() const {
+    const double scheduled = next_scheduled_ < c_.outages.size() ? c_.outages[next_scheduled_].at_s : kNever;
+    return std::min(scheduled, next_random_down_);
+}
+
+bool ImuLinkEmulator::up(double t) {
+    for (;;) {
+        if (down_) {
+            if (t < down_until_) return false;
+            down_ = false;
+            // Random up time counts from reconnection
+            if (c_.disconnect_mean_s > 0.0) next_random_down_ = down_until_ + exponential(c_.disconnect_mean_s);
+            continue;
+        }
+        const double at = next_down();
+        if (t < at) return true;
+
+        double duration = c_.outage_s;
+        if (next_scheduled_ < c_.outages.size() && c_.outages[next_scheduled_].at_s <= next_random_down_) {
+            duration = c_.outages[next_scheduled_++].duration_s;
+        } else {
+            next_random_down_ = kNever;
+        }
+        down_       = true;
+        down_until_ = at + std::max(duration, 0.0);
+        ++stats_.outages;
+
+        // Whatever was still in flight when the link dropped never arrives
+        while (!pending_.empty() && pending_.back().t_rx >= at) {
+            pending_.pop_back();
+            ++stats_.dropped_offline;
+        }
+        event_t_    = -kNever;
+        event_fill_ = 0;
+    }
+}
+
+bool ImuLinkEmulator::send(double t, const uint8_t* data, size_t size) {
+    ++stats_.sent;
+    if (!up(t)) {
+        ++stats_.dropped_offline;
+        return false;
+    }
+    if (size > kMaxFrameBytes) {   // would not fit one notification
+        ++stats_.lost;
+        return false;
+    }
+
+    // Two-state loss: runs of mean length loss_burst, loss of them overall
+    if (c_.loss > 0.0) {
+        const double leave = 1.0 / std::max(c_.loss_burst, 1.0);
+        const double enter = std::min(1.0, c_.loss * leave / std::max(1.0 - c_.loss, 1e-9));
+        in_loss_ = unit_(rng_) < (in_loss_ ? 1.0 - leave : enter);
+        if (in_loss_) {
+            ++stats_.lost;
+            return false;
+        }
+    }
+
+    // Next connection event with room, on the interval grid after t
+    if (t > event_t_ || event_fill_ >= std::max(c_.frames_per_event, 1)) {
+        const double iv = std::max(c_.interval_s, 1e-6);
+        double e = std::max(event_t_ + iv, std::ceil(t / iv) * iv);
+        if (c_.spike_prob > 0.0 && unit_(rng_) < c_.spike_prob) {
+            e += std::ceil(c_.spike_s / iv) * iv;
+            ++stats_.spikes;
+        }
+        event_t_    = e;
+        event_fill_ = 0;
+        event_rx_   = std::max(event_rx_, e + c_.latency_s + exponential(c_.jitter_s));
+        ++stats_.events;
+    }
+    ++event_fill_;
+    stats_.max_burst = std::max<uint64_t>(stats_.max_burst, uint64_t(event_fill_));
+
+    Pending p;
+    p.t_tx = t;
+    p.t_rx = event_rx_;
+    p.size = uint8_t(size);
+    std::memcpy(p.data, data, size);
+    if (c_.reorder > 0.0 && !pending_.empty() && unit_(rng_) < c_.reorder) {
+        // Arrival slots stay in order; the frames in them swap
+        Pending& prev = pending_.back();
+        std::swap(prev.t_tx, p.t_tx);
+        std::swap(prev.size, p.size);
+        std::swap(prev.data, p.data);
+        ++stats_.reordered;
+    }
+    pending_.push_back(p);
+    return true;
+}
+
+double ImuLinkEmulator::next_change() const {
+    const double rx   = pending_.empty() ? kNever : pending_.front().t_rx;
+    const double edge = down_ ? down_until_ : next_down();
+    return std::min(rx, edge);
+}
+
+void ImuLinkEmulator::drop_pending() {
+    stats_.dropped_offline += pending_.size();
+    pending_.clear();
+    event_t_    = -kNever;
+    event_fill_ = 0;
+}
+
+ImuLinkStats ImuLinkEmulator::stats() const {
+    ImuLinkStats s = stats_;
+    s.latency_p50_us = latency_.percentile_us(0.50);
+    s.latency_p99_us = latency_.percentile_us(0.99);
+    s.latency_max_us = latency_.max_us();
+    return s;
+}
+
+bool imu_link_profile(const std::string& name, ImuLinkConditions& c) {
+    const bool worst = name == "worst";
+    if (name != "clean" && name != "busy" && name != "lossy" && name != "flaky" && !worst) return false;
+    if (name == "busy" || worst) {
+        c.frames_per_event = 4;
+        c.jitter_s         = 0.004;
+        c.spike_prob       = 0.002;
+        c.spike_s          = 0.15;
+    }
+    if (name == "lossy" || worst) {
+        c.loss       = 0.02;
+        c.loss_burst = 4.0;
+        c.reorder    = 0.005;
+    }
+    if (name == "flaky" || worst) {
+        c.disconnect_mean_s = 20.0;
+        c.outage_s          = 2.5;
+    }
+    return true;
+}
+
+ImuSyntheticSource::ImuSyntheticSource(uint64_t seed, double rate_hz)
+    : rng_(seed), period_(1.0 / std::max(rate_hz, 1.0)) {}
+
+bool ImuSyntheticSource::next(ImuRawFrame& f) {
+    const bool accel = k_ % 2 == 0;
+    f.t   = double(k_) * period_;
+    f.cmd = accel ? 0x08 : 0x0A;
+    for (int i = 0; i < 3; ++i) {
+        const float base = accel && i == 2 ? float(kAccelCountsPerG) : 0.0f;
+        f.v[i] = int16_t(std::lround(base + noise_(rng_)));
+    }
+    ++k_;
+    return true;
+}
+
+ImuReplaySource::ImuReplaySource(std::vector<ImuSample> samples) : samples_(std::move(samples)) {}
+
+bool ImuReplaySource::next(ImuRawFrame& f) {
+    if (i_ >= samples_.size()) return false;
+    const ImuSample& s = samples_[i_++];
+    const bool accel = s.ax != 0.0f || s.ay != 0.0f || s.az != 0.0f;
+    auto counts = [](double v) { return int16_t(std::lround(std::clamp(v, -32768.0, 32767.0))); };
+    f.t   = s.timestamp_s - samples_.front().timestamp_s;
+    f.cmd = accel ? 0x08 : 0x0A;
+    if (accel) {
+        f.v[0] = counts(s.ax * kAccelCountsPerG);
+        f.v[1] = counts(s.ay * kAccelCountsPerG);
+        f.v[2] = counts(s.az * kAccelCountsPerG);
+    } else {
+        f.v[0] = counts(s.gx * kGyroCountsPerDps);
+        f.v[1] = counts(s.gy * kGyroCountsPerDps);
+        f.v[2] = counts(s.gz * kGyroCountsPerDps);
+    }
+    return true;
+}
+
+ImuEmulatedLink::ImuEmulatedLink(const ImuLinkConditions& c, std::unique_ptr<ImuFrameSource> source)
+    : emu_(c), source_(std::move(source)), t0_(std::chrono::steady_clock::now()) {
+    has_next_ = source_ && source_->next(next_);
+    thread_ = std::thread(&ImuEmulatedLink::run, this);
+}
+
+ImuEmulatedLink::~ImuEmulatedLink() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+double ImuEmulatedLink::elapsed() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0_).count();
+}
+
+void ImuEmulatedLink::connect() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!emu_.up(elapsed())) throw std::runtime_error("emulated link is down");
+    connected_ = true;
+}
+
+void ImuEmulatedLink::disconnect() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    connected_ = false;
+    accel_on_  = false;
+    gyro_on_   = false;
+    emu_.drop_pending();
+}
+
+bool ImuEmulatedLink::is_connected() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return connected_;
+}
+
+void ImuEmulatedLink::subscribe(NotifyFn fn) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!connected_) throw std::runtime_error("emulated link not connected");
+    notify_ = std::move(fn);
+}
+
+void ImuEmulatedLink::unsubscribe() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    notify_ = nullptr;
+}
+
+void ImuEmulatedLink::write(const std::vector<uint8_t>& bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!connected_) throw std::runtime_error("emulated link not connected");
+        if (bytes.size() < 3 || bytes[0] != 0x55 || bytes[1] != 0xAA) return;
+        switch (bytes[2]) {
+        case 0x08: accel_on_ = true; break;
+        case 0x0A: gyro_on_  = true; break;
+        case 0xF0: accel_on_ = gyro_on_ = false; break;
+        default: break;
+        }
+    }
+    cv_.notify_all();
+}
+
+void ImuEmulatedLink::set_on_disconnected(std::function<void()> fn) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    on_disconnected_ = std::move(fn);
+}
+
+ImuLinkStats ImuEmulatedLink::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return emu_.stats();
+}
+
+void ImuEmulatedLink::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        const double now = elapsed();
+
+        // The unit sends whatever its enabled sensors produced by now
+        while (has_next_ && next_.t <= now) {
+            const bool on = connected_ && (next_.cmd == 0x08 ? accel_on_ : gyro_on_);
+            if (on) {
+                uint8_t frame[10];
+                imu_encode_frame(next_.cmd, next_.v, frame);
+                emu_.send(next_.t, frame, sizeof(frame));
+            }
+            has_next_ = source_->next(next_);
+        }
+
+        emu_.deliver(now, [&](double, const uint8_t* data, size_t size) {
+            if (connected_ && notify_) notify_(data, size);
+        });
+
+        if (connected_ && !emu_.up(now)) {
+            connected_ = false;
+            accel_on_  = false;
+            gyro_on_   = false;
+            auto fn = on_disconnected_;
+            lock.unlock();
+            if (fn) fn();
+            lock.lock();
+            continue;
+        }
+
+        const double wake = std::min({has_next_ ? next_.t : kNever, emu_.next_change(), now + 0.01});
+        cv_.wait_for(lock, std::chrono::duration<double>(std::max(0.0, wake - elapsed())),
+                     [this] { return stop_; });
+    }
+}
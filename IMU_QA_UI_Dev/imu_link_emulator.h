@@ -0,0 +1,191 @@
+#pragma once
+#include "imu_event_bus.h"
+#include "imu_frame.h"
+#include "imu_link.h"
+#include "imu_types.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ImuLinkStats {
+    uint64_t sent            = 0;   // frames the unit sent
+    uint64_t delivered       = 0;
+    uint64_t lost            = 0;
+    uint64_t dropped_offline = 0;   // sent or in flight while the link was down
+    uint64_t reordered       = 0;
+    uint64_t events          = 0;   // connection events that carried frames
+    uint64_t spikes          = 0;
+    uint64_t outages         = 0;
+    uint64_t max_burst       = 0;   // most frames in one connection event
+    double   latency_p50_us  = 0.0; // send -> delivery
+    double   latency_p99_us  = 0.0;
+    double   latency_max_us  = 0.0;
+};
+
+// BLE link model in stream time (seconds, non-decreasing, chosen by the
+// caller). Frames queue at the sender and leave in connection events of
+// up to frames_per_event, every interval_s; a spike makes the radio miss
+// events for spike_s, so the backlog then arrives in full events. Each
+// event lands after latency_s plus an exponential jitter, in order.
+// Losses come in runs (two-state Gilbert model), reordering swaps a frame
+// with the one before it, and outages (the schedule plus exponential up
+// times) drop everything sent or still in flight while they last.
+//
+// All randomness comes from one generator seeded from the conditions and
+// is drawn in send / time order, so the same calls give the same result.
+class ImuLinkEmulator {
+public:
+    static constexpr size_t kMaxFrameBytes = 20;   // notification payload at the default MTU
+
+    explicit ImuLinkEmulator(const ImuLinkConditions& c);
+
+    // Link state at t; outages start and end here
+    bool up(double t);
+
+    // Sender side. False when the frame was lost or the link is down.
+    bool send(double t, const uint8_t* data, size_t size);
+
+    // fn(t_rx, data, size) for every frame due by t, in delivery order
+    template <class F>
+    size_t deliver(double t, F&& fn) {
+        up(t);
+        size_t n = 0;
+        while (!pending_.empty() && pending_.front().t_rx <= t) {
+            const Pending& p = pending_.front();
+            latency_.record(p.t_rx - p.t_tx);
+            fn(p.t_rx, p.data, size_t(p.size));
+            pending_.pop_front();
+            ++n;
+        }
+        stats_.delivered += n;
+        return n;
+    }
+
+    // Stream time of the next delivery or outage edge, +inf if none
+    double next_change() const;
+
+    // Forget frames in flight (the receiver went away)
+    void drop_pending();
+
+    ImuLinkStats stats() const;
+
+private:
+    struct Pending {
+        double  t_tx;
+        double  t_rx;
+        uint8_t size;
+        uint8_t data[kMaxFrameBytes];
+    };
+
+    ImuLinkConditions c_;
+    std::mt19937_64   rng_;
+    std::uniform_real_distribution<double> unit_{0.0, 1.0};
+
+    std::deque<Pending> pending_;
+    double event_t_  = -std::numeric_limits<double>::infinity();
+    double event_rx_ = 0.0;
+    int    event_fill_ = 0;
+    bool   in_loss_  = false;
+
+    bool   down_       = false;
+    double down_until_ = 0.0;
+    double next_random_down_ = std::numeric_limits<double>::infinity();
+    size_t next_scheduled_   = 0;
+
+    ImuLinkStats        stats_;
+    ImuLatencyHistogram latency_;
+
+    double exponential(double mean);
+    double next_down() const;
+};
+
+// Named condition sets for --emulate: clean, busy (bursty delivery and
+// latency spikes), lossy (loss runs and reordering), flaky (disconnects)
+// and worst (all of them). Only the link fields are touched; false for an
+// unknown name.
+bool imu_link_profile(const std::string& name, ImuLinkConditions& c);
+
+// Frames a unit sends, in order, stamped in stream seconds
+class ImuFrameSource {
+public:
+    virtual ~ImuFrameSource() = default;
+    // False at the end of the stream
+    virtual bool next(ImuRawFrame& f) = 0;
+};
+
+// Quiescent unit on the fixture: accel / gyro alternating at rate_hz
+// frames/s, 1 g on z, a few counts of seeded noise
+class ImuSyntheticSource : public ImuFrameSource {
+public:
+    ImuSyntheticSource(uint64_t seed, double rate_hz);
+    bool next(ImuRawFrame& f) override;
+
+private:
+    std::mt19937_64 rng_;
+    std::normal_distribution<float> noise_{0.0f, 3.0f};
+    double   period_;
+    uint64_t k_ = 0;
+};
+
+// Recorded samples (e.g. from imu_read_capture) at their original spacing
+class ImuReplaySource : public ImuFrameSource {
+public:
+    explicit ImuReplaySource(std::vector<ImuSample> samples);
+    bool next(ImuRawFrame& f) override;
+
+private:
+    std::vector<ImuSample> samples_;
+    size_t i_ = 0;
+};
+
+// A GMSync unit behind ImuLinkEmulator, in real time. It streams from the
+// source while connected and enabled (0x08 accel, 0x0A gyro, 0xF0 stops
+// both), an outage disconnects it and connect() fails until the outage is
+// over. The emulator's decisions follow the seed; which frames fall into
+// a given wall-clock window still depends on thread scheduling.
+class ImuEmulatedLink : public ImuLink {
+public:
+    ImuEmulatedLink(const ImuLinkConditions& c, std::unique_ptr<ImuFrameSource> source);
+    ~ImuEmulatedLink() override;
+
+    void connect() override;
+    void disconnect() override;
+    bool is_connected() override;
+    void subscribe(NotifyFn fn) override;
+    void unsubscribe() override;
+    void write(const std::vector<uint8_t>& bytes) override;
+    void set_on_disconnected(std::function<void()> fn) override;
+    std::string firmware() override { return "emulated"; }
+
+    ImuLinkStats stats() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    ImuLinkEmulator emu_;
+    std::unique_ptr<ImuFrameSource> source_;
+    ImuRawFrame next_{};
+    bool has_next_ = false;
+
+    bool connected_ = false;
+    bool accel_on_  = false;
+    bool gyro_on_   = false;
+    bool stop_      = false;
+    NotifyFn notify_;
+    std::function<void()> on_disconnected_;
+
+    std::chrono::steady_clock::time_point t0_;
+    std::thread thread_;
+
+    double elapsed() const;
+    void run();
+};
@@ -0,0 +1,253 @@
+#include "imu_live_stream.h"
+#include "imu_executor.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+
+namespace {
+
+constexpr uint8_t kVersion     = 1;
+constexpr size_t  kHeaderBytes = 24;
+constexpr size_t  kDeviceBytes = 27;   // fixed part, id excluded
+constexpr auto    kIdleWait = std::chrono::milliseconds(50);
+
+template <typename T>
+inline void put_le(std::string& out, T v) {
+    using U = std::make_unsigned_t<T>;
+    U u = static_cast<U>(v);
+    for (size_t i = 0; i < sizeof(T); ++i) out.push_back(static_cast<char>((u >> (8 * i)) & 0xFF));
+}
+
+inline void put_f32(std::string& out, double v) {
+    const float f = static_cast<float>(v);
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    put_le(out, bits);
+}
+
+inline void put_f64(std::string& out, double v) {
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    put_le(out, bits);
+}
+
+// Rounded half away from zero, without a libm call per channel
+inline int16_t to_counts(float v, double scale) {
+    const float c = std::min(32767.0f, std::max(-32768.0f, v * static_cast<float>(scale)));
+    return static_cast<int16_t>(c + (c < 0.0f ? -0.5f : 0.5f));
+}
+
+} // namespace
+
+ImuLiveStream::ImuLiveStream(const ImuLiveConfig& cfg)
+    : cfg_(cfg), period_s_(1.0 / std::max(cfg.update_hz, 0.1)) {}
+
+ImuLiveStream::~ImuLiveStream() {
+    stop();
+}
+
+bool ImuLiveStream::start() {
+    if (running_) return true;
+    if (!server_.open(cfg_.socket_path, cfg_.tcp_port)) return false;
+    std::cout << "[live] Streaming device state on " << server_.endpoint() << " at "
+              << cfg_.update_hz << " Hz\n";
+    running_ = true;
+    sender_  = std::thread(&ImuLiveStream::send_loop, this);
+    return true;
+}
+
+void ImuLiveStream::stop() {
+    if (!running_) return;
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        running_ = false;
+    }
+    send_cv_.notify_one();
+    if (sender_.joinable()) sender_.join();
+    server_.close();
+    clients_ = 0;
+}
+
+void ImuLiveStream::reset_buckets(Device& d) {
+    std::fill(d.lo.begin(), d.lo.end(), int16_t(32767));
+    std::fill(d.hi.begin(), d.hi.end(), int16_t(-32768));
+    d.frames = 0;
+}
+
+void ImuLiveStream::begin_run(const std::vector<std::string>& ids, double now_s) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    devices_.assign(ids.size(), Device{});
+
+    // Waveform points are what the budget leaves after the fixed fields
+    size_t fixed = kHeaderBytes;
+    for (const auto& id : ids) fixed += kDeviceBytes + std::min<size_t>(id.size(), 255);
+    const double per_update = double(cfg_.budget_bytes_per_s) * period_s_;
+    const double room = ids.empty() ? 0.0 : (per_update - double(fixed)) / double(ids.size() * kPointBytes);
+    points_   = std::max(1, std::min(cfg_.max_points, int(room)));
+    bucket_s_ = period_s_ / points_;
+    update_start_s_ = now_s;
+
+    for (size_t i = 0; i < ids.size(); ++i) {
+        Device& d = devices_[i];
+        d.id = ids[i];
+        d.lo.resize(size_t(points_) * kChannels);
+        d.hi.resize(size_t(points_) * kChannels);
+        reset_buckets(d);
+    }
+}
+
+void ImuLiveStream::end_run() {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    for (auto& d : devices_) d.phase = ImuLivePhase::Done;
+}
+
+void ImuLiveStream::set_phase(size_t slot, ImuLivePhase phase) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    if (slot >= devices_.size()) return;
+    Device& d = devices_[slot];
+    if (phase == ImuLivePhase::Testing && d.phase != ImuLivePhase::Testing) {
+        d.pitch_stats.reset();
+        d.roll_stats.reset();
+        d.pitch_trend.reset();
+        d.roll_trend.reset();
+    }
+    d.phase = phase;
+}
+
+void ImuLiveStream::push(size_t slot, const ImuSample* samples, size_t count) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    if (slot >= devices_.size()) return;
+    Device& d = devices_[slot];
+    d.frames += count;
+    const double inv_bucket = 1.0 / bucket_s_;
+    for (size_t i = 0; i < count; ++i) {
+        const ImuSample& s = samples[i];
+        const int b = std::min(points_ - 1, std::max(0, int((s.timestamp_s - update_start_s_) * inv_bucket)));
+        int16_t c[3];
+        int base;
+        if (s.ax != 0.0f || s.ay != 0.0f || s.az != 0.0f) {   // accel / gyro told apart as elsewhere
+            c[0] = to_counts(s.ax, kAccelCountsPerG);
+            c[1] = to_counts(s.ay, kAccelCountsPerG);
+            c[2] = to_counts(s.az, kAccelCountsPerG);
+            base = 0;
+        } else {
+            c[0] = to_counts(s.gx, kGyroCountsPerDps);
+            c[1] = to_counts(s.gy, kGyroCountsPerDps);
+            c[2] = to_counts(s.gz, kGyroCountsPerDps);
+            base = 3;
+        }
+        int16_t* lo = d.lo.data() + size_t(b) * kChannels + base;
+        int16_t* hi = d.hi.data() + size_t(b) * kChannels + base;
+        for (int k = 0; k < 3; ++k) {
+            lo[k] = std::min(lo[k], c[k]);
+            hi[k] = std::max(hi[k], c[k]);
+        }
+    }
+}
+
+void ImuLiveStream::tilt(size_t slot, double t_s, double pitch_deg, double roll_deg) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    if (slot >= devices_.size()) return;
+    Device& d = devices_[slot];
+    d.has_tilt = true;
+    d.pitch    = pitch_deg;
+    d.roll     = roll_deg;
+    if (d.phase != ImuLivePhase::Testing) return;
+    d.pitch_stats.push(pitch_deg);
+    d.roll_stats.push(roll_deg);
+    d.pitch_trend.push(t_s, pitch_deg);
+    d.roll_trend.push(t_s, roll_deg);
+}
+
+void ImuLiveStream::set_buffered(size_t slot, size_t frames) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    if (slot < devices_.size()) devices_[slot].buffered = frames;
+}
+
+size_t ImuLiveStream::format(std::string& out, double now_s) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    const size_t start = out.size();
+    const double elapsed = std::max(now_s - update_start_s_, 1e-6);
+
+    out += "ILV";
+    out.push_back(static_cast<char>(kVersion));
+    put_le(out, uint32_t(0));   // frame_bytes, patched below
+    put_f64(out, now_s);
+    put_f32(out, period_s_);
+    put_le(out, uint16_t(devices_.size()));
+    put_le(out, uint16_t(points_));
+
+    for (auto& d : devices_) {
+        const size_t id_len = std::min<size_t>(d.id.size(), 255);
+        out.push_back(static_cast<char>(id_len));
+        out.append(d.id, 0, id_len);
+        out.push_back(static_cast<char>(d.phase));
+        out.push_back(static_cast<char>(d.has_tilt ? 1 : 0));
+        put_f32(out, double(d.frames) / elapsed);
+        put_le(out, uint32_t(std::min<size_t>(d.buffered, 0xFFFFFFFFu)));
+        put_f32(out, d.pitch);
+        put_f32(out, d.roll);
+        put_f32(out, std::max(d.pitch_stats.sigma(), d.roll_stats.sigma()));
+        put_f32(out, 60.0 * std::max(std::fabs(d.pitch_trend.slope()), std::fabs(d.roll_trend.slope())));
+        for (int p = 0; p < points_; ++p) {
+            for (int k = 0; k < kChannels; ++k) put_le(out, d.lo[size_t(p) * kChannels + size_t(k)]);
+            for (int k = 0; k < kChannels; ++k) put_le(out, d.hi[size_t(p) * kChannels + size_t(k)]);
+        }
+        reset_buckets(d);
+    }
+    update_start_s_ = now_s;
+
+    const uint32_t bytes = uint32_t(out.size() - start);
+    for (size_t i = 0; i < 4; ++i) out[start + 4 + i] = static_cast<char>((bytes >> (8 * i)) & 0xFF);
+    return bytes;
+}
+
+void ImuLiveStream::tick(double now_s) {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        if (now_s - update_start_s_ < period_s_) return;
+        if (clients() == 0 || !running_) {
+            // Nobody watching: keep the buckets current, format nothing
+            for (auto& d : devices_) reset_buckets(d);
+            update_start_s_ = now_s;
+            return;
+        }
+    }
+    scratch_.clear();
+    format(scratch_, now_s);
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        if (has_pending_) replaced_.fetch_add(1, std::memory_order_relaxed);
+        pending_.swap(scratch_);
+        has_pending_ = true;
+    }
+    send_cv_.notify_one();
+}
+
+void ImuLiveStream::send_loop() {
+    imu_apply_thread_placement(placement_, "imu-live");
+    std::string frame;
+    while (running_) {
+        bool have = false;
+        {
+            std::unique_lock<std::mutex> lock(send_mutex_);
+            send_cv_.wait_for(lock, kIdleWait, [this] { return has_pending_ || !running_; });
+            if (has_pending_) {
+                frame.swap(pending_);
+                has_pending_ = false;
+                have = true;
+            }
+        }
+        if (server_.poll_accept() > 0) {
+            std::cout << "[live] Dashboard connected (" << server_.client_count() << ")\n";
+        }
+        if (have && server_.client_count() > 0) {
+            server_.broadcast(frame.data(), frame.size());
+            sent_.fetch_add(1, std::memory_order_relaxed);
+        }
+        clients_ = server_.client_count();
+    }
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "imu_local_socket.h"
+#include "imu_stream_stats.h"
+#include "imu_types.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class ImuLivePhase : uint8_t {
+    Idle,
+    Settling,
+    Testing,
+    Done
+};
+
+// Per-device live state of the run in progress for dashboards, sent
+// update_hz times a second on a local socket (see ImuLocalServer).
+//
+// The analysis thread folds samples into per-device min/max buckets as it
+// drains them; tick() turns the buckets into one binary frame per update
+// and hands it to the sender thread, which owns the socket. Only the
+// newest frame waits there: when clients are slow, older frames are
+// replaced, never queued. Nothing is formatted while no client is
+// connected.
+//
+// Waveform points per device follow from budget_bytes_per_s, update_hz and
+// the device count, so the stream rate stays fixed however many units are
+// on the fixture.
+//
+// Frame (little endian):
+//   "ILV" u8 version  u32 frame_bytes  f64 t_s  f32 period_s
+//   u16 devices  u16 points, then per device
+//     u8 id_len id[id_len]  u8 phase (ImuLivePhase)  u8 flags (bit 0: tilt valid)
+//     f32 rate_hz  u32 buffered  f32 pitch_deg  f32 roll_deg
+//     f32 sigma_deg  f32 drift_deg_per_min
+//     points x (i16 min[6]  i16 max[6])   ax ay az gx gy gz in device counts
+//                                         (2048 / g, 57.142 / dps)
+// A bucket without samples has min 32767 and max -32768. t_s is the
+// steady-clock time of the update (same base as sample timestamps); sigma
+// and drift are the worse of pitch and roll since the unit's window opened.
+class ImuLiveStream {
+public:
+    static constexpr int kChannels = 6;
+    static constexpr size_t kPointBytes = 2 * kChannels * sizeof(int16_t);
+
+    explicit ImuLiveStream(const ImuLiveConfig& cfg = ImuLiveConfig{});
+    ~ImuLiveStream();
+
+    ImuLiveStream(const ImuLiveStream&) = delete;
+    ImuLiveStream& operator=(const ImuLiveStream&) = delete;
+
+    // Core / priority of the sender (call before start)
+    void set_thread_placement(const ImuThreadPlacement& p) { placement_ = p; }
+
+    bool start();
+    void stop();
+
+    // Devices of a new run, slot = index; all start Settling
+    void begin_run(const std::vector<std::string>& ids, double now_s);
+    void end_run();
+
+    void set_phase(size_t slot, ImuLivePhase phase);
+    void push(size_t slot, const ImuSample* samples, size_t count);
+    void tilt(size_t slot, double t_s, double pitch_deg, double roll_deg);
+    void set_buffered(size_t slot, size_t frames);
+
+    // Sends an update when one is due; cheap otherwise
+    void tick(double now_s);
+
+    // The update frame for now_s, appended to out; restarts the buckets
+    size_t format(std::string& out, double now_s);
+
+    int    points() const { return points_; }
+    size_t clients() const { return clients_.load(std::memory_order_relaxed); }
+    uint64_t frames_sent() const     { return sent_.load(std::memory_order_relaxed); }
+    uint64_t frames_replaced() const { return replaced_.load(std::memory_order_relaxed); }
+
+private:
+    struct Device {
+        std::string  id;
+        ImuLivePhase phase = ImuLivePhase::Settling;
+        uint64_t     frames = 0;     // since the last update
+        size_t       buffered = 0;
+        bool         has_tilt = false;
+        double       pitch = 0.0, roll = 0.0;
+        ImuRunningStats pitch_stats, roll_stats;
+        ImuLinearTrend  pitch_trend, roll_trend;
+        std::vector<int16_t> lo, hi;   // points x kChannels
+    };
+
+    ImuLiveConfig      cfg_;
+    ImuThreadPlacement placement_;
+    double             period_s_;
+
+    // Analysis side
+    std::mutex          state_mutex_;
+    std::vector<Device> devices_;
+    int                 points_ = 1;
+    double              bucket_s_ = 0.0;
+    double              update_start_s_ = 0.0;
+    std::string         scratch_;
+
+    // Sender side
+    std::atomic<bool> running_{false};
+    std::thread       sender_;
+    std::mutex        send_mutex_;
+    std::condition_variable send_cv_;
+    std::string       pending_;
+    bool              has_pending_ = false;
+    ImuLocalServer    server_;   // sender thread only once started
+    std::atomic<size_t>   clients_{0};
+    std::atomic<uint64_t> sent_{0};
+    std::atomic<uint64_t> replaced_{0};
+
+    void reset_buckets(Device& d);
+    void send_loop();
+};
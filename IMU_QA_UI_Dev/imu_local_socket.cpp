@@ -0,0 +1,201 @@
+#include "imu_local_socket.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+using native_socket = SOCKET;
+inline native_socket as_native(intptr_t fd) { return static_cast<native_socket>(fd); }
+inline void close_socket(intptr_t fd) { closesocket(as_native(fd)); }
+inline bool set_nonblocking(native_socket s) {
+    u_long on = 1;
+    return ioctlsocket(s, FIONBIO, &on) == 0;
+}
+
+// WSAStartup once per process
+bool init_sockets() {
+    static const bool ok = [] {
+        WSADATA wsa;
+        return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+    }();
+    return ok;
+}
+#else
+using native_socket = int;
+inline native_socket as_native(intptr_t fd) { return static_cast<native_socket>(fd); }
+inline void close_socket(intptr_t fd) { ::close(as_native(fd)); }
+inline bool set_nonblocking(native_socket s) {
+    int flags = fcntl(s, F_GETFL, 0);
+    return flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+bool init_sockets() { return true; }
+#endif
+
+} // namespace
+
+ImuLocalServer::~ImuLocalServer() {
+    close();
+}
+
+bool ImuLocalServer::open(const std::string& path, uint16_t tcp_port) {
+    if (is_open()) return true;
+    if (!init_sockets()) {
+        std::cerr << "[socket] Socket library init failed\n";
+        return false;
+    }
+
+#ifdef _WIN32
+    (void)path;
+    native_socket s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == INVALID_SOCKET) {
+        std::cerr << "[socket] socket() failed\n";
+        return false;
+    }
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(tcp_port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(s, 8) != 0 || !set_nonblocking(s)) {
+        std::cerr << "[socket] Cannot listen on 127.0.0.1:" << tcp_port << "\n";
+        closesocket(s);
+        return false;
+    }
+    endpoint_ = "tcp://127.0.0.1:" + std::to_string(tcp_port);
+#else
+    (void)tcp_port;
+    sockaddr_un addr{};
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "[socket] Invalid socket path '" << path << "'\n";
+        return false;
+    }
+    native_socket s = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s < 0) {
+        std::cerr << "[socket] socket() failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    struct stat st{};
+    if (::lstat(path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            std::cerr << "[socket] " << path << " exists and is not a socket\n";
+            ::close(s);
+            return false;
+        }
+        // Another station process may still listen there: leave it be.
+        // A full backlog (EAGAIN) counts as listening too.
+        native_socket probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        bool in_use = false;
+        if (probe >= 0 && set_nonblocking(probe)) {
+            in_use = connect(probe, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 ||
+                     errno == EAGAIN || errno == EINPROGRESS;
+        }
+        if (probe >= 0) ::close(probe);
+        if (in_use) {
+            std::cerr << "[socket] " << path << " is in use by another process\n";
+            ::close(s);
+            return false;
+        }
+        ::unlink(path.c_str());   // stale socket from a previous run
+    }
+    if (bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(s, 8) != 0 || !set_nonblocking(s)) {
+        std::cerr << "[socket] Cannot listen on " << path << ": " << std::strerror(errno) << "\n";
+        ::close(s);
+        return false;
+    }
+    unix_path_ = path;
+    endpoint_  = "unix://" + path;
+#endif
+
+    listen_fd_ = static_cast<intptr_t>(s);
+    return true;
+}
+
+void ImuLocalServer::close() {
+    for (intptr_t c : clients_) close_socket(c);
+    clients_.clear();
+    if (listen_fd_ >= 0) {
+        close_socket(listen_fd_);
+        listen_fd_ = -1;
+    }
+#ifndef _WIN32
+    if (!unix_path_.empty()) {
+        ::unlink(unix_path_.c_str());
+        unix_path_.clear();
+    }
+#endif
+}
+
+int ImuLocalServer::poll_accept() {
+    if (!is_open()) return 0;
+    int added = 0;
+    for (;;) {
+        native_socket c = accept(as_native(listen_fd_), nullptr, nullptr);
+#ifdef _WIN32
+        if (c == INVALID_SOCKET) break;
+#else
+        if (c < 0) break;
+#endif
+#ifdef SO_NOSIGPIPE
+        int one = 1;
+        setsockopt(c, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));   // macOS
+#endif
+        if (!set_nonblocking(c)) {
+            close_socket(static_cast<intptr_t>(c));
+            continue;
+        }
+        clients_.push_back(static_cast<intptr_t>(c));
+        ++added;
+    }
+    return added;
+}
+
+size_t ImuLocalServer::broadcast(const char* data, size_t len) {
+    size_t delivered = 0;
+    for (auto it = clients_.begin(); it != clients_.end();) {
+        size_t sent = 0;
+        bool   ok   = true;
+        while (sent < len) {
+#ifdef _WIN32
+            int n = send(as_native(*it), data + sent, static_cast<int>(len - sent), 0);
+#elif defined(MSG_NOSIGNAL)
+            ssize_t n = send(as_native(*it), data + sent, len - sent, MSG_NOSIGNAL);
+#else
+            ssize_t n = send(as_native(*it), data + sent, len - sent, 0);
+#endif
+            if (n > 0) {
+                sent += static_cast<size_t>(n);
+                continue;
+            }
+            // Error, or a full socket buffer: waiting would stall the
+            // sender and a partial write would tear the line, so drop it
+            ok = false;
+            break;
+        }
+        if (ok) {
+            ++delivered;
+            ++it;
+        } else {
+            close_socket(*it);
+            it = clients_.erase(it);
+        }
+    }
+    return delivered;
+}
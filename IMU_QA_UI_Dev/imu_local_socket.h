@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Local stream server for other processes on the station. A Unix domain
+// socket at `path` on Linux / macOS, TCP on 127.0.0.1:`tcp_port` on Windows.
+// A socket left at `path` by a process that is gone is replaced; one that
+// still has a listener is not, and open() fails.
+//
+// Single threaded and non-blocking: the owner calls poll_accept() and
+// broadcast() from one thread. A client that cannot keep up (send would
+// block) is disconnected rather than allowed to stall the sender.
+class ImuLocalServer {
+public:
+    ImuLocalServer() = default;
+    ~ImuLocalServer();
+
+    ImuLocalServer(const ImuLocalServer&) = delete;
+    ImuLocalServer& operator=(const ImuLocalServer&) = delete;
+
+    bool open(const std::string& path, uint16_t tcp_port);
+    void close();
+    bool is_open() const { return listen_fd_ >= 0; }
+
+    // Accept pending connections; returns the number of new clients
+    int poll_accept();
+
+    // Send to every client; returns how many received the whole buffer
+    size_t broadcast(const char* data, size_t len);
+
+    size_t client_count() const { return clients_.size(); }
+    const std::string& endpoint() const { return endpoint_; }
+
+private:
+    // Socket handles are stored as intptr_t so SOCKET fits on Windows
+    intptr_t listen_fd_ = -1;
+    std::vector<intptr_t> clients_;
+    std::string endpoint_;
+    std::string unix_path_;   // unlinked on close
+};
@@ -0,0 +1,210 @@
+#include "imu_orientation.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr float kDegToRad = 3.14159265358979323846f / 180.0f;
+constexpr float kRadToDeg = 180.0f / 3.14159265358979323846f;
+
+inline size_t padded(size_t n) { return (n + 7) & ~size_t(7); }
+
+// One Mahony step per lane. A free function with restrict arguments so the
+// compiler can prove the arrays do not alias and vectorise the loop.
+void mahony_step(size_t n, const float* __restrict dts, float kp, float ki, float gate,
+                 float* __restrict q0, float* __restrict q1,
+                 float* __restrict q2, float* __restrict q3,
+                 float* __restrict ix, float* __restrict iy, float* __restrict iz,
+                 const float* __restrict ax, const float* __restrict ay,
+                 const float* __restrict az,
+                 const float* __restrict gx, const float* __restrict gy,
+                 const float* __restrict gz) {
+    for (size_t i = 0; i < n; ++i) {
+        const float dt = dts[i];
+        float a0 = ax[i], a1 = ay[i], a2 = az[i];
+        float w0 = gx[i], w1 = gy[i], w2 = gz[i];
+        float s0 = q0[i], s1 = q1[i], s2 = q2[i], s3 = q3[i];
+
+        // Accel correction only near 1 g (mask instead of a branch)
+        const float an  = std::sqrt(a0 * a0 + a1 * a1 + a2 * a2);
+        const float use = (std::fabs(an - 1.0f) < gate) ? 1.0f : 0.0f;
+        const float inv = use / (an + (1.0f - use));
+        a0 *= inv;
+        a1 *= inv;
+        a2 *= inv;
+
+        // Gravity direction predicted by q, error = a x v
+        const float vx = 2.0f * (s1 * s3 - s0 * s2);
+        const float vy = 2.0f * (s0 * s1 + s2 * s3);
+        const float vz = s0 * s0 - s1 * s1 - s2 * s2 + s3 * s3;
+        const float ex = a1 * vz - a2 * vy;
+        const float ey = a2 * vx - a0 * vz;
+        const float ez = a0 * vy - a1 * vx;
+
+        const float kdt = ki * dt;
+        const float jx = ix[i] + kdt * ex;
+        const float jy = iy[i] + kdt * ey;
+        const float jz = iz[i] + kdt * ez;
+        ix[i] = jx;
+        iy[i] = jy;
+        iz[i] = jz;
+
+        w0 += kp * ex + jx;
+        w1 += kp * ey + jy;
+        w2 += kp * ez + jz;
+
+        // q += 0.5 * q (x) w * dt
+        const float h = 0.5f * dt;
+        w0 *= h;
+        w1 *= h;
+        w2 *= h;
+        const float r0 = s0 - s1 * w0 - s2 * w1 - s3 * w2;
+        const float r1 = s1 + s0 * w0 + s2 * w2 - s3 * w1;
+        const float r2 = s2 + s0 * w1 - s1 * w2 + s3 * w0;
+        const float r3 = s3 + s0 * w2 + s1 * w1 - s2 * w0;
+
+        const float qn = 1.0f / std::sqrt(r0 * r0 + r1 * r1 + r2 * r2 + r3 * r3);
+        q0[i] = r0 * qn;
+        q1[i] = r1 * qn;
+        q2[i] = r2 * qn;
+        q3[i] = r3 * qn;
+    }
+}
+
+} // namespace
+
+ImuOrientationBank::ImuOrientationBank(size_t capacity, const ImuOrientationConfig& cfg)
+    : cfg_(cfg), capacity_(capacity) {
+    const size_t n = padded(capacity);
+    for (auto* v : {&q1_, &q2_, &q3_, &ix_, &iy_, &iz_, &ax_, &ay_, &az_, &gx_, &gy_, &gz_}) {
+        v->assign(n, 0.0f);
+    }
+    q0_.assign(n, 1.0f);
+}
+
+int ImuOrientationBank::add_device() {
+    if (count_ >= capacity_) return -1;
+    reset(count_);
+    return static_cast<int>(count_++);
+}
+
+void ImuOrientationBank::reset(size_t slot) {
+    q0_[slot] = 1.0f;
+    q1_[slot] = q2_[slot] = q3_[slot] = 0.0f;
+    ix_[slot] = iy_[slot] = iz_[slot] = 0.0f;
+    ax_[slot] = ay_[slot] = az_[slot] = 0.0f;
+    gx_[slot] = gy_[slot] = gz_[slot] = 0.0f;
+}
+
+void ImuOrientationBank::level(size_t slot, float ax, float ay, float az) {
+    if (ax == 0.0f && ay == 0.0f && az == 0.0f) return;
+    const float roll  = std::atan2(ay, az);
+    const float pitch = std::atan2(-ax, std::sqrt(ay * ay + az * az));
+    const float cr = std::cos(roll * 0.5f), sr = std::sin(roll * 0.5f);
+    const float cp = std::cos(pitch * 0.5f), sp = std::sin(pitch * 0.5f);
+    q0_[slot] = cr * cp;
+    q1_[slot] = sr * cp;
+    q2_[slot] = cr * sp;
+    q3_[slot] = -sr * sp;
+}
+
+void ImuOrientationBank::set_accel(size_t slot, float ax, float ay, float az) {
+    ax_[slot] = ax;
+    ay_[slot] = ay;
+    az_[slot] = az;
+}
+
+void ImuOrientationBank::set_gyro(size_t slot, float gx, float gy, float gz) {
+    gx_[slot] = gx * kDegToRad;
+    gy_[slot] = gy * kDegToRad;
+    gz_[slot] = gz * kDegToRad;
+}
+
+void ImuOrientationBank::update(const float* dt_s) {
+    mahony_step(count_, dt_s, cfg_.kp, cfg_.ki, cfg_.accel_gate_g,
+                q0_.data(), q1_.data(), q2_.data(), q3_.data(),
+                ix_.data(), iy_.data(), iz_.data(),
+                ax_.data(), ay_.data(), az_.data(),
+                gx_.data(), gy_.data(), gz_.data());
+}
+
+void ImuOrientationBank::quaternion(size_t slot, float q[4]) const {
+    q[0] = q0_[slot];
+    q[1] = q1_[slot];
+    q[2] = q2_[slot];
+    q[3] = q3_[slot];
+}
+
+float ImuOrientationBank::roll_deg(size_t slot) const {
+    const float a = q0_[slot], b = q1_[slot], c = q2_[slot], d = q3_[slot];
+    return std::atan2(2.0f * (a * b + c * d), 1.0f - 2.0f * (b * b + c * c)) * kRadToDeg;
+}
+
+float ImuOrientationBank::pitch_deg(size_t slot) const {
+    const float a = q0_[slot], b = q1_[slot], c = q2_[slot], d = q3_[slot];
+    return std::asin(std::clamp(2.0f * (a * c - d * b), -1.0f, 1.0f)) * kRadToDeg;
+}
+
+float ImuOrientationBank::yaw_deg(size_t slot) const {
+    const float a = q0_[slot], b = q1_[slot], c = q2_[slot], d = q3_[slot];
+    return std::atan2(2.0f * (a * d + b * c), 1.0f - 2.0f * (c * c + d * d)) * kRadToDeg;
+}
+
+void ImuOrientationBank::gyro_bias_dps(size_t slot, float b[3]) const {
+    b[0] = -ix_[slot] * kRadToDeg;
+    b[1] = -iy_[slot] * kRadToDeg;
+    b[2] = -iz_[slot] * kRadToDeg;
+}
+
+// ---- ImuOrientationTracker -------------------------------------------------
+
+ImuOrientationTracker::ImuOrientationTracker(const ImuOrientationConfig& cfg, size_t capacity)
+    : bank_(capacity, cfg) {
+    last_t_.reserve(capacity);
+    pos_.reserve(capacity);
+    dt_.assign(bank_.capacity() + 8, 0.0f);
+}
+
+int ImuOrientationTracker::add_device() {
+    int slot = bank_.add_device();
+    if (slot >= 0) {
+        last_t_.push_back(0.0);
+        pos_.push_back(0);
+    }
+    return slot;
+}
+
+void ImuOrientationTracker::reset() {
+    for (size_t i = 0; i < bank_.size(); ++i) {
+        bank_.reset(i);
+        last_t_[i] = 0.0;
+    }
+}
+
+void ImuOrientationTracker::process(const ImuSample* const* chunks, const size_t* counts,
+                                    size_t devices) {
+    devices = std::min(devices, bank_.size());
+    std::fill(pos_.begin(), pos_.end(), 0);
+
+    for (;;) {
+        bool any = false;
+        for (size_t d = 0; d < devices; ++d) {
+            dt_[d] = 0.0f;
+            // Apply accel frames up to and including the next gyro frame
+            while (pos_[d] < counts[d]) {
+                const ImuSample& s = chunks[d][pos_[d]++];
+                if (s.ax != 0.0f || s.ay != 0.0f || s.az != 0.0f) {
+                    bank_.set_accel(d, s.ax, s.ay, s.az);
+                    continue;
+                }
+                bank_.set_gyro(d, s.gx, s.gy, s.gz);
+                if (last_t_[d] > 0.0) dt_[d] = static_cast<float>(s.timestamp_s - last_t_[d]);
+                last_t_[d] = s.timestamp_s;
+                any = true;
+                break;
+            }
+        }
+        if (!any) break;
+        bank_.update(dt_.data());
+    }
+}
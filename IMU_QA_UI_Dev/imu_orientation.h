@@ -0,0 +1,78 @@
+#pragma once
+#include "imu_types.h"
+#include <cstddef>
+#include <vector>
+
+// Mahony quaternion attitude filters for many devices, stored as
+// struct-of-arrays so one update() steps every device in a single loop the
+// compiler can vectorise (no per-device branches).
+//
+// Per device: quaternion q (body -> world), integral feedback that converges
+// to minus the gyro bias, and the latest accel / gyro inputs. Accel frames
+// arrive separately from gyro frames, so set_accel() only stores the vector;
+// it is applied at the next update() as long as |a| is close to 1 g. Yaw
+// has no absolute reference and drifts with the residual z bias.
+class ImuOrientationBank {
+public:
+    explicit ImuOrientationBank(size_t capacity = 16,
+                                const ImuOrientationConfig& cfg = ImuOrientationConfig{});
+
+    // Slot index of a new device at identity attitude; -1 when full
+    int  add_device();
+    void reset(size_t slot);
+    // Roll / pitch from a gravity vector (g, body frame), yaw 0, so the
+    // filter starts converged instead of from identity
+    void level(size_t slot, float ax, float ay, float az);
+    size_t size() const     { return count_; }
+    size_t capacity() const { return capacity_; }
+
+    // Inputs in g and deg/s
+    void set_accel(size_t slot, float ax, float ay, float az);
+    void set_gyro(size_t slot, float gx, float gy, float gz);
+
+    // One step for all devices; dt_s[i] = time since device i's last step
+    // (0 leaves it unchanged)
+    void update(const float* dt_s);
+
+    // Attitude and bias of one device
+    void  quaternion(size_t slot, float q[4]) const;
+    float roll_deg(size_t slot) const;
+    float pitch_deg(size_t slot) const;
+    float yaw_deg(size_t slot) const;
+    void  gyro_bias_dps(size_t slot, float b[3]) const;
+
+private:
+    ImuOrientationConfig cfg_;
+    size_t capacity_ = 0;
+    size_t count_    = 0;
+
+    // One array per component, padded to a multiple of 8 lanes
+    std::vector<float> q0_, q1_, q2_, q3_;
+    std::vector<float> ix_, iy_, iz_;    // integral feedback, rad/s
+    std::vector<float> ax_, ay_, az_;    // latest accel, g
+    std::vector<float> gx_, gy_, gz_;    // latest gyro, rad/s
+};
+
+// Feeds interleaved per-device frame chunks into an ImuOrientationBank in
+// lockstep: round k steps every device with its k-th gyro frame, after
+// applying the accel frames that preceded it.
+class ImuOrientationTracker {
+public:
+    explicit ImuOrientationTracker(const ImuOrientationConfig& cfg = ImuOrientationConfig{},
+                                   size_t capacity = 16);
+
+    int add_device();   // slot, matches the order chunks are passed in
+
+    // chunks[i] / counts[i]: new frames of device i (may be empty)
+    void process(const ImuSample* const* chunks, const size_t* counts, size_t devices);
+
+    const ImuOrientationBank& bank() const { return bank_; }
+    void level(size_t slot, const float gravity_g[3]) { bank_.level(slot, gravity_g[0], gravity_g[1], gravity_g[2]); }
+    void reset();
+
+private:
+    ImuOrientationBank  bank_;
+    std::vector<double> last_t_;   // last gyro frame per device, 0 = none yet
+    std::vector<size_t> pos_;      // scratch cursors
+    std::vector<float>  dt_;       // scratch
+};
@@ -0,0 +1,79 @@
+#include "imu_pipeline.h"
+#include <algorithm>
+#include <cstdio>
+
+// Never grows batches_, so an entry stays put while another is written
+ImuThroughputMeter::Batch* ImuThroughputMeter::at(int batch) {
+    if (batch < 0 || batch >= (int)batches_.size()) return nullptr;
+    return &batches_[size_t(batch)];
+}
+
+void ImuThroughputMeter::add_connect(int batch, double seconds) {
+    if (Batch* b = at(batch)) b->connect_s += seconds;
+}
+
+void ImuThroughputMeter::tested(int batch, int devices, double start_s, double end_s) {
+    Batch* b = at(batch);
+    if (!b) return;
+    b->devices      = devices;
+    b->test_start_s = start_s;
+    b->test_end_s   = end_s;
+}
+
+int ImuThroughputMeter::devices() const {
+    int n = 0;
+    for (const auto& b : batches_) n += b.devices;
+    return n;
+}
+
+double ImuThroughputMeter::devices_per_hour(double now_s) const {
+    const double elapsed = now_s - start_s_;
+    return elapsed > 0.0 ? devices() * 3600.0 / elapsed : 0.0;
+}
+
+double ImuThroughputMeter::sequential_devices_per_hour() const {
+    double total = 0.0;
+    for (const auto& b : batches_) total += b.connect_s + (b.test_end_s - b.test_start_s);
+    return total > 0.0 ? devices() * 3600.0 / total : 0.0;
+}
+
+double ImuThroughputMeter::stall_seconds() const {
+    double stall = 0.0;
+    double prev  = start_s_;
+    for (const auto& b : batches_) {
+        if (b.test_end_s <= 0.0) break;   // not tested (yet)
+        stall += std::max(0.0, b.test_start_s - prev);
+        prev = b.test_end_s;
+    }
+    return stall;
+}
+
+void ImuThroughputMeter::print_batch(std::ostream& os, int batch, double now_s) const {
+    if (batch < 0 || batch >= (int)batches_.size()) return;
+    const auto& b    = batches_[size_t(batch)];
+    const double prev = batch == 0 ? start_s_ : batches_[size_t(batch) - 1].test_end_s;
+    char line[192];
+    std::snprintf(line, sizeof(line),
+                  "[pipeline] batch %d: %d unit(s), test %.1f s, waited %.1f s before it, %.0f devices/h so far\n",
+                  batch + 1, b.devices, b.test_end_s - b.test_start_s,
+                  std::max(0.0, b.test_start_s - prev), devices_per_hour(now_s));
+    os << line;
+}
+
+void ImuThroughputMeter::print(std::ostream& os, double now_s) const {
+    double connect = 0.0;
+    int tested = 0;
+    for (const auto& b : batches_) {
+        connect += b.connect_s;
+        if (b.test_end_s > 0.0) ++tested;
+    }
+    const double stall = stall_seconds();
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "[pipeline] %d unit(s) in %d batch(es), %.1f min: %.0f devices/h "
+                  "(%.0f devices/h connecting and testing in turn)\n"
+                  "[pipeline] connect %.1f s, %.1f s of it behind tests; %.1f s with no test running\n",
+                  devices(), tested, (now_s - start_s_) / 60.0, devices_per_hour(now_s),
+                  sequential_devices_per_hour(), connect, std::max(0.0, connect - stall), stall);
+    os << line;
+}
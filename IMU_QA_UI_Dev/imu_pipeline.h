@@ -0,0 +1,52 @@
+#pragma once
+#include <ostream>
+#include <vector>
+
+// Two fixtures used in turn: while batch N is in its test window on one,
+// batch N+1 is scanned and connected on the other, so the adapter is not
+// idle during tests and the next test starts as soon as the last one ends.
+struct ImuPipelineConfig {
+    int batches    = 0;    // 0 = no pipeline, one batch per operator prompt
+    int batch_size = 10;   // units per fixture
+
+    // Links the adapter holds at once. With fewer than two batches' worth,
+    // the next batch connects what fits during the test and the rest once
+    // the tested batch has been released.
+    int max_connections = 20;
+};
+
+// Where the time of a pipelined run went. Times are steady-clock seconds.
+// Sized for every batch up front: the connect of batch N+1 and the test of
+// batch N are recorded from different threads, into different entries.
+class ImuThroughputMeter {
+public:
+    ImuThroughputMeter(double start_s, int batches)
+        : start_s_(start_s), batches_(size_t(batches > 0 ? batches : 0)) {}
+
+    // Scan and connect time spent on batch b, in one or more calls
+    void add_connect(int batch, double seconds);
+    void tested(int batch, int devices, double start_s, double end_s);
+
+    int    devices() const;
+    double devices_per_hour(double now_s) const;
+    // Same batches with connect and test one after the other
+    double sequential_devices_per_hour() const;
+    // Time before each test with no test running, the first connect included
+    double stall_seconds() const;
+
+    void print_batch(std::ostream& os, int batch, double now_s) const;
+    void print(std::ostream& os, double now_s) const;
+
+private:
+    struct Batch {
+        int    devices      = 0;
+        double connect_s    = 0.0;
+        double test_start_s = 0.0;
+        double test_end_s   = 0.0;
+    };
+
+    double start_s_;
+    std::vector<Batch> batches_;
+
+    Batch* at(int batch);
+};
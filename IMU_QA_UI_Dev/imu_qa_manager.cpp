@@ -1,68 +1,346 @@
 #include "imu_qa_manager.h"
+#include "imu_ble_link.h"
+#include "imu_link_emulator.h"
+#include "imu_capture_file.h"
+#include "imu_settle.h"
 #include <chrono>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <thread>
 #include <cmath>
 #include <algorithm>
+#include <ctime>
+#include <iomanip>
+#include <cstdio>
+#include <limits>
+#include <unordered_map>
 
-ImuQaManager::ImuQaManager(const ImuQaConfig& cfg) : cfg_(cfg) {}
+template <typename TimePoint>
+static double to_seconds(TimePoint t) {
+    return std::chrono::duration<double>(t.time_since_epoch()).count();
+}
 
-bool ImuQaManager::discover_and_connect(int max_devices) {
-    auto adapters = SimpleBLE::Adapter::get_adapters();
-    if (adapters.empty()) {
-        std::cerr << "No BLE adapters found.\n";
-        return false;
+// One line per shot string: mean ± sigma of the recoil metrics
+static void print_shot_strings(const std::vector<ImuShotMetrics>& metrics) {
+    std::vector<ImuShotStringStats> strings;
+    for (const auto& m : metrics) {
+        if (strings.empty() || strings.back().string_index != m.string_index) {
+            strings.emplace_back();
+        }
+        strings.back().push(m);
+    }
+    for (const auto& st : strings) {
+        std::printf("String %d: %d shots  rise %.2f±%.2f°  RTZ %.0f±%.0f ms  "
+                    "lateral %.2f±%.2f°  dv %.3f±%.3f m/s",
+                    st.string_index, st.shots, st.rise.mean, st.rise.sigma(),
+                    st.rtz.mean * 1000.0, st.rtz.sigma() * 1000.0,
+                    st.lateral.mean, st.lateral.sigma(), st.impulse.mean, st.impulse.sigma());
+        if (st.split.n > 0) std::printf("  split %.3f±%.3f s", st.split.mean, st.split.sigma());
+        std::printf("\n");
     }
+}
 
-    SimpleBLE::Adapter& adapter = adapters[0];
-    std::cout << "Using adapter: " << adapter.identifier()
-              << " (" << adapter.address() << ")\n";
+// MACs compare case-insensitively
+static bool same_address(std::string a, std::string b) {
+    std::transform(a.begin(), a.end(), a.begin(), ::tolower);
+    std::transform(b.begin(), b.end(), b.begin(), ::tolower);
+    return a == b;
+}
+
+// Gaps intersected with [t0, t1]
+static std::vector<ImuGap> clip_gaps(const std::vector<ImuGap>& gaps, double t0, double t1) {
+    std::vector<ImuGap> out;
+    for (auto g : gaps) {
+        g.start_s = std::max(g.start_s, t0);
+        g.end_s   = std::min(g.end_s, t1);
+        if (g.end_s > g.start_s) out.push_back(g);
+    }
+    return out;
+}
+
+static double gap_seconds_in(const std::vector<ImuGap>& gaps, double t0, double t1) {
+    double total = 0.0;
+    for (const auto& g : clip_gaps(gaps, t0, t1)) total += g.end_s - g.start_s;
+    return total;
+}
+
+// What a unit's settle gave, at the start of its window
+static void print_settle(const std::string& id, const ImuSettleEstimate& e, double settle_s) {
+    if (e.valid) {
+        std::printf("[%s] settle %.1fs: gyro bias (%.3f, %.3f, %.3f) °/s, gravity (%.3f, %.3f, %.3f) g\n",
+                    id.c_str(), settle_s, e.gyro_bias_dps[0], e.gyro_bias_dps[1], e.gyro_bias_dps[2],
+                    e.gravity_g[0], e.gravity_g[1], e.gravity_g[2]);
+    } else {
+        std::printf("[%s] ⚠️  settle %.1fs: no estimate (%zu accel / %zu gyro frames, gyro σ %.3f °/s)\n",
+                    id.c_str(), settle_s, e.accel_frames, e.gyro_frames, e.gyro_sigma_dps);
+    }
+}
 
+ImuQaManager::ImuQaManager(const ImuQaConfig& cfg)
+    : cfg_(cfg), station_budget_(cfg.buffers.station_budget_bytes), events_(cfg.events),
+      live_(cfg.live), evaluator_(cfg),
+      decode_exec_("decode", cfg.executors.decode),
+      analysis_exec_("analysis", cfg.executors.analysis), adverts_(cfg.scan) {
     // List of your device addresses (can stay uppercase, we normalize below)
-    std::vector<std::string> target_addresses = {
+    target_addresses_ = {
         "C6:22:D5:9E:0C:53",
         "D8:6C:8A:A8:38:DE",
         "F1:F2:2C:21:47:89"
     };
 
     // Convert target addresses to lowercase for comparison
-    for (auto& addr : target_addresses) {
+    for (auto& addr : target_addresses_) {
         std::transform(addr.begin(), addr.end(), addr.begin(), ::tolower);
     }
+    adverts_.set_targets(target_addresses_);
 
-    std::vector<SimpleBLE::Peripheral> found;
-    std::mutex found_mutex;  // 🔥 Thread-safe access
+    if (cfg_.calibration.enabled && !calibration_.load(cfg_.calibration.path)) {
+        std::cout << "[cal] no calibration file " << cfg_.calibration.path << ", nominal scale for all units\n";
+    }
+    config_hash_ = imu_config_hash(cfg_);
+    if (cfg_.results_db.enabled && !results_db_.open(cfg_.results_db.path)) {
+        std::cerr << "[results] History disabled for this session\n";
+    }
 
-    adapter.set_callback_on_scan_found([&](SimpleBLE::Peripheral p) {
-        std::string addr = p.address();
-        std::transform(addr.begin(), addr.end(), addr.begin(), ::tolower);
+    // Executors before any other thread exists: reserved cores only apply
+    // to threads created afterwards (event dispatcher, BLE / dbus stack)
+    const auto& ex = cfg_.executors;
+    if (ex.enabled) {
+        if (ex.reserve_cores) {
+            std::vector<int> cores;
+            for (const auto* p : {&ex.decode, &ex.analysis, &ex.io}) {
+                if (p->cpu >= 0) cores.push_back(p->cpu);
+            }
+            if (!cores.empty() && !imu_reserve_cores(cores)) {
+                std::cerr << "[exec] Could not keep other threads off the pinned cores\n";
+            }
+        }
+        const std::string isolated = imu_isolated_cpus();
+        if (!isolated.empty()) std::cout << "[exec] Kernel-isolated CPUs: " << isolated << "\n";
 
-        std::cout << "Scan found: " << p.identifier() << " [" << addr << "]\n";
+        decode_exec_.set_tick(ex.decode_period_s, [this] {
+            std::lock_guard<std::mutex> lock(sessions_mutex_);
+            for (auto& s : sessions_) s->decode_pending();
+        });
+        decode_exec_.start();
+        analysis_exec_.start();
+    }
+    events_.set_thread_placement(ex.io);
+
+    // The bus is for external consumers; shots only echo here when debugging
+    if (cfg_.verbose) {
+        events_.subscribe([](const ImuEvent& e) {
+            if (e.type != ImuEventType::Shot) return;
+            std::printf("💥 [%s] Shot  peak %.2f g  %.0f dps  %.1f ms\n", e.device_id,
+                        e.shot.peak_g, e.shot.peak_dps, e.shot.duration_s * 1000.0);
+        });
+    }
+    events_.start();
+    if (cfg_.live.enabled) {
+        live_.set_thread_placement(ex.io);
+        if (!live_.start()) std::cerr << "[live] Live stream disabled\n";
+    }
+}
+
+ImuQaManager::~ImuQaManager() {
+    shutdown();
+}
 
-        // Check if this address is in our target list
-        if (std::find(target_addresses.begin(), target_addresses.end(), addr) == target_addresses.end()) {
-            return; // Not a device we care about
+std::vector<ImuDeviceSession*> ImuQaManager::fixture_sessions(int fixture) {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    std::vector<ImuDeviceSession*> out;
+    for (size_t i = 0; i < sessions_.size(); ++i) {
+        if (fixture < 0 || fixtures_[i] == fixture) out.push_back(sessions_[i].get());
+    }
+    return out;
+}
+
+int ImuQaManager::pooled_count(int fixture) {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    if (fixture < 0) return (int)sessions_.size();
+    return (int)std::count(fixtures_.begin(), fixtures_.end(), fixture);
+}
+
+std::unique_ptr<ImuDeviceSession> ImuQaManager::unpool(ImuDeviceSession* s) {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    for (size_t i = 0; i < sessions_.size(); ++i) {
+        if (sessions_[i].get() != s) continue;
+        auto out = std::move(sessions_[i]);
+        sessions_.erase(sessions_.begin() + (ptrdiff_t)i);
+        fixtures_.erase(fixtures_.begin() + (ptrdiff_t)i);
+        return out;
+    }
+    return nullptr;
+}
+
+// Reconnects run outside the lock, so a test on the other fixture and the
+// decode tick carry on meanwhile
+int ImuQaManager::refresh_sessions(int fixture) {
+    int kept = 0;
+    for (ImuDeviceSession* s : fixture_sessions(fixture)) {
+        if (s->is_connected()) {
+            ++kept;
+            continue;
         }
+        std::cout << "[" << s->id() << "] Link lost since last run\n";
+        if (s->reconnect()) {
+            ++kept;
+            continue;
+        }
+        std::cerr << "[" << s->id() << "] ❌ Reconnect failed, dropping from pool.\n";
+        unpool(s);
+    }
+    return kept;
+}
 
-        std::lock_guard<std::mutex> lock(found_mutex);
-        
-        // Check if already added (avoid duplicates)
-        for (auto& existing : found) {  // 🔥 Remove 'const' to call non-const address()
-            std::string existing_addr = existing.address();
-            std::transform(existing_addr.begin(), existing_addr.end(), existing_addr.begin(), ::tolower);
-            if (existing_addr == addr) {
-                std::cout << "  [SKIP] Device already found: " << addr << "\n";
-                return;
-            }
+void ImuQaManager::retire_fixture(int fixture) {
+    for (ImuDeviceSession* s : fixture_sessions(fixture)) {
+        auto released = unpool(s);
+        if (!released) continue;
+        {
+            std::lock_guard<std::mutex> lock(sessions_mutex_);
+            retired_.push_back(imu_pack_mac(released->id()));
         }
+        released->stop();
+    }
+}
 
-        if ((int)found.size() >= max_devices) return;
-        
-        found.push_back(p);
-        std::cout << "✅ Found target device[" << found.size()
-                  << "]: " << p.identifier() << " [" << addr << "]\n";
-    });
+void ImuQaManager::shutdown() {
+    // The decode tick walks sessions_: stop it before any session goes
+    decode_exec_.stop();
+    analysis_exec_.stop();
+    std::vector<std::unique_ptr<ImuDeviceSession>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        sessions.swap(sessions_);
+        fixtures_.clear();
+    }
+    for (auto& s : sessions) s->stop();
+    sessions.clear();
+    events_.stop();
+    live_.stop();
+    ImuChunkPool::shared().trim();
+}
+
+bool ImuQaManager::start_session(std::unique_ptr<ImuLink> link, const std::string& id, int fixture) {
+    auto session = std::make_unique<ImuDeviceSession>(std::move(link), id);
+    session->set_watchdog(cfg_.stall_timeout_s, cfg_.auto_reconnect);
+    session->set_buffer_limits(cfg_.buffers, &station_budget_);
+    session->set_shot_detector(cfg_.shots, cfg_.recoil);
+    session->set_burst_capture(cfg_.bursts, cfg_.shots.max_duration_s + cfg_.shots.quiet_s);
+    session->set_event_bus(&events_, cfg_.events);
+    session->set_decode_queue(cfg_.executors.enabled ? cfg_.executors.raw_queue_frames : 0);
+    if (cfg_.calibration.enabled) {
+        std::lock_guard<std::mutex> lock(calibration_mutex_);
+        session->set_calibration(calibration_.find(id));
+    }
+    if (!session->start()) {
+        std::cerr << "[" << id << "] ❌ start() failed, skipping.\n";
+        return false;
+    }
+
+    const bool session_calibrated = session->is_calibrated();
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        sessions_.push_back(std::move(session));
+        fixtures_.push_back(fixture);
+    }
+    std::cout << "[" << id << "] ✅ Connected and started"
+              << (session_calibrated ? " (calibrated)" : "") << "\n";
+    return true;
+}
+
+// Synthetic units over ImuLinkEmulator, one seed each, in place of a scan.
+// Addresses already pooled or retired are skipped, so each batch of a
+// pipeline gets fresh units.
+bool ImuQaManager::connect_emulated(int max_devices, int fixture) {
+    const auto& em = cfg_.emulation;
+    const int   n  = std::min(max_devices, em.devices) - pooled_count(fixture);
+    std::cout << "🧪 Emulated link: " << std::max(n, 0) << " unit(s), seed " << em.seed << ", loss " << em.loss
+              << ", spikes " << em.spike_prob << "/event, outages every "
+              << (em.disconnect_mean_s > 0.0 ? std::to_string(em.disconnect_mean_s) + "s" : std::string("-"))
+              << "\n";
+    std::vector<uint64_t> taken;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (auto& s : sessions_) taken.push_back(imu_pack_mac(s->id()));
+        taken.insert(taken.end(), retired_.begin(), retired_.end());
+    }
+    for (int i = 0, tried = 0; tried < n && i <= 0xFFFF; ++i) {
+        char id[24];
+        std::snprintf(id, sizeof(id), "02:00:00:00:%02x:%02x", unsigned(i >> 8) & 0xFFu, unsigned(i) & 0xFFu);
+        if (std::find(taken.begin(), taken.end(), imu_pack_mac(id)) != taken.end()) continue;
+        ++tried;
+
+        ImuLinkConditions c = em;
+        c.seed = em.seed + uint64_t(i);
+        start_session(std::make_unique<ImuEmulatedLink>(
+                          c, std::make_unique<ImuSyntheticSource>(c.seed, c.frame_rate_hz)),
+                      id, fixture);
+    }
+    if (pooled_count(fixture) == 0) {
+        std::cerr << "❌ No sessions started.\n";
+        return false;
+    }
+    return true;
+}
+
+bool ImuQaManager::discover_and_connect(int max_devices, int fixture) {
+    // Sessions from the previous cycle stay connected; only units that
+    // dropped are reconnected, and we scan only for free slots.
+    const int kept = refresh_sessions(fixture);
+    if (kept > 0) {
+        std::cout << "♻️  Reusing " << kept << " connected device(s) from previous run.\n";
+    }
+    if (cfg_.emulation.enabled) return connect_emulated(max_devices, fixture);
+    if (kept >= max_devices || kept >= (int)target_addresses_.size()) {
+        std::cout << "All slots filled, skipping scan.\n";
+        return true;
+    }
+
+    auto adapters = SimpleBLE::Adapter::get_adapters();
+    if (adapters.empty()) {
+        std::cerr << "No BLE adapters found.\n";
+        return false;
+    }
+
+    SimpleBLE::Adapter& adapter = adapters[0];
+    std::cout << "Using adapter: " << adapter.identifier()
+              << " (" << adapter.address() << ")\n";
+
+    // Units already in the pool, on either fixture, or already tested are
+    // not scanned for again
+    std::vector<uint64_t> pooled;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (auto& s : sessions_) pooled.push_back(imu_pack_mac(s->id()));
+        pooled.insert(pooled.end(), retired_.begin(), retired_.end());
+    }
+    adverts_.set_excluded(pooled);
+
+    // Every advertisement is a MAC parse and a hash lookup in adverts_;
+    // names and services are only read for addresses not classified yet
+    std::unordered_map<uint64_t, SimpleBLE::Peripheral> found;
+    std::mutex found_mutex;  // 🔥 Thread-safe access
+    auto now_s = [] { return to_seconds(std::chrono::steady_clock::now()); };
+
+    auto on_advert = [&](SimpleBLE::Peripheral p) {
+        const uint64_t mac = imu_pack_mac(p.address());
+        const bool wanted = adverts_.observe(mac, p.rssi(), now_s(), [&] {
+            std::vector<std::string> uuids;
+            for (auto& svc : p.services()) uuids.push_back(svc.uuid());
+            return adverts_.prefilter(p.identifier(), uuids);
+        });
+        if (!wanted) return;
+
+        std::lock_guard<std::mutex> lock(found_mutex);
+        if (!found.emplace(mac, p).second) return;
+        std::cout << "✅ Found target device: " << p.identifier() << " [" << imu_format_mac(mac)
+                  << "] RSSI " << p.rssi() << " dBm\n";
+    };
+    adapter.set_callback_on_scan_found(on_advert);
+    adapter.set_callback_on_scan_updated(on_advert);   // keeps RSSI / last seen current
 
     // 🔥 FIX: Scan multiple times until we find minimum 2 devices
     const int MIN_DEVICES = 2;
@@ -78,9 +356,10 @@ bool ImuQaManager::discover_and_connect(int max_devices) {
         adapter.scan_for(SCAN_DURATION_MS);
         
         std::lock_guard<std::mutex> lock(found_mutex);
-        std::cout << "Found " << found.size() << " device(s) so far.\n";
+        const int visible = (int)found.size();
+        std::cout << "Found " << visible << " new device(s) so far.\n";
         
-        if ((int)found.size() >= MIN_DEVICES) {
+        if (kept + visible >= MIN_DEVICES) {
             std::cout << "✅ Minimum " << MIN_DEVICES << " devices found!\n";
             break;
         }
@@ -88,172 +367,692 @@ bool ImuQaManager::discover_and_connect(int max_devices) {
         scan_attempt++;
         
         if (scan_attempt < MAX_SCAN_ATTEMPTS) {
-            std::cout << "⚠️  Only " << found.size() << " device(s) found. Scanning again...\n";
+            std::cout << "⚠️  Only " << visible << " device(s) found. Scanning again...\n";
             std::this_thread::sleep_for(std::chrono::seconds(2));
         }
     }
 
-    if ((int)found.size() < MIN_DEVICES) {
+    // More units in range than free slots: the strongest signals get them
+    std::vector<uint64_t> picks;
+    {
+        std::lock_guard<std::mutex> lock(found_mutex);
+        for (uint64_t mac : adverts_.strongest(std::numeric_limits<size_t>::max(), now_s())) {
+            if (found.count(mac) && (int)picks.size() < max_devices - kept) picks.push_back(mac);
+        }
+    }
+    if (kept + (int)picks.size() < MIN_DEVICES) {
         std::cerr << "❌ ERROR: Could not find minimum " << MIN_DEVICES 
                   << " devices after " << MAX_SCAN_ATTEMPTS << " scan attempts.\n";
-        std::cerr << "Only found: " << found.size() << " device(s).\n";
+        std::cerr << "Only found: " << kept + picks.size() << " device(s).\n";
         return false;
     }
 
-    std::cout << "\n📡 Connecting to " << found.size() << " devices...\n";
+    std::cout << "\n📡 Connecting to " << picks.size() << " new devices...\n";
 
     // 🔥 FIX: Connect to ALL devices with delay between connections
-    for (size_t i = 0; i < found.size(); i++) {
-        auto& p = found[i];
+    for (size_t i = 0; i < picks.size(); i++) {
+        SimpleBLE::Peripheral p;
+        {
+            std::lock_guard<std::mutex> lock(found_mutex);
+            p = found.at(picks[i]);
+        }
+        ImuAdvRegistry::Entry e{};
+        adverts_.entry(picks[i], e);
         auto id = p.address();
+        char rssi[16];
+        std::snprintf(rssi, sizeof(rssi), "%.1f", e.rssi_avg);
         
-        std::cout << "\nConnecting to device " << (i + 1) << "/" << found.size() 
-                  << ": " << id << "...\n";
+        std::cout << "\nConnecting to device " << (i + 1) << "/" << picks.size() 
+                  << ": " << id << " (RSSI avg " << rssi
+                  << " dBm, " << e.adverts << " adverts)...\n";
         
-        auto session = std::make_unique<ImuDeviceSession>(p, id);
-        if (!session->start()) {
-            std::cerr << "[" << id << "] ❌ start() failed, skipping.\n";
-            continue;
-        }
-        
-        sessions_.push_back(std::move(session));
-        std::cout << "[" << id << "] ✅ Connected and started\n";
+        if (!start_session(std::make_unique<ImuBleLink>(p), id, fixture)) continue;
         
         // Small delay between device connections
-        if (i < found.size() - 1) {
+        if (i < picks.size() - 1) {
             std::this_thread::sleep_for(std::chrono::milliseconds(500));
         }
     }
 
-    if (sessions_.empty()) {
+    const int started = pooled_count(fixture);
+    if (started == 0) {
         std::cerr << "❌ No sessions started.\n";
         return false;
     }
 
-    std::cout << "\n✅ Successfully started " << sessions_.size()
+    std::cout << "\n✅ Successfully started " << started
               << " device sessions.\n";
     return true;
 }
 
 
-std::vector<ImuQaResult> ImuQaManager::run_test() {
+std::vector<ImuDeviceSession*> ImuQaManager::arm_fixture(int fixture) {
+    const auto batch = fixture_sessions(fixture);
+    // Pooled sessions were disarmed after the previous run; re-enable them.
+    // rearm() also drops whatever was buffered while idle.
+    for (auto* s : batch) {
+        if (!s->rearm(cfg_.reset_on_rearm)) {
+            std::cerr << "[" << s->id() << "] ⚠️  Re-arm failed\n";
+        }
+    }
+    return batch;
+}
+
+void ImuQaManager::store_settle_bias(const std::vector<ImuDeviceSession*>& batch,
+                                     const ImuBatchSettle& settle) {
+    if (!cfg_.settle.calibrate || !cfg_.settle.write_store || !cfg_.calibration.enabled) return;
+    std::lock_guard<std::mutex> lock(calibration_mutex_);
+    int updated = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (!settle.estimate(i).valid) continue;
+        ImuDeviceCal cal = batch[i]->calibration();
+        imu_fold_gyro_bias(cal, settle.estimate(i).gyro_bias_dps);
+        calibration_.set(batch[i]->id(), cal);
+        ++updated;
+    }
+    if (updated > 0) {
+        if (calibration_.save(cfg_.calibration.path)) {
+            std::cout << "[cal] " << updated << " unit(s) updated in " << cfg_.calibration.path << "\n";
+        } else {
+            std::cerr << "[cal] ❌ cannot write " << cfg_.calibration.path << "\n";
+        }
+    }
+}
+
+std::vector<ImuQaResult> ImuQaManager::run_test(int fixture) {
     using clock = std::chrono::steady_clock;
+    const auto batch = arm_fixture(fixture);
 
     auto t0 = clock::now();
-    auto settle_end = t0 + std::chrono::duration<double>(cfg_.settle_seconds);
-    auto test_end   = settle_end + std::chrono::duration<double>(cfg_.test_seconds);
+    const double t0_s = to_seconds(t0);
+
+    // Burst records go straight to the exporter; only their size is kept
+    std::vector<size_t> burst_counts(batch.size(), 0);
+    std::vector<size_t> burst_frames(batch.size(), 0);
+    auto take_bursts = [&](size_t i) {
+        for (auto& rec : batch[i]->drain_bursts()) {
+            ++burst_counts[i];
+            burst_frames[i] += rec.frames.size();
+            if (exporter_) exporter_->submit_burst(std::move(rec));
+        }
+    };
 
-    std::cout << "\n⏱️  Settling for " << cfg_.settle_seconds << "s...\n";
-    while (clock::now() < settle_end) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // Per-device sample accumulation, bounded by session/station budgets
+    // and pre-sized from the expected rate so the window never reallocates
+    const size_t expected_samples = static_cast<size_t>(
+        cfg_.buffers.expected_frame_rate_hz * cfg_.test_seconds * 1.05);
+    std::vector<std::unique_ptr<ImuSampleBuffer>> all_samples;
+    for (auto& s : batch) {
+        all_samples.push_back(std::make_unique<ImuSampleBuffer>());
+        all_samples.back()->configure(cfg_.buffers.session_budget_bytes, cfg_.buffers,
+                                      &station_budget_, s->id() + "_run");
+        all_samples.back()->reserve(expected_samples);
     }
 
-    std::cout << "📊 Collecting samples for " << cfg_.test_seconds << "s...\n\n";
+    // Attitude per device, settle data excluded
+    ImuOrientationTracker orientation(cfg_.orientation, std::max<size_t>(batch.size(), 1));
+    for (size_t i = 0; i < batch.size(); ++i) orientation.add_device();
+    std::vector<std::vector<ImuSample>> chunks(batch.size());
+    std::vector<const ImuSample*> chunk_ptrs(batch.size());
+    std::vector<size_t> chunk_counts(batch.size());
+
+    // Tilt metrics, absolute and against the golden unit if one is connected
+    ImuDifferentialEvaluator tilt(cfg_.reference);
+    for (size_t i = 0; i < batch.size(); ++i) tilt.add_device();
+    if (!cfg_.reference.device_id.empty()) {
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (same_address(batch[i]->id(), cfg_.reference.device_id)) tilt.set_reference((int)i);
+        }
+        if (tilt.reference() < 0) {
+            std::cout << "⚠️ Reference unit " << cfg_.reference.device_id
+                      << " not connected, grading absolute metrics only\n";
+        } else {
+            std::cout << "Reference unit: " << cfg_.reference.device_id << "\n";
+        }
+    }
+
+    // Units come to rest on the fixture; their data meanwhile gives each a
+    // zero-rate bias and gravity estimate, so one cycle calibrates and tests.
+    // Adaptive settle ends a unit's settle as soon as its gyro has been still
+    // for a full window, and its test window starts right away; units that
+    // never settle start at settle_seconds. Against a reference unit all
+    // windows start together so the difference signal covers all of them.
+    ImuBatchSettle settle(cfg_.settle, cfg_.gyro_stillness_deg_per_s, batch.size(), t0_s,
+                          t0_s + cfg_.settle_seconds);
+    std::vector<size_t> settled;
+
+    enum class Phase { Settling, Testing, Done };
+    struct Window {
+        Phase  phase  = Phase::Settling;
+        double start_s = 0.0, test_end_s = 0.0, end_s = 0.0;
+    };
+    std::vector<Window> windows(batch.size());
+    const bool common_start = !cfg_.settle.adaptive || tilt.reference() >= 0;
+    bool collecting = false;
 
-    // Per-device sample accumulation
-    std::vector<std::vector<ImuSample>> all_samples(sessions_.size());
+    // Dashboards follow every unit from its first settle frame
+    if (cfg_.live.enabled) {
+        std::vector<std::string> ids;
+        for (auto* s : batch) ids.push_back(s->id());
+        live_.begin_run(ids, t0_s);
+    }
 
+    auto start_window = [&](size_t i, double now_s) {
+        auto& w = windows[i];
+        w.phase      = Phase::Testing;
+        w.start_s    = now_s;
+        w.test_end_s = w.end_s = now_s + cfg_.test_seconds;
+        live_.set_phase(i, ImuLivePhase::Testing);
+        const auto& e = settle.finish(i);
+        if (cfg_.settle.calibrate) {
+            print_settle(batch[i]->id(), e, now_s - t0_s);
+            if (e.valid) orientation.level(i, e.gravity_g);
+        }
+        if (!collecting) {
+            std::cout << "📊 Collecting samples for " << cfg_.test_seconds << "s...\n\n";
+            events_.reset_stats();
+            decode_exec_.reset_stats();
+            analysis_exec_.reset_stats();
+            collecting = true;
+        }
+    };
+
+    std::cout << "\n⏱️  Settling (up to " << cfg_.settle_seconds << "s)...\n";
     auto last_print = clock::now();
-    
-    while (clock::now() < test_end) {
-        // 🔥 FIX: Poll ALL devices in parallel
-        for (size_t i = 0; i < sessions_.size(); ++i) {
-            auto chunk = sessions_[i]->drain_samples();
-            
-            if (!chunk.empty()) {
-                all_samples[i].insert(all_samples[i].end(), chunk.begin(), chunk.end());
+
+    bool running = true;
+    while (running) {
+        // Window processing runs on the analysis executor (inline when disabled)
+        analysis_exec_.run([&] {
+            // 🔥 FIX: Poll ALL devices in parallel
+            for (size_t i = 0; i < batch.size(); ++i) {
+                const auto& w = windows[i];
+                if (w.phase != Phase::Testing) {
+                    // Settle data only feeds the estimate; nothing is kept
+                    // once the window is over
+                    auto chunk = batch[i]->drain_samples();
+                    live_.push(i, chunk.data(), chunk.size());
+                    settle.push(i, chunk.data(), chunk.size());
+                    batch[i]->drain_shots();
+                    batch[i]->drain_shot_metrics();
+                    batch[i]->drain_bursts();
+                    continue;
+                }
+                take_bursts(i);
+
+                // Block policy: leave data in the session queue while the run
+                // buffer is full, so back-pressure reaches the decode stage
+                if (cfg_.buffers.policy == OverflowPolicy::Block &&
+                    !all_samples[i]->has_room(batch[i]->buffered())) {
+                    continue;
+                }
+
+                chunks[i] = batch[i]->drain_samples();
+                // Frames stamped before the window opened were still queued
+                auto& chunk = chunks[i];
+                size_t first = 0;
+                while (first < chunk.size() && chunk[first].timestamp_s < w.start_s) ++first;
+                if (first > 0) chunk.erase(chunk.begin(), chunk.begin() + (ptrdiff_t)first);
+                // Bias removed before attitude and storage
+                settle.remove_bias(i, chunk.data(), chunk.size());
+                live_.push(i, chunk.data(), chunk.size());
+            }
+
+            // All devices' attitude in one batched step per frame round
+            for (size_t i = 0; i < batch.size(); ++i) {
+                chunk_ptrs[i]   = chunks[i].data();
+                chunk_counts[i] = chunks[i].size();
+            }
+            orientation.process(chunk_ptrs.data(), chunk_counts.data(), batch.size());
+            tilt.process(chunk_ptrs.data(), chunk_counts.data(), batch.size());
+
+            for (size_t i = 0; i < batch.size(); ++i) {
+                auto& chunk = chunks[i];
+                live_.set_buffered(i, batch[i]->buffered());
+                if (!chunk.empty()) {
+                    live_.tilt(i, chunk.back().timestamp_s, orientation.bank().pitch_deg(i),
+                               orientation.bank().roll_deg(i));
+                    all_samples[i]->push(chunk.data(), chunk.size());
+                    // Hand the chunk to the writer thread; formatting happens there
+                    if (exporter_) exporter_->submit_samples(batch[i]->id(), std::move(chunk));
+                }
+                chunk.clear();
             }
+            live_.tick(to_seconds(clock::now()));
+        });
+
+        auto now = clock::now();
+        const double now_s = to_seconds(now);
+
+        // Settled units start their window
+        settled.clear();
+        settle.poll(now_s, common_start, settled);
+        for (size_t i : settled) start_window(i, now_s);
+
+        // Dropouts push the end of a window out so the unit still collects
+        // test_seconds worth of data, within max_window_extension_s
+        running = false;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            auto& w = windows[i];
+            if (w.phase == Phase::Testing) {
+                if (cfg_.extend_window_on_gap) {
+                    const double gap = gap_seconds_in(batch[i]->gaps(), w.start_s, now_s);
+                    w.end_s = std::max(w.end_s, w.test_end_s + std::min(gap, cfg_.max_window_extension_s));
+                }
+                if (now_s >= w.end_s) {
+                    w.phase = Phase::Done;
+                    live_.set_phase(i, ImuLivePhase::Done);
+                }
+            }
+            running = running || w.phase != Phase::Done;
         }
 
         // Print progress every 2 seconds
-        auto now = clock::now();
         if (std::chrono::duration<double>(now - last_print).count() >= 2.0) {
             // std::cout << "\n--- Progress Update ---\n";
-            // for (size_t i = 0; i < sessions_.size(); ++i) {
-            //     std::cout << "Device " << i << " [" << sessions_[i]->id() << "]: "
-            //               << all_samples[i].size() << " samples\n";
+            // for (size_t i = 0; i < batch.size(); ++i) {
+            //     std::cout << "Device " << i << " [" << batch[i]->id() << "]: "
+            //               << all_samples[i]->size() << " samples\n";
             // }
             last_print = now;
         }
 
         // Poll frequently to avoid losing packets (10ms)
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if (running) std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
 
-    std::cout << "\n✅ Test window ended. Evaluating...\n";
+    live_.end_run();
+
+    double longest_extension = 0.0;
+    for (const auto& w : windows) longest_extension = std::max(longest_extension, w.end_s - w.test_end_s);
+    std::cout << "\n✅ Test window ended";
+    if (longest_extension > 0.0) {
+        std::cout << " (extended by up to " << longest_extension << "s for dropouts)";
+    }
+    std::cout << ". Evaluating...\n";
+    tilt.finish();
 
     // Evaluate results for all devices
     std::vector<ImuQaResult> results;
-    for (size_t i = 0; i < sessions_.size(); ++i) {
-        auto id = sessions_[i]->id();
-        auto res = evaluate_device(id, all_samples[i]);
+    const int64_t wall_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    for (size_t i = 0; i < batch.size(); ++i) {
+        auto id = batch[i]->id();
+        const auto& w = windows[i];
+        auto gaps = clip_gaps(batch[i]->gaps(), w.start_s, w.end_s);
+        const auto& samples = all_samples[i]->samples();
+        const auto tilt_report = tilt.report(i);
+        ImuQaResult res;
+        analysis_exec_.run([&] {
+            res = evaluator_.evaluate(id, samples, gaps, w.end_s - w.start_s, tilt_report);
+        });
+        res.reconnects = batch[i]->reconnect_count();
+        res.overflow   = batch[i]->buffer_stats();
+        res.overflow.add(all_samples[i]->stats());
+        res.shot_count = (int)batch[i]->drain_shots().size();
+        res.settle_calibrated = settle.applied(i);
+        for (int k = 0; k < 3; ++k) {
+            res.settle_gyro_bias_dps[k] = settle.estimate(i).gyro_bias_dps[k];
+            res.settle_gravity_g[k]     = settle.estimate(i).gravity_g[k];
+        }
         results.push_back(res);
+        if (exporter_) exporter_->submit_result(res);
+        if (results_db_.is_open()) {
+            ImuResultRecord rec;
+            rec.time_us     = wall_us;
+            rec.config_hash = config_hash_;
+            rec.firmware    = batch[i]->firmware();
+            rec.profile     = cfg_.profile;
+            rec.result      = res;
+            results_db_.append(rec);
+        }
 
         // Print session summary
         std::cout << "\n=== Device [" << id << "] Summary ===\n";
-        std::cout << "Total samples: " << all_samples[i].size() << "\n";
+        std::cout << "Total samples: " << samples.size() << "\n";
+        if (cfg_.spectrum.enabled) {
+            static const char* kAxis[] = {"ax", "ay", "az", "gx", "gy", "gz"};
+            std::printf("Spectrum: gyro %.4f °/s rms, accel %.2f mg rms in band",
+                        res.gyro_band_rms_dps, res.accel_band_rms_g * 1000.0);
+            if (res.spur_axis >= 0) {
+                std::printf(", spur %.1f dB at %.1f Hz (%s)%s", res.spur_db, res.spur_hz,
+                            kAxis[res.spur_axis],
+                            res.spur_db > cfg_.spectrum.max_spur_db && cfg_.spectrum.max_spur_db > 0.0 ? " ⚠️" : "");
+            }
+            std::printf("\n");
+        }
+        if ((int)i == tilt.reference()) {
+            std::cout << "Reference unit (absolute metrics only)\n";
+        } else if (tilt_report.has_diff) {
+            std::printf("Tilt vs reference: MAC %.4f°  σ %.4f°  drift %.4f°/min (absolute %.4f° / %.4f° / %.4f°/min, lag %+.0f ms)\n",
+                        res.diff_mac_deg, res.diff_noise_sigma, res.diff_drift_deg_per_min,
+                        res.mac_deg, res.noise_sigma, res.drift_deg_per_min,
+                        res.reference_lag_s * 1000.0);
+        }
+        if (res.shot_count > 0) {
+            std::cout << "Shots detected: " << res.shot_count << "\n";
+            std::cout.flush();
+            print_shot_strings(batch[i]->drain_shot_metrics());
+        }
+        {
+            const auto& bank = orientation.bank();
+            float bias[3];
+            bank.gyro_bias_dps(i, bias);
+            std::printf("Attitude: roll %.2f°  pitch %.2f°  yaw %.2f°  gyro bias (%.3f, %.3f, %.3f) °/s\n",
+                        bank.roll_deg(i), bank.pitch_deg(i), bank.yaw_deg(i),
+                        bias[0], bias[1], bias[2]);
+        }
+        take_bursts(i);
+        if (burst_counts[i] > 0) {
+            std::cout << "Burst records: " << burst_counts[i] << " (" << burst_frames[i]
+                      << " frames, " << burst_frames[i] * sizeof(ImuBurstFrame) / 1024
+                      << " KiB vs " << samples.size() * ImuSampleChunks::kFrameBytes / 1024
+                      << " KiB continuous)";
+            if (batch[i]->bursts_dropped() > 0) {
+                std::cout << ", " << batch[i]->bursts_dropped() << " dropped";
+            }
+            std::cout << "\n";
+        }
+        if (res.gap_count > 0) {
+            std::cout << "Dropouts: " << res.gap_count << " (" << res.gap_seconds
+                      << "s), reconnects: " << res.reconnects
+                      << ", coverage: " << res.coverage * 100.0 << "%\n";
+        }
 
-        if (!all_samples[i].empty()) {
+        if (res.overflow.total() > 0) {
+            std::cout << "Buffer overflow (" << overflow_policy_name(cfg_.buffers.policy)
+                      << "): blocked=" << res.overflow.blocked
+                      << " dropped=" << res.overflow.dropped
+                      << " decimated=" << res.overflow.decimated
+                      << " spilled=" << res.overflow.spilled << "\n";
+        }
+
+        if (cfg_.verbose && !samples.empty()) {
             std::cout << "First 5 samples:\n";
-            for (size_t j = 0; j < std::min(size_t(5), all_samples[i].size()); j++) {
-                const auto& s = all_samples[i][j];
+            for (size_t j = 0; j < std::min(size_t(5), samples.size()); j++) {
+                const auto& s = samples[j];
                 std::cout << "  [" << j << "] "
                           << "ax=" << s.ax << ", ay=" << s.ay << ", az=" << s.az << ", "
                           << "gx=" << s.gx << ", gy=" << s.gy << ", gz=" << s.gz << "\n";
             }
         }
 
-        sessions_[i]->stop();
+        // Stay connected for the next cycle, just stop streaming
+        batch[i]->disarm();
+    }
+
+    // The bias each unit showed on top of the calibration it ran with,
+    // folded in so its next connection starts from it
+    store_settle_bias(batch, settle);
+
+    if (results_db_.is_open()) {
+        results_db_.sync();
+        std::cout << "[results] " << results.size() << " result(s) stored, " << results_db_.size()
+                  << " in " << cfg_.results_db.path << "\n";
     }
 
+    if (events_.published() > 0) {
+        std::cout << "\n";
+        events_.print_latency(std::cout);
+    }
+    if (cfg_.executors.enabled) {
+        std::cout << "\n";
+        decode_exec_.print_stats(std::cout);
+        analysis_exec_.print_stats(std::cout);
+    }
+
+    std::cout << "\nStation buffer peak: " << station_budget_.peak() / (1024 * 1024)
+              << " MiB of " << station_budget_.limit() / (1024 * 1024) << " MiB\n";
+    std::cout << "Process RSS: " << imu_current_rss_bytes() / (1024 * 1024) << " MiB, peak "
+              << imu_peak_rss_bytes() / (1024 * 1024) << " MiB\n";
+
     return results;
 }
 
-ImuQaResult ImuQaManager::evaluate_device(
-    const std::string& id,
-    const std::vector<ImuSample>& samples
-) {
-    ImuQaResult res{};
-    res.device_id = id;
-
-    if (samples.empty()) {
-        res.status            = QaStatus::FAIL;
-        res.mac_deg           = 0.0;
-        res.noise_sigma       = 0.0;
-        res.drift_deg_per_min = 0.0;
-        res.gravity_mean_g    = 0.0;
-        res.abnormal_count    = 0;
-        return res;
-    }
-
-    // Calculate average gravity magnitude
-    double sum_g = 0.0;
-    int count_g  = 0;
-
-    for (const auto& s : samples) {
-        if (s.ax != 0.0f || s.ay != 0.0f || s.az != 0.0f) {
-            double mag = std::sqrt(
-                double(s.ax) * s.ax +
-                double(s.ay) * s.ay +
-                double(s.az) * s.az
-            );
-            sum_g += mag;
-            ++count_g;
-        }
-    }
-
-    if (count_g > 0) {
-        res.gravity_mean_g = sum_g / count_g;
-    } else {
-        res.gravity_mean_g = 0.0;
+// Fixture b % 2 runs batch b while batch b + 1 connects on the other one.
+// The adapter's link budget goes to the batch under test first; the next
+// batch gets what is left and is topped up once the tested batch is gone.
+std::vector<ImuQaResult> ImuQaManager::run_pipeline(const ImuPipelineConfig& pipe) {
+    auto now_s = [] { return to_seconds(std::chrono::steady_clock::now()); };
+    ImuThroughputMeter meter(now_s(), pipe.batches);
+    std::vector<ImuQaResult> all;
+
+    std::cout << "\n🔁 Pipeline: " << pipe.batches << " batch(es) of up to " << pipe.batch_size
+              << " on two fixtures, " << pipe.max_connections << " links\n";
+
+    auto connect_batch = [&](int b, int fixture, bool idle) {
+        const int have  = pooled_count(fixture);
+        const int room  = std::max(0, pipe.max_connections - pooled_count());
+        const int limit = std::min(pipe.batch_size, have + room);
+        if (limit <= have) return;
+        std::cout << "\n[pipeline] batch " << b + 1 << ": connecting up to " << limit - have
+                  << " unit(s) on fixture " << (fixture ? 'B' : 'A') << "\n";
+        const double t = now_s();
+        discover_and_connect(limit, fixture);
+        meter.add_connect(b, now_s() - t);
+        // Units waiting for their turn stay quiet: no radio time or buffer
+        // budget taken from the batch under test
+        if (idle) {
+            for (ImuDeviceSession* s : fixture_sessions(fixture)) {
+                if (s->is_armed()) s->disarm();
+            }
+        }
+    };
+
+    for (int b = 0; b < pipe.batches; ++b) {
+        const int fixture = b % 2;
+        connect_batch(b, fixture, false);
+        if (pooled_count(fixture) == 0) {
+            std::cerr << "[pipeline] ❌ no units on fixture " << (fixture ? 'B' : 'A')
+                      << " for batch " << b + 1 << ", stopping\n";
+            break;
+        }
+
+        std::thread next;
+        if (b + 1 < pipe.batches) {
+            next = std::thread([&, b, fixture] {
+                try {
+                    connect_batch(b + 1, 1 - fixture, true);
+                } catch (const std::exception& e) {
+                    // Batch b + 1 connects what it is missing before its own test
+                    std::cerr << "[pipeline] ⚠️  background connect failed: " << e.what() << "\n";
+                }
+            });
+        }
+
+        // next captures this frame: join it before a throw unwinds past it
+        const double t_start = now_s();
+        std::vector<ImuQaResult> results;
+        try {
+            results = run_test(fixture);
+            meter.tested(b, (int)results.size(), t_start, now_s());
+            retire_fixture(fixture);
+        } catch (...) {
+            if (next.joinable()) next.join();
+            throw;
+        }
+        if (next.joinable()) next.join();
+
+        meter.print_batch(std::cout, b, now_s());
+        all.insert(all.end(), results.begin(), results.end());
+    }
+
+    std::cout << "\n";
+    meter.print(std::cout, now_s());
+    return all;
+}
+
+std::vector<ImuQaResult> ImuQaManager::run_soak(const ImuSoakConfig& soak, int fixture) {
+    using clock = std::chrono::steady_clock;
+    // Pointers taken under the lock; the pool does not change during a soak
+    const auto units = arm_fixture(fixture);
+
+    // Settle and calibration as in run_test. All windows start together so
+    // the interim verdicts of every unit cover the same span.
+    const double settle_t0_s = to_seconds(clock::now());
+    ImuBatchSettle settle(cfg_.settle, cfg_.gyro_stillness_deg_per_s, units.size(), settle_t0_s,
+                          settle_t0_s + cfg_.settle_seconds);
+    std::vector<size_t> settled;
+    std::cout << "\n⏱️  Settling (up to " << cfg_.settle_seconds << "s)...\n";
+    while (settle.settling_any()) {
+        for (size_t i = 0; i < units.size(); ++i) {
+            auto chunk = units[i]->drain_samples();
+            settle.push(i, chunk.data(), chunk.size());
+            units[i]->drain_shots();
+            units[i]->drain_shot_metrics();
+            units[i]->drain_bursts();
+        }
+        const double now_s = to_seconds(clock::now());
+        settled.clear();
+        settle.poll(now_s, true, settled);
+        for (size_t i : settled) {
+            const auto& e = settle.finish(i);
+            if (cfg_.settle.calibrate) print_settle(units[i]->id(), e, now_s - settle_t0_s);
+        }
+        if (settle.settling_any()) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::vector<std::unique_ptr<ImuSoakTracker>> trackers;
+    std::vector<int> shot_counts(units.size(), 0);
+    std::vector<std::unique_ptr<ImuCaptureWriter>> captures;
+    for (size_t i = 0; i < units.size(); ++i) {
+        ImuDeviceSession* s = units[i];
+        trackers.push_back(std::make_unique<ImuSoakTracker>(s->id(), cfg_));
+        // Deviation measured from the settled attitude, not the first frame
+        if (settle.estimate(i).valid) trackers.back()->set_reference(settle.estimate(i).gravity_g);
+        if (soak.capture_raw) {
+            captures.push_back(std::make_unique<ImuCaptureWriter>(
+                soak.output_directory, s->id(), soak.capture_roll_minutes * 60.0));
+        }
     }
 
-    // Placeholder values
-    res.mac_deg           = 0.0;
-    res.noise_sigma       = 0.0;
-    res.drift_deg_per_min = 0.0;
-    res.abnormal_count    = 0;
-    res.status            = QaStatus::PASS;
+    // One CSV row per device per interim window
+    std::error_code ec;
+    std::filesystem::create_directories(soak.output_directory, ec);
+    std::time_t now_t = std::time(nullptr);
+    std::tm now_tm{};
+#ifdef _WIN32
+    localtime_s(&now_tm, &now_t);
+#else
+    localtime_r(&now_t, &now_tm);
+#endif
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &now_tm);
+    std::ofstream log(std::filesystem::path(soak.output_directory) /
+                      (std::string("soak_") + stamp + ".csv"));
+    log << "device_id,window,start_s,end_s,status,accel_samples,gyro_samples,"
+           "gravity_mean_g,tilt_sigma_deg,tilt_drift_deg_per_min,mac_deg,"
+           "abnormal_count,gyro_bias_x,gyro_bias_y,gyro_bias_z,gyro_sigma_dps,gap_seconds\n";
+    log << std::fixed << std::setprecision(6);
 
-    return res;
-}
\ No newline at end of file
+    auto secs = [](double s) {
+        return std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(s));
+    };
+    // No interim windows requested: one window spanning the whole soak
+    const auto interim  = secs(soak.interim_minutes > 0.0 ? soak.interim_minutes * 60.0
+                                                          : soak.duration_hours * 3600.0);
+    const auto t0       = clock::now();
+    const double t0_s   = to_seconds(t0);
+    const auto soak_end = t0 + secs(soak.duration_hours * 3600.0);
+    auto window_start   = t0;
+    auto window_end     = std::min(t0 + interim, soak_end);
+
+    std::cout << "🔥 Soak test: " << soak.duration_hours << "h, interim verdict every "
+              << soak.interim_minutes << " min\n";
+
+    auto close_windows = [&](clock::time_point ws, clock::time_point we) {
+        const double ws_s = to_seconds(ws);
+        const double we_s = to_seconds(we);
+        const std::ios_base::fmtflags flags = std::cout.flags();
+        const std::streamsize precision = std::cout.precision();
+        std::cout << "\n--- Soak window " << std::fixed << std::setprecision(1)
+                  << std::chrono::duration<double>(we - t0).count() / 60.0 << " min ---\n";
+        for (size_t i = 0; i < units.size(); ++i) {
+            double gap_s = gap_seconds_in(units[i]->gaps(), ws_s, we_s);
+            ImuSoakWindow w = trackers[i]->close_window(ws_s, we_s, gap_s);
+
+            std::cout << std::setprecision(4) << "[" << units[i]->id() << "] "
+                      << qa_status_name(w.status)
+                      << "  g=" << w.gravity_mean_g
+                      << "  tilt σ=" << w.tilt_sigma_deg << "°"
+                      << "  drift=" << w.tilt_drift_deg_per_min << "°/min"
+                      << "  mac=" << w.mac_deg << "°"
+                      << "  gaps=" << w.gap_seconds << "s\n";
+
+            log << units[i]->id() << ',' << w.index << ',' << w.start_s << ',' << w.end_s
+                << ',' << qa_status_name(w.status) << ',' << w.accel_samples << ','
+                << w.gyro_samples << ',' << w.gravity_mean_g << ',' << w.tilt_sigma_deg << ','
+                << w.tilt_drift_deg_per_min << ',' << w.mac_deg << ',' << w.abnormal_count << ','
+                << w.gyro_bias_dps[0] << ',' << w.gyro_bias_dps[1] << ',' << w.gyro_bias_dps[2]
+                << ',' << w.gyro_sigma_dps << ',' << w.gap_seconds << '\n';
+        }
+        log.flush();
+        std::cout.flags(flags);
+        std::cout.precision(precision);
+    };
+
+    while (true) {
+        auto now = clock::now();
+        for (size_t i = 0; i < units.size(); ++i) {
+            // Shots only counted here, so nothing grows over the soak
+            shot_counts[i] += (int)units[i]->drain_shots().size();
+            units[i]->drain_shot_metrics();
+            for (auto& rec : units[i]->drain_bursts()) {
+                if (exporter_) exporter_->submit_burst(std::move(rec));
+            }
+
+            auto chunk = units[i]->drain_samples();
+            // Frames stamped before the first window were still queued
+            size_t first = 0;
+            while (first < chunk.size() && chunk[first].timestamp_s < t0_s) ++first;
+            if (first == chunk.size()) continue;
+            ImuSample* frames = chunk.data() + first;
+            const size_t n    = chunk.size() - first;
+            settle.remove_bias(i, frames, n);
+            trackers[i]->push(frames, n);
+            if (!captures.empty()) captures[i]->write(frames, n);
+        }
+
+        if (now >= window_end) {
+            close_windows(window_start, window_end);
+            if (window_end >= soak_end) break;
+            window_start = window_end;
+            window_end   = std::min(window_end + interim, soak_end);
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::cout << "\n✅ Soak finished.\n";
+    std::vector<ImuQaResult> results;
+    for (size_t i = 0; i < units.size(); ++i) {
+        auto res = trackers[i]->final_result();
+        res.reconnects = units[i]->reconnect_count();
+        res.gap_count  = (int)units[i]->gaps().size();
+        res.overflow   = units[i]->buffer_stats();
+        res.shot_count = shot_counts[i] + (int)units[i]->drain_shots().size();
+        res.settle_calibrated = settle.applied(i);
+        for (int k = 0; k < 3; ++k) {
+            res.settle_gyro_bias_dps[k] = settle.estimate(i).gyro_bias_dps[k];
+            res.settle_gravity_g[k]     = settle.estimate(i).gravity_g[k];
+        }
+        results.push_back(res);
+        if (exporter_) exporter_->submit_result(res);
+
+        std::cout << "[" << res.device_id << "] " << qa_status_name(res.status)
+                  << "  hourly tilt trend " << trackers[i]->tilt_trend_deg_per_hour() << "°/h"
+                  << ", gyro bias trend " << trackers[i]->gyro_bias_trend_dps_per_hour() << "°/s/h";
+        if (!captures.empty()) {
+            captures[i]->close();
+            const double raw = double(captures[i]->samples_written()) * sizeof(ImuSample);
+            std::cout << ", capture " << captures[i]->files_written() << " file(s), "
+                      << (captures[i]->bytes_written() > 0
+                          ? raw / double(captures[i]->bytes_written()) : 0.0) << ":1";
+        }
+        std::cout << "\n";
+
+        units[i]->disarm();
+    }
+    store_settle_bias(units, settle);
+    return results;
+}
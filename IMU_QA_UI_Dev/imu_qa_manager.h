@@ -1,24 +1,107 @@
 #pragma once
 #include "imu_types.h"
+#include "imu_adv_registry.h"
+#include "imu_calibration.h"
 #include "imu_device_session.h"
+#include "imu_differential_eval.h"
+#include "imu_evaluate.h"
+#include "imu_event_bus.h"
+#include "imu_executor.h"
+#include "imu_live_stream.h"
+#include "imu_orientation.h"
+#include "imu_pipeline.h"
+#include "imu_result_exporter.h"
+#include "imu_results_db.h"
+#include "imu_sample_buffer.h"
+#include "imu_settle.h"
+#include "imu_soak.h"
 #include <simpleble/SimpleBLE.h>
+#include <cstdint>
+#include <mutex>
 #include <vector>
 
 class ImuQaManager {
 public:
     ImuQaManager(const ImuQaConfig& cfg);
+    ~ImuQaManager();
 
-    // Scan and connect up to max_devices GMSync units
-    bool discover_and_connect(int max_devices = 10);
+    // Scan and connect up to max_devices GMSync units on a fixture. Sessions
+    // from earlier calls are kept; only dropped units are reconnected and free
+    // slots scanned. With cfg.emulation.enabled, emulated units are started
+    // instead.
+    bool discover_and_connect(int max_devices = 10, int fixture = 0);
 
-    // Run full QA test (settle + window) and return results
-    std::vector<ImuQaResult> run_test();
+    // Run full QA test (settle + window) on a fixture's units and return
+    // results. Sessions stay connected (disarmed) afterwards for the next cycle.
+    std::vector<ImuQaResult> run_test(int fixture = 0);
+
+    // pipe.batches batches on two fixtures in turn, the next batch connecting
+    // while the current one is tested (see ImuPipelineConfig). Tested units
+    // are disconnected and not picked up again. Returns every batch's results.
+    std::vector<ImuQaResult> run_pipeline(const ImuPipelineConfig& pipe);
+
+    // Burn-in run of a fixture's units, soak.duration_hours with an interim
+    // verdict every soak.interim_minutes, after the same settle and
+    // calibration as run_test. Nothing is accumulated: samples are folded
+    // into streaming stats and raw data goes to rolling compressed capture
+    // files, so memory per device stays constant. Returns the overall verdicts.
+    std::vector<ImuQaResult> run_soak(const ImuSoakConfig& soak, int fixture = 0);
+
+    // Stop and disconnect every pooled session
+    void shutdown();
+
+    size_t session_count() const { return sessions_.size(); }
+
+    // Optional: stream raw samples and results to disk during run_test (not owned)
+    void set_exporter(ImuResultExporter* exporter) {
+        exporter_ = exporter;
+        if (exporter_) exporter_->set_thread_placement(cfg_.executors.io);
+    }
+
+    // Live shot / motion events from every session; subscribe here
+    ImuEventBus& events() { return events_; }
+
+    // Every verdict run_test produced, across sessions (see ImuResultsDb)
+    const ImuResultsDb& results_db() const { return results_db_; }
 
 private:
     ImuQaConfig cfg_;
+    ImuResultExporter* exporter_ = nullptr;
+    ImuMemoryBudget station_budget_;   // shared by every session and run buffer
+    ImuEventBus events_;
+    ImuLiveStream live_;              // per-device state for dashboards
+    ImuDeviceEvaluator evaluator_;    // reused for every device in run_test
+    ImuExecutor decode_exec_;     // raw BLE frames -> samples and detectors
+    ImuExecutor analysis_exec_;   // run_test window processing and evaluation
+    std::mutex  sessions_mutex_;  // sessions_ changes vs the decode tick and other fixtures
     std::vector<std::unique_ptr<ImuDeviceSession>> sessions_;
+    std::vector<int> fixtures_;   // fixture of each pooled session
+    std::vector<uint64_t> retired_;   // tested and released, never rescanned
+    std::vector<std::string> target_addresses_;   // lowercase MACs
+    ImuAdvRegistry adverts_;      // what scans heard, kept across discoveries
+    std::mutex  calibration_mutex_;     // connects vs run_test on the other fixture
+    ImuCalibrationStore calibration_;   // per-unit, loaded in the constructor
+    ImuResultsDb results_db_;           // opened in the constructor
+    uint64_t     config_hash_ = 0;
 
-    ImuQaResult evaluate_device(const std::string& id,
-                                const std::vector<ImuSample>& samples);
+    // Snapshot of one fixture's sessions (-1: all fixtures); they stay
+    // valid until that fixture is refreshed or retired
+    std::vector<ImuDeviceSession*> fixture_sessions(int fixture);
+    int pooled_count(int fixture = -1);   // -1: all fixtures
+    // Reconnect a fixture's dropped sessions, discard the ones that cannot
+    // be reached; returns how many it keeps
+    int refresh_sessions(int fixture);
+    // Take a session out of the pool (null if it is not pooled)
+    std::unique_ptr<ImuDeviceSession> unpool(ImuDeviceSession* s);
+    // Stop and drop a fixture's sessions, remembering their addresses
+    void retire_fixture(int fixture);
+    // Configure, start and pool a session on link; false if it did not start
+    bool start_session(std::unique_ptr<ImuLink> link, const std::string& id, int fixture);
+    bool connect_emulated(int max_devices, int fixture);
+    // Snapshot a fixture's sessions and re-arm them for a run
+    std::vector<ImuDeviceSession*> arm_fixture(int fixture);
+    // Fold the settle bias of each unit into the calibration store
+    // (settle.write_store)
+    void store_settle_bias(const std::vector<ImuDeviceSession*>& batch, const ImuBatchSettle& settle);
     
 };
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include "imu_recoil_analyzer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double kG = 9.80665;
+
+inline bool is_accel(const ImuSample& s) {
+    return s.ax != 0.0f || s.ay != 0.0f || s.az != 0.0f;
+}
+
+inline double accel_axis(const ImuSample& s, int axis) {
+    return axis == 0 ? s.ax : axis == 1 ? s.ay : s.az;
+}
+
+inline double gyro_axis(const ImuSample& s, int axis) {
+    return axis == 0 ? s.gx : axis == 1 ? s.gy : s.gz;
+}
+
+} // namespace
+
+void ImuShotStringStats::push(const ImuShotMetrics& m) {
+    string_index = m.string_index;
+    ++shots;
+    rise.push(m.muzzle_rise_deg);
+    if (!std::isnan(m.return_to_zero_s)) rtz.push(m.return_to_zero_s);
+    lateral.push(m.lateral_deg);
+    impulse.push(m.impulse_mps);
+    if (m.shot_index > 1) split.push(m.split_s);
+}
+
+ImuRecoilAnalyzer::ImuRecoilAnalyzer(const ImuRecoilConfig& cfg, double detect_latency_s) {
+    configure(cfg, detect_latency_s);
+}
+
+void ImuRecoilAnalyzer::configure(const ImuRecoilConfig& cfg, double detect_latency_s) {
+    cfg_ = cfg;
+    detect_latency_s_ = detect_latency_s;
+    ring_.assign(std::max<size_t>(cfg_.history_frames, 64), ImuSample{});
+    reset();
+}
+
+void ImuRecoilAnalyzer::reset() {
+    ring_head_       = 0;
+    ring_count_      = 0;
+    pending_count_   = 0;
+    bias_pitch_      = 0.0;
+    bias_yaw_        = 0.0;
+    bore_baseline_   = 0.0;
+    last_window_end_ = -1e300;
+    string_index_    = 0;
+    shot_index_      = 0;
+    last_shot_s_     = -1e300;
+}
+
+const ImuSample& ImuRecoilAnalyzer::at(size_t i) const {
+    size_t cap = ring_.size();
+    return ring_[(ring_head_ + cap - ring_count_ + i) % cap];
+}
+
+bool ImuRecoilAnalyzer::add_shot(const ImuShotEvent& shot) {
+    if (pending_count_ >= kMaxPending) return false;
+    pending_[pending_count_++] = shot;
+    return true;
+}
+
+int ImuRecoilAnalyzer::push(const ImuSample& s, ImuShotMetrics* out) {
+    ring_[ring_head_] = s;
+    ring_head_ = (ring_head_ + 1) % ring_.size();
+    if (ring_count_ < ring_.size()) ++ring_count_;
+
+    // Shots complete in order once their recovery window has passed
+    int done = 0;
+    while (pending_count_ > 0) {
+        const ImuShotEvent& shot = pending_[0];
+        double end = shot.timestamp_s + shot.duration_s + cfg_.post_window_s;
+        if (pending_count_ > 1) end = std::min(end, pending_[1].timestamp_s);
+        if (s.timestamp_s < end + detect_latency_s_) break;
+
+        analyze(shot, end, out[done]);
+        out[done++].completed_s = s.timestamp_s;
+        std::copy(pending_.begin() + 1, pending_.begin() + pending_count_, pending_.begin());
+        --pending_count_;
+    }
+    return done;
+}
+
+void ImuRecoilAnalyzer::analyze(const ImuShotEvent& shot, double window_end, ImuShotMetrics& m) {
+    const double start     = shot.timestamp_s;
+    const double shot_end  = start + shot.duration_s;
+    const double pre_start = start - cfg_.pre_window_s;
+
+    // First frame of the pre-shot window
+    size_t first = ring_count_;
+    while (first > 0 && at(first - 1).timestamp_s >= pre_start) --first;
+
+    // Pre-shot reference, unless that window is still the previous recovery
+    if (pre_start >= last_window_end_) {
+        double sp = 0.0, sy = 0.0, sb = 0.0;
+        int ng = 0, na = 0;
+        for (size_t i = first; i < ring_count_; ++i) {
+            const ImuSample& f = at(i);
+            if (f.timestamp_s >= start) break;
+            if (is_accel(f)) {
+                sb += accel_axis(f, cfg_.bore_axis);
+                ++na;
+            } else {
+                sp += gyro_axis(f, cfg_.pitch_axis);
+                sy += gyro_axis(f, cfg_.yaw_axis);
+                ++ng;
+            }
+        }
+        if (ng > 0) {
+            bias_pitch_ = sp / ng;
+            bias_yaw_   = sy / ng;
+        }
+        if (na > 0) bore_baseline_ = sb / na;
+    }
+
+    double pitch = 0.0, yaw = 0.0, impulse = 0.0;
+    double peak = 0.0, peak_t = start;
+    double rtz = std::numeric_limits<double>::quiet_NaN();
+    double lateral = 0.0;
+    double last_gyro_t  = start;
+    double last_accel_t = start;
+    bool   past_peak = false;
+
+    for (size_t i = first; i < ring_count_; ++i) {
+        const ImuSample& f = at(i);
+        const double t = f.timestamp_s;
+        if (t < start) {
+            // Integration starts from the last frame of each stream before the shot
+            if (is_accel(f)) last_accel_t = t; else last_gyro_t = t;
+            continue;
+        }
+        if (t > window_end) break;
+
+        if (is_accel(f)) {
+            if (t <= shot_end) {
+                impulse += (accel_axis(f, cfg_.bore_axis) - bore_baseline_) * (t - last_accel_t);
+            }
+            last_accel_t = t;
+            continue;
+        }
+
+        const double dt = t - last_gyro_t;
+        last_gyro_t = t;
+        pitch += (gyro_axis(f, cfg_.pitch_axis) - bias_pitch_) * dt;
+        yaw   += (gyro_axis(f, cfg_.yaw_axis) - bias_yaw_) * dt;
+        if (std::isnan(rtz)) lateral = yaw;
+
+        if (std::fabs(pitch) > std::fabs(peak)) {
+            peak      = pitch;
+            peak_t    = t;
+            past_peak = false;
+        } else if (t > peak_t) {
+            past_peak = true;
+        }
+        if (past_peak && std::isnan(rtz) && std::fabs(pitch) <= cfg_.rtz_tolerance_deg) {
+            rtz = t - start;
+        }
+    }
+
+    if (start - last_shot_s_ > cfg_.string_gap_s) {
+        ++string_index_;
+        shot_index_ = 0;
+    }
+    ++shot_index_;
+
+    m.timestamp_s      = start;
+    m.string_index     = string_index_;
+    m.shot_index       = shot_index_;
+    m.split_s          = shot_index_ > 1 ? start - last_shot_s_ : 0.0;
+    m.muzzle_rise_deg  = peak;
+    m.return_to_zero_s = rtz;
+    m.lateral_deg      = lateral;
+    m.impulse_mps      = impulse * kG;
+    m.peak_g           = shot.peak_g;
+    m.peak_dps         = shot.peak_dps;
+
+    last_shot_s_     = start;
+    last_window_end_ = window_end;
+}
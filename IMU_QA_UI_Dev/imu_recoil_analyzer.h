@@ -0,0 +1,77 @@
+#pragma once
+#include "imu_stream_stats.h"
+#include "imu_types.h"
+#include <array>
+#include <vector>
+
+// Shot-to-shot consistency over one string, O(1) per shot
+struct ImuShotStringStats {
+    int             string_index = 0;
+    int             shots        = 0;
+    ImuRunningStats rise;      // deg
+    ImuRunningStats rtz;       // s, shots that returned to zero
+    ImuRunningStats lateral;   // deg
+    ImuRunningStats impulse;   // m/s
+    ImuRunningStats split;     // s, from the second shot on
+
+    void push(const ImuShotMetrics& m);
+};
+
+// Per-device recoil analytics on top of ImuShotDetector.
+//
+// Every frame goes into a fixed-size history ring; add_shot() queues a
+// detected shot, and once post_window_s of recovery has been seen the shot
+// is analysed from the ring:
+//   - gyro bias and bore accel baseline from pre_window_s before the shot
+//     (reused from the previous shot when that window overlaps its recovery)
+//   - pitch / yaw angles integrated per gyro frame from the shot start
+//   - muzzle rise = peak pitch, return to zero = first time after the peak
+//     pitch is within rtz_tolerance_deg, lateral = yaw at that time
+//   - impulse = integrated bore accel over the shot, in m/s
+// The recovery window ends early at the next shot, so rapid strings are
+// analysed shot by shot. Completion waits a further detect_latency_s (the
+// detector's worst case to report a shot) so a shot starting inside the
+// window is known before the window is analysed. No allocation after
+// configure(); not thread safe.
+class ImuRecoilAnalyzer {
+public:
+    explicit ImuRecoilAnalyzer(const ImuRecoilConfig& cfg = ImuRecoilConfig{},
+                               double detect_latency_s = 0.105);
+
+    void configure(const ImuRecoilConfig& cfg, double detect_latency_s);
+    void reset();
+
+    // Feed every frame; returns the number of shots completed into `out`
+    // (at most kMaxPending)
+    int push(const ImuSample& s, ImuShotMetrics* out);
+
+    // Queue a shot from the detector; false if too many are pending
+    bool add_shot(const ImuShotEvent& shot);
+
+    static constexpr int kMaxPending = 16;
+
+private:
+    ImuRecoilConfig cfg_;
+    double          detect_latency_s_ = 0.0;
+
+    std::vector<ImuSample> ring_;
+    size_t ring_head_  = 0;   // next write position
+    size_t ring_count_ = 0;
+
+    std::array<ImuShotEvent, kMaxPending> pending_;
+    int pending_count_ = 0;
+
+    // Pre-shot reference carried between shots
+    double bias_pitch_    = 0.0;
+    double bias_yaw_      = 0.0;
+    double bore_baseline_ = 0.0;
+    double last_window_end_ = -1e300;
+
+    // String bookkeeping
+    int    string_index_ = 0;
+    int    shot_index_   = 0;
+    double last_shot_s_  = -1e300;
+
+    const ImuSample& at(size_t i) const;   // 0 = oldest
+    void analyze(const ImuShotEvent& shot, double window_end, ImuShotMetrics& m);
+};
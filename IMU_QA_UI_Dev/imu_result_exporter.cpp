@@ -0,0 +1,641 @@
+#include "imu_result_exporter.h"
+#include "imu_executor.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <type_traits>
+
+namespace {
+
+// Samples are quantised int16 counts (accel LSB ~0.0005 g, gyro LSB ~0.018 deg/s),
+// so a fixed number of decimals is lossless enough and lets us format through
+// integer to_chars, which is several times faster than shortest-float output.
+constexpr int kValueDecimals = 5;
+constexpr int kTimeDecimals  = 6;
+
+constexpr int64_t kPow10[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+};
+
+inline char* put_str(char* p, const char* s, size_t n) {
+    std::memcpy(p, s, n);
+    return p + n;
+}
+
+template <size_t N>
+inline char* put_lit(char* p, const char (&s)[N]) {
+    return put_str(p, s, N - 1);
+}
+
+inline char* put_int(char* p, int64_t v) {
+    return std::to_chars(p, p + 24, v).ptr;
+}
+
+// "00".."99", so digits go out two per division
+constexpr char kDigitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Unsigned decimal, two digits per division; to_chars costs a few ns more
+// per call, which the 4-6 digit timestamp seconds pay on every line
+inline char* put_uint(char* p, uint64_t v) {
+    int digits = 1;
+    for (uint64_t t = v; t >= 10; t /= 10) ++digits;
+    char* e = p + digits;
+    char* w = e;
+    while (v >= 100) {
+        w -= 2;
+        std::memcpy(w, kDigitPairs + 2 * (v % 100), 2);
+        v /= 100;
+    }
+    if (v >= 10) {
+        w -= 2;
+        std::memcpy(w, kDigitPairs + 2 * v, 2);
+    } else {
+        *--w = static_cast<char>('0' + v);
+    }
+    return e;
+}
+
+// Fixed-point decimal through integer digits. Non-finite values become "nan"
+// (CSV) or null (JSON).
+template <int Decimals>
+inline char* put_fixed(char* p, double v, bool json) {
+    if (!(std::fabs(v) < 9.0e12)) {   // one test for the rare cases
+        if (!std::isfinite(v)) return json ? put_lit(p, "null") : put_lit(p, "nan");
+        return std::to_chars(p, p + 32, v).ptr;   // out of fixed-point range
+    }
+    constexpr int64_t scale = kPow10[Decimals];
+    const double  scaled = v * static_cast<double>(scale);
+    int64_t n = static_cast<int64_t>(scaled + std::copysign(0.5, scaled));
+    if (n == 0) {
+        *p++ = '0';
+        return p;
+    }
+    // Noise has a random sign: no branch on it to mispredict
+    const bool neg = n < 0;
+    *p = '-';
+    p += neg;
+    n = neg ? -n : n;
+    const int64_t ip = n / scale;
+    if (ip < 10) {
+        *p++ = static_cast<char>('0' + ip);   // the common case for g and deg/s
+    } else {
+        p = put_uint(p, static_cast<uint64_t>(ip));
+    }
+    uint32_t frac = static_cast<uint32_t>(n - ip * scale);
+    if (frac == 0) return p;
+
+    // Emit all fractional digits right to left, then trim trailing zeros
+    *p++ = '.';
+    int i = Decimals;
+    for (; i >= 2; i -= 2) {
+        std::memcpy(p + i - 2, kDigitPairs + 2 * (frac % 100u), 2);
+        frac /= 100u;
+    }
+    if (i == 1) p[0] = static_cast<char>('0' + frac);
+    p += Decimals;
+    while (p[-1] == '0') --p;
+    return p;
+}
+
+// Device ids are MACs, but escape anyway so the JSON is always valid
+inline char* put_json_string(char* p, const std::string& s) {
+    *p++ = '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') *p++ = '\\';
+        *p++ = (static_cast<unsigned char>(c) < 0x20) ? ' ' : c;
+    }
+    *p++ = '"';
+    return p;
+}
+
+// Worst-case bytes per formatted sample line, excluding the device id
+constexpr size_t kMaxSampleLine = 320;
+
+// Lines are built back to back in a stack block that is appended once it
+// cannot take another worst-case line: one append per ~100 lines instead of
+// one per line, and no zero-fill as a worst-case std::string::resize would do
+template <typename WriteLine>
+void append_lines(std::string& out, size_t line_max,
+                  const ImuSample* samples, size_t count, WriteLine write_line) {
+    char stack_block[32 << 10];
+    std::vector<char> heap_block;
+    char*  block = stack_block;
+    size_t block_size = sizeof(stack_block);
+    if (line_max > block_size / 4) {
+        heap_block.resize(line_max * 4);
+        block = heap_block.data();
+        block_size = heap_block.size();
+    }
+    char* const last = block + block_size - line_max;   // room for one more line up to here
+    char* p = block;
+    for (size_t i = 0; i < count; ++i) {
+        p = write_line(p, samples[i]);
+        if (p > last) {
+            out.append(block, static_cast<size_t>(p - block));
+            p = block;
+        }
+    }
+    out.append(block, static_cast<size_t>(p - block));
+}
+
+} // namespace
+
+ImuResultExporter::ImuResultExporter(const ImuExportConfig& cfg) : cfg_(cfg) {}
+
+ImuResultExporter::~ImuResultExporter() {
+    close();
+}
+
+const char* ImuResultExporter::samples_csv_header() {
+    return "device_id,timestamp_s,ax,ay,az,gx,gy,gz,temp\n";
+}
+
+const char* ImuResultExporter::results_csv_header() {
+    return "device_id,status,sample_count,mac_deg,noise_sigma,"
+           "drift_deg_per_min,gravity_mean_g,abnormal_count,"
+           "gap_count,gap_seconds,coverage,reconnects,"
+           "overflow_blocked,overflow_dropped,overflow_decimated,overflow_spilled,"
+           "peak_buffer_bytes,shot_count,"
+           "diff_mac_deg,diff_noise_sigma,diff_drift_deg_per_min,reference_lag_s,"
+           "gyro_band_rms_dps,accel_band_rms_g,spur_db,spur_hz,spur_axis,"
+           "settle_calibrated,settle_bias_x_dps,settle_bias_y_dps,settle_bias_z_dps,"
+           "settle_gravity_x_g,settle_gravity_y_g,settle_gravity_z_g\n";
+}
+
+const char* ImuResultExporter::bursts_header() {
+    return "IMUB\x01";
+}
+
+const char* ImuResultExporter::samples_block_header() {
+    return "IMUZ\x01";
+}
+
+bool ImuResultExporter::open(const std::string& run_tag) {
+    if (running_) return true;
+
+    std::error_code ec;
+    std::filesystem::create_directories(cfg_.directory, ec);
+    if (ec) {
+        std::cerr << "[export] Cannot create " << cfg_.directory << ": " << ec.message() << "\n";
+        return false;
+    }
+
+    const std::string base = (std::filesystem::path(cfg_.directory) / run_tag).string();
+    bool ok = true;
+    if (cfg_.csv) {
+        ok = ok && open_file(results_csv_, base + "_results.csv", results_csv_header());
+        if (cfg_.raw_samples)
+            ok = ok && open_file(samples_csv_, base + "_samples.csv", samples_csv_header());
+    }
+    if (cfg_.jsonl) {
+        ok = ok && open_file(results_jsonl_, base + "_results.jsonl", nullptr);
+        if (cfg_.raw_samples)
+            ok = ok && open_file(samples_jsonl_, base + "_samples.jsonl", nullptr);
+    }
+    if (cfg_.raw_samples && cfg_.compressed_samples) {
+        ok = ok && open_file(samples_z_, base + "_samples.imuz", samples_block_header());
+    }
+    if (cfg_.bursts) {
+        ok = ok && open_file(bursts_, base + "_bursts.imub", bursts_header());
+    }
+    if (!ok) {
+        close_file(results_csv_);
+        close_file(results_jsonl_);
+        close_file(samples_csv_);
+        close_file(samples_jsonl_);
+        close_file(bursts_);
+        close_file(samples_z_);
+        return false;
+    }
+
+    stop_requested_  = false;
+    samples_written_ = 0;
+    bytes_written_   = 0;
+    bursts_written_  = 0;
+    samples_dropped_ = 0;
+    bursts_dropped_  = 0;
+    queued_bytes_    = 0;
+    running_ = true;
+    writer_ = std::thread(&ImuResultExporter::writer_loop, this);
+    std::cout << "[export] Writing results to " << base << "_*\n";
+    return true;
+}
+
+void ImuResultExporter::close() {
+    if (!running_) return;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stop_requested_ = true;
+    }
+    queue_cv_.notify_one();
+    if (writer_.joinable()) writer_.join();
+    running_ = false;
+
+    close_file(results_csv_);
+    close_file(results_jsonl_);
+    close_file(samples_csv_);
+    close_file(samples_jsonl_);
+    close_file(bursts_);
+    close_file(samples_z_);
+
+    if (samples_dropped_ > 0 || bursts_dropped_ > 0) {
+        std::cerr << "[export] ⚠️  Queue full: " << samples_dropped_ << " samples and "
+                  << bursts_dropped_ << " burst records dropped\n";
+    }
+}
+
+bool ImuResultExporter::enqueue(Job&& job, bool droppable) {
+    job.bytes = sizeof(Job) + job.samples.size() * sizeof(ImuSample) +
+                job.burst.frames.size() * sizeof(ImuBurstFrame);
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (droppable && queued_bytes_ + job.bytes > cfg_.max_queued_bytes) return false;
+        queued_bytes_ += job.bytes;
+        queue_.push_back(std::move(job));
+    }
+    queue_cv_.notify_one();
+    return true;
+}
+
+void ImuResultExporter::submit_samples(const std::string& device_id,
+                                       std::vector<ImuSample> samples) {
+    if (!running_ || !cfg_.raw_samples || samples.empty()) return;
+    Job job;
+    job.device_id = device_id;
+    job.samples   = std::move(samples);
+    const size_t n = job.samples.size();
+    if (!enqueue(std::move(job), true)) samples_dropped_.fetch_add(n, std::memory_order_relaxed);
+}
+
+void ImuResultExporter::submit_result(const ImuQaResult& result) {
+    if (!running_) return;
+    Job job;
+    job.is_result = true;
+    job.result    = result;
+    enqueue(std::move(job), false);
+}
+
+void ImuResultExporter::submit_burst(ImuBurstRecord record) {
+    if (!running_ || !cfg_.bursts) return;
+    Job job;
+    job.is_burst = true;
+    job.burst    = std::move(record);
+    if (!enqueue(std::move(job), true)) bursts_dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ImuResultExporter::writer_loop() {
+    imu_apply_thread_placement(placement_, "imu-writer");
+    std::deque<Job> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [&] { return stop_requested_ || !queue_.empty(); });
+            batch.swap(queue_);
+            if (batch.empty() && stop_requested_) break;
+        }
+
+        size_t done = 0;
+        for (auto& job : batch) {
+            process(job);
+            done += job.bytes;
+        }
+        batch.clear();
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            queued_bytes_ -= done;
+        }
+
+        // Results are rare and small; keep them on disk promptly
+        flush(results_csv_, true);
+        flush(results_jsonl_, true);
+    }
+
+    // Partial blocks are only written once the run is over
+    for (auto& [id, frames] : pending_blocks_) write_block(id, frames);
+    pending_blocks_.clear();
+
+    flush(results_csv_, true);
+    flush(results_jsonl_, true);
+    flush(samples_csv_, true);
+    flush(samples_jsonl_, true);
+    flush(bursts_, true);
+    flush(samples_z_, true);
+}
+
+void ImuResultExporter::process(Job& job) {
+    if (job.is_result) {
+        if (results_csv_.fp)   append_result_csv(results_csv_.buf, job.result);
+        if (results_jsonl_.fp) append_result_jsonl(results_jsonl_.buf, job.result);
+        return;
+    }
+
+    if (job.is_burst) {
+        if (bursts_.fp) {
+            append_burst(bursts_.buf, job.burst);
+            flush(bursts_, false);
+            ++bursts_written_;
+        }
+        return;
+    }
+
+    if (samples_csv_.fp) {
+        append_samples_csv(samples_csv_.buf, job.device_id, job.samples.data(), job.samples.size());
+        flush(samples_csv_, false);
+    }
+    if (samples_jsonl_.fp) {
+        append_samples_jsonl(samples_jsonl_.buf, job.device_id, job.samples.data(), job.samples.size());
+        flush(samples_jsonl_, false);
+    }
+    if (samples_z_.fp) {
+        ImuFrameColumns& frames = pending_blocks_[job.device_id];
+        for (const auto& s : job.samples) {
+            frames.push(s);
+            if (frames.size() == ImuBlockEncoder::kBlockFrames) write_block(job.device_id, frames);
+        }
+        flush(samples_z_, false);
+    }
+    samples_written_ += job.samples.size();
+}
+
+void ImuResultExporter::write_block(const std::string& device_id, ImuFrameColumns& frames) {
+    if (frames.empty()) return;
+    const size_t id_len = std::min<size_t>(device_id.size(), 255);
+    block_.clear();
+    encoder_.encode(frames, 0, frames.size(), block_);
+    samples_z_.buf.push_back(static_cast<char>(id_len));
+    samples_z_.buf.append(device_id, 0, id_len);
+    samples_z_.buf.append(reinterpret_cast<const char*>(block_.data()), block_.size());
+    frames.clear();
+}
+
+void ImuResultExporter::flush(OutFile& f, bool force) {
+    if (!f.fp || f.buf.empty()) return;
+    if (!force && f.buf.size() < cfg_.write_buffer_bytes) return;
+
+    size_t n = std::fwrite(f.buf.data(), 1, f.buf.size(), f.fp);
+    if (n != f.buf.size()) {
+        std::cerr << "[export] Short write (" << n << "/" << f.buf.size() << " bytes)\n";
+    }
+    bytes_written_ += n;
+    f.buf.clear();   // keeps capacity, so steady state does not allocate
+}
+
+bool ImuResultExporter::open_file(OutFile& f, const std::string& path, const char* header) {
+    f.fp = std::fopen(path.c_str(), "wb");
+    if (!f.fp) {
+        std::cerr << "[export] Cannot open " << path << "\n";
+        return false;
+    }
+    f.buf.clear();
+    f.buf.reserve(cfg_.write_buffer_bytes + (64u << 10));
+    if (header) f.buf.append(header);
+    return true;
+}
+
+void ImuResultExporter::close_file(OutFile& f) {
+    if (!f.fp) return;
+    std::fclose(f.fp);
+    f.fp = nullptr;
+    f.buf.clear();
+    f.buf.shrink_to_fit();
+}
+
+void ImuResultExporter::append_samples_csv(std::string& out, const std::string& device_id,
+                                           const ImuSample* samples, size_t count) {
+    append_lines(out, kMaxSampleLine + device_id.size(), samples, count,
+                 [&](char* p, const ImuSample& s) {
+        p = put_str(p, device_id.data(), device_id.size());
+        *p++ = ',';
+        p = put_fixed<kTimeDecimals>(p, s.timestamp_s, false);
+        *p++ = ',';
+        p = put_fixed<kValueDecimals>(p, s.ax, false);
+        *p++ = ',';
+        p = put_fixed<kValueDecimals>(p, s.ay, false);
+        *p++ = ',';
+        p = put_fixed<kValueDecimals>(p, s.az, false);
+        *p++ = ',';
+        p = put_fixed<kValueDecimals>(p, s.gx, false);
+        *p++ = ',';
+        p = put_fixed<kValueDecimals>(p, s.gy, false);
+        *p++ = ',';
+        p = put_fixed<kValueDecimals>(p, s.gz, false);
+        *p++ = ',';
+        p = put_fixed<kValueDecimals>(p, s.temp, false);
+        *p++ = '\n';
+        return p;
+    });
+}
+
+void ImuResultExporter::append_samples_jsonl(std::string& out, const std::string& device_id,
+                                             const ImuSample* samples, size_t count) {
+    append_lines(out, kMaxSampleLine + 2 * device_id.size(), samples, count,
+                 [&](char* p, const ImuSample& s) {
+        p = put_lit(p, "{\"id\":");
+        p = put_json_string(p, device_id);
+        p = put_lit(p, ",\"t\":");
+        p = put_fixed<kTimeDecimals>(p, s.timestamp_s, true);
+        p = put_lit(p, ",\"ax\":");
+        p = put_fixed<kValueDecimals>(p, s.ax, true);
+        p = put_lit(p, ",\"ay\":");
+        p = put_fixed<kValueDecimals>(p, s.ay, true);
+        p = put_lit(p, ",\"az\":");
+        p = put_fixed<kValueDecimals>(p, s.az, true);
+        p = put_lit(p, ",\"gx\":");
+        p = put_fixed<kValueDecimals>(p, s.gx, true);
+        p = put_lit(p, ",\"gy\":");
+        p = put_fixed<kValueDecimals>(p, s.gy, true);
+        p = put_lit(p, ",\"gz\":");
+        p = put_fixed<kValueDecimals>(p, s.gz, true);
+        p = put_lit(p, ",\"temp\":");
+        p = put_fixed<kValueDecimals>(p, s.temp, true);
+        p = put_lit(p, "}\n");
+        return p;
+    });
+}
+
+void ImuResultExporter::append_result_csv(std::string& out, const ImuQaResult& r) {
+    char line[2048];
+    char* p = line;
+    p = put_str(p, r.device_id.data(), std::min<size_t>(r.device_id.size(), 128));
+    *p++ = ',';
+    const char* st = qa_status_name(r.status);
+    p = put_str(p, st, std::strlen(st));
+    *p++ = ',';
+    p = put_int(p, static_cast<int64_t>(r.sample_count));
+    *p++ = ',';
+    p = put_fixed<kValueDecimals>(p, r.mac_deg, false);
+    *p++ = ',';
+    p = put_fixed<kValueDecimals>(p, r.noise_sigma, false);
+    *p++ = ',';
+    p = put_fixed<kValueDecimals>(p, r.drift_deg_per_min, false);
+    *p++ = ',';
+    p = put_fixed<kValueDecimals>(p, r.gravity_mean_g, false);
+    *p++ = ',';
+    p = put_int(p, r.abnormal_count);
+    *p++ = ',';
+    p = put_int(p, r.gap_count);
+    *p++ = ',';
+    p = put_fixed<kValueDecimals>(p, r.gap_seconds, false);
+    *p++ = ',';
+    p = put_fixed<kValueDecimals>(p, r.coverage, false);
+    *p++ = ',';
+    p = put_int(p, r.reconnects);
+    *p++ = ',';
+    p = put_int(p, static_cast<int64_t>(r.overflow.blocked));
+    *p++ = ',';
+    p = put_int(p, static_cast<int64_t>(r.overflow.dropped));
+    *p++ = ',';
+    p = put_int(p, static_cast<int64_t>(r.overflow.decimated));
+    *p++ = ',';
+    p = put_int(p, static_cast<int64_t>(r.overflow.spilled));
+    *p++ = ',';
+    p = put_int(p, static_cast<int64_t>(r.overflow.peak_bytes));
+    *p++ = ',';
+    p = put_int(p, r.shot_count);
+    *p++ = ',';
+    p = put_fixed<kValueDecimals>(p, r.diff_mac_deg, false);
+    *p++ = ',';
+    p = put_fixed<kValueDecimals>(p, r.diff_noise_sigma, false);
+    *p++ = ',';
+    p = put_fixed<kValueDecimals>(p, r.diff_drift_deg_per_min, false);
+    *p++ = ',';
+    p = put_fixed<kValueDecimals>(p, r.reference_lag_s, false);
+    *p++ = ',';
+    p = put_fixed<kValueDecimals>(p, r.gyro_band_rms_dps, false);
+    *p++ = ',';
+    p = put_fixed<kValueDecimals>(p, r.accel_band_rms_g, false);
+    *p++ = ',';
+    p = put_fixed<kValueDecimals>(p, r.spur_db, false);
+    *p++ = ',';
+    p = put_fixed<kValueDecimals>(p, r.spur_hz, false);
+    *p++ = ',';
+    p = put_int(p, r.spur_axis);
+    *p++ = ',';
+    p = put_int(p, r.settle_calibrated ? 1 : 0);
+    for (double v : r.settle_gyro_bias_dps) {
+        *p++ = ',';
+        p = put_fixed<kValueDecimals>(p, v, false);
+    }
+    for (double v : r.settle_gravity_g) {
+        *p++ = ',';
+        p = put_fixed<kValueDecimals>(p, v, false);
+    }
+    *p++ = '\n';
+    out.append(line, static_cast<size_t>(p - line));
+}
+
+void ImuResultExporter::append_result_jsonl(std::string& out, const ImuQaResult& r) {
+    char line[2048];
+    char* p = line;
+    std::string id = r.device_id.substr(0, 128);
+    p = put_lit(p, "{\"device_id\":");
+    p = put_json_string(p, id);
+    p = put_lit(p, ",\"status\":\"");
+    const char* st = qa_status_name(r.status);
+    p = put_str(p, st, std::strlen(st));
+    p = put_lit(p, "\",\"sample_count\":");
+    p = put_int(p, static_cast<int64_t>(r.sample_count));
+    p = put_lit(p, ",\"mac_deg\":");
+    p = put_fixed<kValueDecimals>(p, r.mac_deg, true);
+    p = put_lit(p, ",\"noise_sigma\":");
+    p = put_fixed<kValueDecimals>(p, r.noise_sigma, true);
+    p = put_lit(p, ",\"drift_deg_per_min\":");
+    p = put_fixed<kValueDecimals>(p, r.drift_deg_per_min, true);
+    p = put_lit(p, ",\"gravity_mean_g\":");
+    p = put_fixed<kValueDecimals>(p, r.gravity_mean_g, true);
+    p = put_lit(p, ",\"abnormal_count\":");
+    p = put_int(p, r.abnormal_count);
+    p = put_lit(p, ",\"gap_count\":");
+    p = put_int(p, r.gap_count);
+    p = put_lit(p, ",\"gap_seconds\":");
+    p = put_fixed<kValueDecimals>(p, r.gap_seconds, true);
+    p = put_lit(p, ",\"coverage\":");
+    p = put_fixed<kValueDecimals>(p, r.coverage, true);
+    p = put_lit(p, ",\"reconnects\":");
+    p = put_int(p, r.reconnects);
+    p = put_lit(p, ",\"overflow\":{\"blocked\":");
+    p = put_int(p, static_cast<int64_t>(r.overflow.blocked));
+    p = put_lit(p, ",\"dropped\":");
+    p = put_int(p, static_cast<int64_t>(r.overflow.dropped));
+    p = put_lit(p, ",\"decimated\":");
+    p = put_int(p, static_cast<int64_t>(r.overflow.decimated));
+    p = put_lit(p, ",\"spilled\":");
+    p = put_int(p, static_cast<int64_t>(r.overflow.spilled));
+    p = put_lit(p, ",\"peak_bytes\":");
+    p = put_int(p, static_cast<int64_t>(r.overflow.peak_bytes));
+    p = put_lit(p, "},\"shot_count\":");
+    p = put_int(p, r.shot_count);
+    p = put_lit(p, ",\"diff_mac_deg\":");
+    p = put_fixed<kValueDecimals>(p, r.diff_mac_deg, true);
+    p = put_lit(p, ",\"diff_noise_sigma\":");
+    p = put_fixed<kValueDecimals>(p, r.diff_noise_sigma, true);
+    p = put_lit(p, ",\"diff_drift_deg_per_min\":");
+    p = put_fixed<kValueDecimals>(p, r.diff_drift_deg_per_min, true);
+    p = put_lit(p, ",\"reference_lag_s\":");
+    p = put_fixed<kValueDecimals>(p, r.reference_lag_s, true);
+    p = put_lit(p, ",\"spectrum\":{\"gyro_band_rms_dps\":");
+    p = put_fixed<kValueDecimals>(p, r.gyro_band_rms_dps, true);
+    p = put_lit(p, ",\"accel_band_rms_g\":");
+    p = put_fixed<kValueDecimals>(p, r.accel_band_rms_g, true);
+    p = put_lit(p, ",\"spur_db\":");
+    p = put_fixed<kValueDecimals>(p, r.spur_db, true);
+    p = put_lit(p, ",\"spur_hz\":");
+    p = put_fixed<kValueDecimals>(p, r.spur_hz, true);
+    p = put_lit(p, ",\"spur_axis\":");
+    p = put_int(p, r.spur_axis);
+    p = put_lit(p, "},\"settle\":{\"calibrated\":");
+    p = r.settle_calibrated ? put_lit(p, "true") : put_lit(p, "false");
+    p = put_lit(p, ",\"gyro_bias_dps\":[");
+    for (int k = 0; k < 3; ++k) {
+        if (k) *p++ = ',';
+        p = put_fixed<kValueDecimals>(p, r.settle_gyro_bias_dps[k], true);
+    }
+    p = put_lit(p, "],\"gravity_g\":[");
+    for (int k = 0; k < 3; ++k) {
+        if (k) *p++ = ',';
+        p = put_fixed<kValueDecimals>(p, r.settle_gravity_g[k], true);
+    }
+    p = put_lit(p, "]}");
+    p = put_lit(p, "}\n");
+    out.append(line, static_cast<size_t>(p - line));
+}
+
+namespace {
+
+template <typename T>
+inline void put_le(std::string& out, T v) {
+    using U = std::make_unsigned_t<T>;
+    U u = static_cast<U>(v);
+    for (size_t i = 0; i < sizeof(T); ++i) out.push_back(static_cast<char>((u >> (8 * i)) & 0xFF));
+}
+
+} // namespace
+
+void ImuResultExporter::append_burst(std::string& out, const ImuBurstRecord& r) {
+    const size_t id_len   = std::min<size_t>(r.device_id.size(), 255);
+    const size_t triggers = std::min<size_t>(r.triggers_us.size(), 65535);
+    out.reserve(out.size() + 24 + id_len + 4 * triggers + 11 * r.frames.size());
+
+    out.push_back(static_cast<char>(id_len));
+    out.append(r.device_id, 0, id_len);
+    uint64_t t_bits;
+    std::memcpy(&t_bits, &r.trigger_s, sizeof(t_bits));
+    put_le(out, t_bits);
+    out.push_back(static_cast<char>(r.reason));
+    put_le(out, static_cast<uint16_t>(triggers));
+    for (size_t i = 0; i < triggers; ++i) put_le(out, r.triggers_us[i]);
+    put_le(out, static_cast<uint32_t>(r.frames.size()));
+    for (const auto& f : r.frames) {
+        put_le(out, f.t_us);
+        out.push_back(static_cast<char>(f.kind));
+        put_le(out, f.v[0]);
+        put_le(out, f.v[1]);
+        put_le(out, f.v[2]);
+    }
+}
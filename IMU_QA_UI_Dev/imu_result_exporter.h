@@ -0,0 +1,143 @@
+#pragma once
+#include "imu_block_codec.h"
+#include "imu_burst_capture.h"
+#include "imu_types.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct ImuExportConfig {
+    std::string directory   = "qa_results";
+    bool        csv         = true;
+    bool        jsonl       = true;
+    bool        raw_samples = true;   // also dump every sample, not just results
+    bool        compressed_samples = true;   // raw samples as codec blocks (.imuz)
+    bool        bursts      = true;   // pre/post-trigger records, binary
+
+    // Formatted text is collected per file and flushed in chunks of this size
+    size_t write_buffer_bytes = 4u << 20;
+
+    // Data waiting for the writer thread. Beyond this, sample chunks and
+    // burst records are dropped and counted rather than queued, so a stalled
+    // disk cannot grow memory; results are always queued.
+    size_t max_queued_bytes = 64u << 20;
+};
+
+// Writes per-device results and raw samples to CSV / JSON Lines, and raw
+// samples losslessly compressed to <run_tag>_samples.imuz.
+// submit_*() only moves data into a queue; all formatting and file I/O
+// happens on the writer thread so the acquisition loop never waits on disk.
+class ImuResultExporter {
+public:
+    explicit ImuResultExporter(const ImuExportConfig& cfg);
+    ~ImuResultExporter();
+
+    // Creates <directory>/<run_tag>_{results,samples}.{csv,jsonl},
+    // <run_tag>_samples.imuz and <run_tag>_bursts.imub, then starts the writer
+    bool open(const std::string& run_tag);
+
+    // Drains the queue, flushes and closes all files
+    void close();
+
+    bool is_open() const { return running_; }
+
+    // Core / priority of the writer thread (takes effect at the next open)
+    void set_thread_placement(const ImuThreadPlacement& p) { placement_ = p; }
+
+    void submit_samples(const std::string& device_id, std::vector<ImuSample> samples);
+    void submit_result(const ImuQaResult& result);
+    void submit_burst(ImuBurstRecord record);
+
+    uint64_t samples_written() const { return samples_written_; }
+    uint64_t bytes_written() const   { return bytes_written_; }
+    uint64_t bursts_written() const  { return bursts_written_; }
+    // Dropped because the queue was full (see max_queued_bytes)
+    uint64_t samples_dropped() const { return samples_dropped_; }
+    uint64_t bursts_dropped() const  { return bursts_dropped_; }
+
+    // Formatting kernels (to_chars based, no locale, no iostreams)
+    static void append_samples_csv(std::string& out, const std::string& device_id,
+                                   const ImuSample* samples, size_t count);
+    static void append_samples_jsonl(std::string& out, const std::string& device_id,
+                                     const ImuSample* samples, size_t count);
+    static void append_result_csv(std::string& out, const ImuQaResult& r);
+    static void append_result_jsonl(std::string& out, const ImuQaResult& r);
+
+    // Burst file: "IMUB" u8 version, then per record (little endian)
+    //   u8 id_len id[id_len] f64 trigger_s u8 reason
+    //   u16 n_triggers i32 trigger_us[n] u32 n_frames
+    //   n_frames x (i32 t_us u8 kind i16 x i16 y i16 z)
+    static void append_burst(std::string& out, const ImuBurstRecord& r);
+    static const char* bursts_header();
+
+    // Compressed samples file: "IMUZ" u8 version, then per block
+    //   u8 id_len id[id_len] ImuBlockEncoder block
+    // Each device's frames are collected into full blocks; the remainder is
+    // written at close.
+    static const char* samples_block_header();
+
+    static const char* samples_csv_header();
+    static const char* results_csv_header();
+
+private:
+    struct Job {
+        std::string            device_id;
+        std::vector<ImuSample> samples;
+        bool                   is_result = false;
+        ImuQaResult            result{};
+        bool                   is_burst = false;
+        ImuBurstRecord         burst;
+        size_t                 bytes = 0;   // counted against max_queued_bytes
+    };
+
+    struct OutFile {
+        std::FILE*  fp = nullptr;
+        std::string buf;
+    };
+
+    ImuExportConfig    cfg_;
+    ImuThreadPlacement placement_;
+
+    std::atomic<bool> running_{false};
+    std::thread       writer_;
+
+    std::mutex              queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<Job>         queue_;
+    size_t                  queued_bytes_   = 0;
+    bool                    stop_requested_ = false;
+
+    OutFile results_csv_;
+    OutFile results_jsonl_;
+    OutFile samples_csv_;
+    OutFile samples_jsonl_;
+    OutFile bursts_;
+    OutFile samples_z_;
+
+    // Writer thread only: frames waiting for a full block, per device
+    std::unordered_map<std::string, ImuFrameColumns> pending_blocks_;
+    ImuBlockEncoder                                  encoder_;
+    std::vector<uint8_t>                             block_;
+
+    std::atomic<uint64_t> samples_written_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+    std::atomic<uint64_t> bursts_written_{0};
+    std::atomic<uint64_t> samples_dropped_{0};
+    std::atomic<uint64_t> bursts_dropped_{0};
+
+    // False when the queue is full and a droppable job was not queued
+    bool enqueue(Job&& job, bool droppable);
+    void writer_loop();
+    void process(Job& job);
+    void write_block(const std::string& device_id, ImuFrameColumns& frames);
+    void flush(OutFile& f, bool force);
+    bool open_file(OutFile& f, const std::string& path, const char* header);
+    void close_file(OutFile& f);
+};
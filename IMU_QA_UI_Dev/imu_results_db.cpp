@@ -0,0 +1,550 @@
+#include "imu_results_db.h"
+#include "imu_adv_registry.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <type_traits>
+
+namespace {
+
+constexpr uint8_t  kVersion     = 1;
+constexpr size_t   kHeaderBytes = 8;    // "IMUR" version + 3 reserved
+constexpr size_t   kRecordHead  = 8;    // u32 payload_bytes u32 checksum
+constexpr uint16_t kLayout      = 1;    // payload fields; later layouts only append
+constexpr uint32_t kMaxPayload  = 1u << 16;
+
+uint32_t fnv1a32(const uint8_t* p, size_t n) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; ++i) h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+struct Fnv64 {
+    uint64_t h = 14695981039346656037ull;
+
+    void bytes(const void* data, size_t n) {
+        const auto* p = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < n; ++i) h = (h ^ p[i]) * 1099511628211ull;
+    }
+    template <typename T>
+    void add(T v) {
+        static_assert(std::is_arithmetic<T>::value, "numbers only");
+        bytes(&v, sizeof(v));
+    }
+    void add(const std::string& s) {
+        add(uint64_t(s.size()));
+        bytes(s.data(), s.size());
+    }
+};
+
+template <typename T>
+inline void put_le(std::string& out, T v) {
+    using U = std::make_unsigned_t<T>;
+    U u = static_cast<U>(v);
+    for (size_t i = 0; i < sizeof(T); ++i) out.push_back(static_cast<char>((u >> (8 * i)) & 0xFF));
+}
+
+inline void put_f64(std::string& out, double v) {
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    put_le(out, bits);
+}
+
+inline void put_str(std::string& out, const std::string& s) {
+    const size_t n = std::min<size_t>(s.size(), 255);
+    out.push_back(static_cast<char>(n));
+    out.append(s, 0, n);
+}
+
+template <typename T>
+inline T get_le(const uint8_t* p) {
+    using U = std::make_unsigned_t<T>;
+    U u = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) u |= static_cast<U>(U(p[i]) << (8 * i));
+    return static_cast<T>(u);
+}
+
+// Bounds-checked payload reader; ok() turns false on the first overrun
+class Reader {
+public:
+    Reader(const uint8_t* p, size_t n) : p_(p), end_(p + n) {}
+
+    template <typename T>
+    T get() {
+        if (size_t(end_ - p_) < sizeof(T)) return fail<T>();
+        const T v = get_le<T>(p_);
+        p_ += sizeof(T);
+        return v;
+    }
+    double f64() {
+        const uint64_t bits = get<uint64_t>();
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    std::string str() {
+        const size_t n = get<uint8_t>();
+        if (size_t(end_ - p_) < n) return fail<std::string>();
+        std::string s(reinterpret_cast<const char*>(p_), n);
+        p_ += n;
+        return s;
+    }
+    bool ok() const { return ok_; }
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+    bool ok_ = true;
+
+    template <typename T>
+    T fail() {
+        ok_ = false;
+        p_  = end_;
+        return T{};
+    }
+};
+
+template <typename T>
+inline void store_le(uint8_t* p, T v) {
+    using U = std::make_unsigned_t<T>;
+    U u = static_cast<U>(v);
+    for (size_t i = 0; i < sizeof(T); ++i) p[i] = static_cast<uint8_t>((u >> (8 * i)) & 0xFF);
+}
+
+void put_entry(uint8_t out[32], const ImuResultsDb::Entry& e) {
+    store_le(out, e.key);
+    store_le(out + 8, e.time_us);
+    store_le(out + 16, e.offset);
+    store_le(out + 24, e.bytes);
+    out[28] = e.status;
+    out[29] = out[30] = out[31] = 0;
+}
+
+ImuResultsDb::Entry get_entry(const uint8_t* p) {
+    ImuResultsDb::Entry e{};
+    e.key     = get_le<uint64_t>(p);
+    e.time_us = get_le<int64_t>(p + 8);
+    e.offset  = get_le<uint64_t>(p + 16);
+    e.bytes   = get_le<uint32_t>(p + 24);
+    e.status  = p[28];
+    return e;
+}
+
+bool seek_to(std::FILE* f, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(f, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(f, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+} // namespace
+
+uint64_t imu_config_hash(const ImuQaConfig& cfg) {
+    Fnv64 h;
+    h.add(cfg.settle_seconds);
+    h.add(cfg.test_seconds);
+    h.add(cfg.extend_window_on_gap);
+    h.add(cfg.max_window_extension_s);
+    h.add(cfg.min_coverage);
+    h.add(cfg.abnormal_threshold_deg);
+    h.add(cfg.gravity_deviation_g);
+    h.add(cfg.gyro_stillness_deg_per_s);
+    h.add(cfg.max_abnormal_per_window);
+    h.add(cfg.max_mac_deg);
+    h.add(cfg.max_noise_sigma_deg);
+    h.add(cfg.max_drift_deg_per_min);
+
+    h.add(cfg.settle.adaptive);
+    h.add(cfg.settle.still_window_s);
+    h.add(cfg.settle.calibrate);
+    h.add(cfg.settle.skip_s);
+    h.add(uint64_t(cfg.settle.min_frames));
+    h.add(cfg.settle.apply);
+
+    h.add(cfg.spectrum.enabled);
+    h.add(uint64_t(cfg.spectrum.segment));
+    h.add(cfg.spectrum.overlap);
+    h.add(cfg.spectrum.band_lo_hz);
+    h.add(cfg.spectrum.band_hi_hz);
+    h.add(cfg.spectrum.max_gyro_band_dps);
+    h.add(cfg.spectrum.max_accel_band_g);
+    h.add(cfg.spectrum.max_spur_db);
+
+    h.add(cfg.orientation.kp);
+    h.add(cfg.orientation.ki);
+    h.add(cfg.orientation.accel_gate_g);
+
+    const uint64_t reference = imu_pack_mac(cfg.reference.device_id);
+    h.add(reference);
+    h.add(cfg.reference.bin_s);
+    h.add(cfg.reference.max_lag_s);
+
+    h.add(cfg.profile);
+    return h.h;
+}
+
+uint64_t imu_result_key(const std::string& device_id) {
+    const uint64_t mac = imu_pack_mac(device_id);
+    if (mac != kInvalidMac) return mac;
+    Fnv64 h;
+    h.add(device_id);
+    return h.h | (uint64_t(1) << 63);
+}
+
+void ImuResultsDb::encode(const ImuResultRecord& rec, std::string& out) {
+    const ImuQaResult& r = rec.result;
+    put_le(out, kLayout);
+    put_le(out, rec.time_us);
+    put_le(out, rec.config_hash);
+    out.push_back(static_cast<char>(r.status));
+    put_str(out, r.device_id);
+    put_str(out, rec.firmware);
+    put_str(out, rec.profile);
+
+    put_le(out, uint64_t(r.sample_count));
+    put_f64(out, r.mac_deg);
+    put_f64(out, r.noise_sigma);
+    put_f64(out, r.drift_deg_per_min);
+    put_f64(out, r.gravity_mean_g);
+    put_le(out, int32_t(r.abnormal_count));
+    put_le(out, int32_t(r.gap_count));
+    put_f64(out, r.gap_seconds);
+    put_f64(out, r.coverage);
+    put_le(out, int32_t(r.reconnects));
+    put_le(out, r.overflow.blocked);
+    put_le(out, r.overflow.dropped);
+    put_le(out, r.overflow.decimated);
+    put_le(out, r.overflow.spilled);
+    put_le(out, uint64_t(r.overflow.peak_bytes));
+    put_le(out, int32_t(r.shot_count));
+    put_f64(out, r.diff_mac_deg);
+    put_f64(out, r.diff_noise_sigma);
+    put_f64(out, r.diff_drift_deg_per_min);
+    put_f64(out, r.reference_lag_s);
+    put_f64(out, r.gyro_band_rms_dps);
+    put_f64(out, r.accel_band_rms_g);
+    put_f64(out, r.spur_db);
+    put_f64(out, r.spur_hz);
+    put_le(out, int32_t(r.spur_axis));
+    out.push_back(r.settle_calibrated ? 1 : 0);
+    for (int k = 0; k < 3; ++k) put_f64(out, r.settle_gyro_bias_dps[k]);
+    for (int k = 0; k < 3; ++k) put_f64(out, r.settle_gravity_g[k]);
+}
+
+bool ImuResultsDb::decode(const uint8_t* p, size_t n, ImuResultRecord& rec) {
+    Reader in(p, n);
+    if (in.get<uint16_t>() < 1) return false;
+    rec = ImuResultRecord{};
+    ImuQaResult& r = rec.result;
+    rec.time_us     = in.get<int64_t>();
+    rec.config_hash = in.get<uint64_t>();
+    const uint8_t status = in.get<uint8_t>();
+    if (status > uint8_t(QaStatus::FAIL)) return false;
+    r.status     = static_cast<QaStatus>(status);
+    r.device_id  = in.str();
+    rec.firmware = in.str();
+    rec.profile  = in.str();
+
+    r.sample_count      = size_t(in.get<uint64_t>());
+    r.mac_deg           = in.f64();
+    r.noise_sigma       = in.f64();
+    r.drift_deg_per_min = in.f64();
+    r.gravity_mean_g    = in.f64();
+    r.abnormal_count    = in.get<int32_t>();
+    r.gap_count         = in.get<int32_t>();
+    r.gap_seconds       = in.f64();
+    r.coverage          = in.f64();
+    r.reconnects        = in.get<int32_t>();
+    r.overflow.blocked    = in.get<uint64_t>();
+    r.overflow.dropped    = in.get<uint64_t>();
+    r.overflow.decimated  = in.get<uint64_t>();
+    r.overflow.spilled    = in.get<uint64_t>();
+    r.overflow.peak_bytes = size_t(in.get<uint64_t>());
+    r.shot_count             = in.get<int32_t>();
+    r.diff_mac_deg           = in.f64();
+    r.diff_noise_sigma       = in.f64();
+    r.diff_drift_deg_per_min = in.f64();
+    r.reference_lag_s        = in.f64();
+    r.gyro_band_rms_dps      = in.f64();
+    r.accel_band_rms_g       = in.f64();
+    r.spur_db                = in.f64();
+    r.spur_hz                = in.f64();
+    r.spur_axis              = in.get<int32_t>();
+    r.settle_calibrated      = in.get<uint8_t>() != 0;
+    for (int k = 0; k < 3; ++k) r.settle_gyro_bias_dps[k] = in.f64();
+    for (int k = 0; k < 3; ++k) r.settle_gravity_g[k] = in.f64();
+    return in.ok();
+}
+
+ImuResultsDb::~ImuResultsDb() {
+    close();
+}
+
+bool ImuResultsDb::open(const std::string& path) {
+    close();
+    std::lock_guard<std::mutex> lock(mutex_);
+    path_ = path;
+    const std::string index_path = path + ".idx";
+
+    std::error_code ec;
+    const auto dir = std::filesystem::path(path).parent_path();
+    if (!dir.empty()) std::filesystem::create_directories(dir, ec);
+
+    uint64_t log_size = std::filesystem::exists(path, ec) ? std::filesystem::file_size(path, ec) : 0;
+    if (log_size < kHeaderBytes) {
+        std::FILE* fp = std::fopen(path.c_str(), "wb");
+        if (!fp) {
+            std::cerr << "[results] ❌ Cannot create " << path << "\n";
+            return false;
+        }
+        const uint8_t head[kHeaderBytes] = {'I', 'M', 'U', 'R', kVersion, 0, 0, 0};
+        std::fwrite(head, 1, sizeof(head), fp);
+        std::fclose(fp);
+        log_size = kHeaderBytes;
+        std::filesystem::remove(index_path, ec);
+    }
+
+    reader_ = std::fopen(path.c_str(), "rb");
+    uint8_t head[kHeaderBytes] = {};
+    if (!reader_ || std::fread(head, 1, sizeof(head), reader_) != sizeof(head) ||
+        std::memcmp(head, "IMUR", 4) != 0 || head[4] != kVersion) {
+        std::cerr << "[results] ❌ " << path << " is not a results store\n";
+        if (reader_) std::fclose(reader_);
+        reader_ = nullptr;
+        return false;
+    }
+
+    // Index entries are trusted while they chain through the log
+    std::vector<uint8_t> raw;
+    if (std::FILE* fp = std::fopen(index_path.c_str(), "rb")) {
+        raw.resize(size_t(std::filesystem::file_size(index_path, ec)));
+        raw.resize(std::fread(raw.data(), 1, raw.size(), fp));
+        std::fclose(fp);
+    }
+    const size_t stored = raw.size() / 32;
+    entries_.reserve(stored + stored / 4);
+    uint64_t next = kHeaderBytes;
+    for (size_t i = 0; i < stored; ++i) {
+        const Entry e = get_entry(raw.data() + 32 * i);
+        if (e.offset != next || e.bytes <= kRecordHead || e.offset + e.bytes > log_size) break;
+        add(e);
+        next = e.offset + e.bytes;
+    }
+    if (raw.size() != entries_.size() * 32 && std::filesystem::exists(index_path, ec)) {
+        std::filesystem::resize_file(index_path, entries_.size() * 32, ec);
+    }
+
+    auto fail = [&](const std::string& what) {
+        if (!what.empty()) std::cerr << "[results] ❌ Cannot write " << what << "\n";
+        for (std::FILE** fp : {&index_, &reader_}) {
+            if (*fp) std::fclose(*fp);
+            *fp = nullptr;
+        }
+        entries_.clear();
+        by_key_.clear();
+        return false;
+    };
+    index_ = std::fopen(index_path.c_str(), "ab");
+    if (!index_) return fail(index_path);
+    const size_t indexed = entries_.size();
+    if (next < log_size && !recover(next, log_size)) return fail(path);
+    log_ = std::fopen(path.c_str(), "ab");
+    if (!log_) return fail(path);
+
+    log_bytes_ = flushed_bytes_ = entries_.empty() ? kHeaderBytes
+                                                   : entries_.back().offset + entries_.back().bytes;
+    std::cout << "[results] " << entries_.size() << " record(s) in " << path;
+    if (entries_.size() > indexed) std::cout << " (" << entries_.size() - indexed << " re-indexed)";
+    std::cout << "\n";
+    return true;
+}
+
+// Index the log from `from` on; a record that does not check out, and
+// everything after it, is cut off
+bool ImuResultsDb::recover(uint64_t from, uint64_t log_size) {
+    if (!seek_to(reader_, from)) return false;
+    std::vector<uint8_t> payload;
+    ImuResultRecord rec;
+    uint64_t pos = from;
+    while (pos + kRecordHead <= log_size) {
+        uint8_t head[kRecordHead];
+        if (std::fread(head, 1, sizeof(head), reader_) != sizeof(head)) break;
+        const uint32_t n   = get_le<uint32_t>(head);
+        const uint32_t sum = get_le<uint32_t>(head + 4);
+        if (n == 0 || n > kMaxPayload || pos + kRecordHead + n > log_size) break;
+        payload.resize(n);
+        if (std::fread(payload.data(), 1, n, reader_) != n) break;
+        if (fnv1a32(payload.data(), n) != sum || !decode(payload.data(), n, rec)) break;
+
+        Entry e{};
+        e.key     = imu_result_key(rec.result.device_id);
+        e.time_us = rec.time_us;
+        e.offset  = pos;
+        e.bytes   = uint32_t(kRecordHead + n);
+        e.status  = uint8_t(rec.result.status);
+        uint8_t bytes[32];
+        put_entry(bytes, e);
+        if (std::fwrite(bytes, 1, sizeof(bytes), index_) != sizeof(bytes)) return false;
+        add(e);
+        pos += e.bytes;
+    }
+    std::fflush(index_);
+    if (pos < log_size) {
+        std::cerr << "[results] ⚠️  " << log_size - pos << " torn byte(s) cut from the end of " << path_ << "\n";
+        std::fclose(reader_);
+        std::error_code ec;
+        std::filesystem::resize_file(path_, pos, ec);
+        reader_ = std::fopen(path_.c_str(), "rb");
+        if (ec || !reader_) return false;
+    }
+    return true;
+}
+
+void ImuResultsDb::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::FILE** fp : {&log_, &index_, &reader_}) {
+        if (*fp) std::fclose(*fp);
+        *fp = nullptr;
+    }
+    entries_.clear();
+    by_key_.clear();
+    ordered_   = true;
+    log_bytes_ = flushed_bytes_ = 0;
+}
+
+void ImuResultsDb::add(const Entry& e) {
+    if (!entries_.empty() && e.time_us < entries_.back().time_us) ordered_ = false;
+    by_key_[e.key].push_back(uint32_t(entries_.size()));
+    entries_.push_back(e);
+}
+
+bool ImuResultsDb::append(const ImuResultRecord& r) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!log_) return false;
+
+    buf_.assign(kRecordHead, '\0');
+    encode(r, buf_);
+    const uint32_t n = uint32_t(buf_.size() - kRecordHead);
+    const uint32_t sum = fnv1a32(reinterpret_cast<const uint8_t*>(buf_.data()) + kRecordHead, n);
+    for (size_t i = 0; i < 4; ++i) {
+        buf_[i]     = static_cast<char>((n >> (8 * i)) & 0xFF);
+        buf_[4 + i] = static_cast<char>((sum >> (8 * i)) & 0xFF);
+    }
+
+    Entry e{};
+    e.key     = imu_result_key(r.result.device_id);
+    e.time_us = r.time_us;
+    e.offset  = log_bytes_;
+    e.bytes   = uint32_t(buf_.size());
+    e.status  = uint8_t(r.result.status);
+    uint8_t bytes[32];
+    put_entry(bytes, e);
+
+    // Log first: an index entry whose record is missing is dropped at open
+    if (std::fwrite(buf_.data(), 1, buf_.size(), log_) != buf_.size() ||
+        std::fwrite(bytes, 1, sizeof(bytes), index_) != sizeof(bytes)) {
+        std::cerr << "[results] ❌ write failed on " << path_ << "\n";
+        return false;
+    }
+    log_bytes_ += e.bytes;
+    add(e);
+    return true;
+}
+
+void ImuResultsDb::sync() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!log_) return;
+    std::fflush(log_);
+    std::fflush(index_);
+    flushed_bytes_ = log_bytes_;
+}
+
+size_t ImuResultsDb::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+std::vector<ImuResultsDb::Entry> ImuResultsDb::history(uint64_t key, size_t limit) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Entry> out;
+    auto it = by_key_.find(key);
+    if (it == by_key_.end()) return out;
+    const auto& ids = it->second;
+    out.reserve(std::min(limit, ids.size()));
+    for (auto i = ids.rbegin(); i != ids.rend() && out.size() < limit; ++i) out.push_back(entries_[*i]);
+    if (!ordered_) {
+        std::stable_sort(out.begin(), out.end(),
+                         [](const Entry& a, const Entry& b) { return a.time_us > b.time_us; });
+    }
+    return out;
+}
+
+std::vector<ImuResultsDb::Entry> ImuResultsDb::range(int64_t t0_us, int64_t t1_us) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Entry> out;
+    if (ordered_) {
+        auto it = std::lower_bound(entries_.begin(), entries_.end(), t0_us,
+                                   [](const Entry& e, int64_t t) { return e.time_us < t; });
+        for (; it != entries_.end() && it->time_us < t1_us; ++it) out.push_back(*it);
+        return out;
+    }
+    for (const auto& e : entries_) {
+        if (e.time_us >= t0_us && e.time_us < t1_us) out.push_back(e);
+    }
+    std::stable_sort(out.begin(), out.end(),
+                     [](const Entry& a, const Entry& b) { return a.time_us < b.time_us; });
+    return out;
+}
+
+std::vector<ImuResultsDb::YieldBucket> ImuResultsDb::yield(int64_t t0_us, int64_t t1_us,
+                                                           int64_t bucket_us) const {
+    std::vector<YieldBucket> out;
+    if (bucket_us <= 0 || t1_us <= t0_us) return out;
+    const int64_t buckets = (t1_us - t0_us + bucket_us - 1) / bucket_us;
+    if (buckets > (int64_t(1) << 20)) return out;
+    out.resize(size_t(buckets));
+    for (int64_t b = 0; b < buckets; ++b) out[size_t(b)].start_us = t0_us + b * bucket_us;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto count = [&](const Entry& e) {
+        auto& b = out[size_t((e.time_us - t0_us) / bucket_us)];
+        if (e.status == uint8_t(QaStatus::PASS)) ++b.pass;
+        else if (e.status == uint8_t(QaStatus::WARN)) ++b.warn;
+        else ++b.fail;
+    };
+    auto first = entries_.begin();
+    if (ordered_) {
+        first = std::lower_bound(entries_.begin(), entries_.end(), t0_us,
+                                 [](const Entry& e, int64_t t) { return e.time_us < t; });
+    }
+    for (auto it = first; it != entries_.end(); ++it) {
+        if (it->time_us >= t1_us) {
+            if (ordered_) break;
+            continue;
+        }
+        if (it->time_us >= t0_us) count(*it);
+    }
+    return out;
+}
+
+bool ImuResultsDb::read(const Entry& e, ImuResultRecord& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!reader_ || e.bytes <= kRecordHead || e.bytes > kRecordHead + kMaxPayload) return false;
+    if (log_ && e.offset + e.bytes > flushed_bytes_) {
+        std::fflush(log_);
+        flushed_bytes_ = log_bytes_;
+    }
+    uint8_t stack[512];
+    std::vector<uint8_t> heap;
+    uint8_t* p = stack;
+    if (e.bytes > sizeof(stack)) {
+        heap.resize(e.bytes);
+        p = heap.data();
+    }
+    if (!seek_to(reader_, e.offset) || std::fread(p, 1, e.bytes, reader_) != e.bytes) return false;
+    const uint32_t n = get_le<uint32_t>(p);
+    if (n != e.bytes - kRecordHead || fnv1a32(p + kRecordHead, n) != get_le<uint32_t>(p + 4)) return false;
+    return decode(p + kRecordHead, n, out);
+}
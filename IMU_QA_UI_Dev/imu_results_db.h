@@ -0,0 +1,114 @@
+#pragma once
+#include "imu_types.h"
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One stored verdict with what it was graded under
+struct ImuResultRecord {
+    int64_t     time_us     = 0;   // wall clock, µs since the Unix epoch
+    uint64_t    config_hash = 0;   // imu_config_hash() of the run's settings
+    std::string firmware;          // as the unit reported it, empty if unknown
+    std::string profile;           // station test profile, see ImuQaConfig
+    ImuQaResult result{};
+};
+
+// FNV-1a over the settings that decide a verdict (windows, thresholds,
+// settle, spectrum, reference unit and profile), so results graded under
+// different limits can be told apart
+uint64_t imu_config_hash(const ImuQaConfig& cfg);
+
+// Index key of a device id: the packed MAC, or for ids that are not a MAC
+// a hash of the id with the top bit set (packed MACs use 48 bits)
+uint64_t imu_result_key(const std::string& device_id);
+
+// Append-only results store: a log of records and a fixed-size index
+// beside it, both only ever appended to.
+//
+//   <path>      "IMUR" u8 version 0 0 0, then per record
+//               u32 payload_bytes u32 fnv1a32(payload) payload
+//   <path>.idx  one Entry (32 bytes, little endian) per record, in log order
+//
+// The index is held in memory: entries in append order plus each key's
+// entry numbers, so a unit's history is a hash lookup and a time range a
+// binary search while the stamps only grow. Yield trends come from the
+// index alone; full records are read from the log on demand. open() checks
+// the index against the log, re-indexes records the index is missing and
+// cuts a torn record off the end of the log.
+//
+// append() only encodes into a buffer and writes through stdio, so it
+// costs about a microsecond; sync() or close() flushes. Safe to query from
+// other threads while results are appended.
+class ImuResultsDb {
+public:
+    struct Entry {
+        uint64_t key;
+        int64_t  time_us;
+        uint64_t offset;    // record start in the log
+        uint32_t bytes;     // record length, header included
+        uint8_t  status;    // QaStatus
+        uint8_t  reserved[3];
+    };
+    static_assert(sizeof(Entry) == 32, "index entries are 32 bytes on disk");
+
+    struct YieldBucket {
+        int64_t  start_us;
+        uint32_t pass = 0, warn = 0, fail = 0;
+    };
+
+    ImuResultsDb() = default;
+    ~ImuResultsDb();
+
+    ImuResultsDb(const ImuResultsDb&) = delete;
+    ImuResultsDb& operator=(const ImuResultsDb&) = delete;
+
+    // Opens or creates the store; false if it cannot be read or written
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const { return log_ != nullptr; }
+
+    bool append(const ImuResultRecord& r);
+    void sync();
+
+    size_t size() const;
+
+    // A unit's records, newest first
+    std::vector<Entry> history(uint64_t key, size_t limit = std::numeric_limits<size_t>::max()) const;
+    std::vector<Entry> history(const std::string& device_id,
+                               size_t limit = std::numeric_limits<size_t>::max()) const {
+        return history(imu_result_key(device_id), limit);
+    }
+
+    // Records stamped in [t0_us, t1_us), oldest first
+    std::vector<Entry> range(int64_t t0_us, int64_t t1_us) const;
+
+    // PASS / WARN / FAIL counts per bucket_us over [t0_us, t1_us)
+    std::vector<YieldBucket> yield(int64_t t0_us, int64_t t1_us, int64_t bucket_us) const;
+
+    bool read(const Entry& e, ImuResultRecord& out) const;
+
+    // Record payload codec
+    static void encode(const ImuResultRecord& r, std::string& out);
+    static bool decode(const uint8_t* p, size_t n, ImuResultRecord& out);
+
+private:
+    mutable std::mutex mutex_;
+    std::string path_;
+    std::FILE*  log_   = nullptr;   // append
+    std::FILE*  index_ = nullptr;   // append
+    mutable std::FILE* reader_ = nullptr;
+    uint64_t    log_bytes_ = 0;     // written, flushed or not
+    mutable uint64_t flushed_bytes_ = 0;
+
+    std::vector<Entry> entries_;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> by_key_;
+    bool        ordered_ = true;    // time_us non-decreasing over entries_
+    std::string buf_;
+
+    void add(const Entry& e);
+    bool recover(uint64_t from, uint64_t log_size);
+};
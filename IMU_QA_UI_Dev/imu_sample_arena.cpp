@@ -0,0 +1,312 @@
+#include "imu_sample_arena.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#define PSAPI_VERSION 2   // K32 entry points in kernel32, no psapi.lib
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// ---- ImuChunkPool ------------------------------------------------------------
+
+ImuChunkPool& ImuChunkPool::shared() {
+    static ImuChunkPool pool;
+    return pool;
+}
+
+ImuChunkPool::~ImuChunkPool() {
+    trim();
+}
+
+ImuChunkPool::Chunk* ImuChunkPool::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_) {
+            Chunk* c = free_;
+            free_ = c->next;
+            --idle_;
+            c->next = nullptr;
+            return c;
+        }
+        ++allocated_;
+    }
+    Chunk* c = new Chunk;
+    c->next = nullptr;
+    return c;
+}
+
+void ImuChunkPool::release(Chunk* head, Chunk* tail, size_t count) {
+    if (!head) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    tail->next = free_;
+    free_ = head;
+    idle_ += count;
+}
+
+void ImuChunkPool::prefill(size_t chunks) {
+    size_t have;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        have = idle_;
+    }
+    for (; have < chunks; ++have) {
+        Chunk* c = new Chunk;
+        std::lock_guard<std::mutex> lock(mutex_);
+        c->next = free_;
+        free_ = c;
+        ++idle_;
+        ++allocated_;
+    }
+}
+
+size_t ImuChunkPool::trim() {
+    Chunk* list;
+    size_t n;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        list = free_;
+        n    = idle_;
+        free_ = nullptr;
+        idle_ = 0;
+        allocated_ -= n;
+    }
+    while (list) {
+        Chunk* next = list->next;
+        delete list;
+        list = next;
+    }
+    return n * sizeof(Chunk);
+}
+
+size_t ImuChunkPool::idle_chunks() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_;
+}
+
+size_t ImuChunkPool::allocated_chunks() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocated_;
+}
+
+// ---- ImuSampleChunks ---------------------------------------------------------
+
+namespace {
+
+constexpr size_t kSlotMask = ImuChunkPool::kChunkSamples - 1;
+constexpr int64_t kMaxOffset = (int64_t(1) << 30) - 1;
+
+inline int16_t to_counts(float v, double counts_per_unit) {
+    double c = std::round(static_cast<double>(v) * counts_per_unit);
+    return static_cast<int16_t>(std::clamp(c, -32768.0, 32767.0));
+}
+
+} // namespace
+
+void ImuSampleChunks::set_scale(float accel_g, float gyro_dps) {
+    if (!empty() || accel_g <= 0.0f || gyro_dps <= 0.0f) return;
+    accel_scale_  = accel_g;
+    gyro_scale_   = gyro_dps;
+    accel_counts_ = 1.0 / double(accel_g);
+    gyro_counts_  = 1.0 / double(gyro_dps);
+}
+
+void ImuSampleChunks::grow() {
+    ImuChunkPool::Chunk* c = pool_->acquire();
+    if (!chunks_.empty()) chunks_.back()->next = c;
+    chunks_.push_back(c);
+}
+
+void ImuSampleChunks::reserve(size_t n) {
+    const size_t need = (head_ + n + ImuChunkPool::kChunkSamples - 1) >> ImuChunkPool::kChunkShift;
+    while (chunks_.size() < need) grow();
+}
+
+// Accel and gyro arrive as separate frames, so only one triple is stored
+void ImuSampleChunks::encode(ImuChunkPool::Chunk* c, size_t slot, const ImuSample& s) const {
+    const bool accel = s.ax != 0.0f || s.ay != 0.0f || s.az != 0.0f;
+    if (accel) {
+        c->x[slot] = to_counts(s.ax, accel_counts_);
+        c->y[slot] = to_counts(s.ay, accel_counts_);
+        c->z[slot] = to_counts(s.az, accel_counts_);
+    } else {
+        c->x[slot] = to_counts(s.gx, gyro_counts_);
+        c->y[slot] = to_counts(s.gy, gyro_counts_);
+        c->z[slot] = to_counts(s.gz, gyro_counts_);
+    }
+    // Only a queue left undrained for over an hour gets here clamped
+    const int64_t off = std::clamp<int64_t>(std::llround((s.timestamp_s - c->base_s) / kTickS),
+                                            -kMaxOffset, kMaxOffset);
+    c->tk[slot] = static_cast<int32_t>(off * 2 + (accel ? 1 : 0));
+}
+
+void ImuSampleChunks::append(const ImuSample* p, size_t n) {
+    for (size_t k = 0; k < n; ++k) {
+        const size_t pos = head_ + size_;
+        if (pos == chunks_.size() * ImuChunkPool::kChunkSamples) grow();
+        ImuChunkPool::Chunk* c = chunks_[pos >> ImuChunkPool::kChunkShift];
+        const size_t slot = pos & kSlotMask;
+        if (slot == 0) c->base_s = p[k].timestamp_s;
+        encode(c, slot, p[k]);
+        ++size_;
+    }
+}
+
+ImuSample ImuSampleChunks::operator[](size_t i) const {
+    i += head_;
+    const ImuChunkPool::Chunk* c = chunks_[i >> ImuChunkPool::kChunkShift];
+    const size_t slot = i & kSlotMask;
+    const int32_t tk  = c->tk[slot];
+
+    ImuSample s{};
+    s.timestamp_s = time_of(c->base_s, tk);
+    if (is_accel(tk)) {
+        s.ax = float(c->x[slot]) * accel_scale_;
+        s.ay = float(c->y[slot]) * accel_scale_;
+        s.az = float(c->z[slot]) * accel_scale_;
+    } else {
+        s.gx = float(c->x[slot]) * gyro_scale_;
+        s.gy = float(c->y[slot]) * gyro_scale_;
+        s.gz = float(c->z[slot]) * gyro_scale_;
+    }
+    return s;
+}
+
+void ImuSampleChunks::set(size_t i, const ImuSample& s) {
+    i += head_;
+    encode(chunks_[i >> ImuChunkPool::kChunkShift], i & kSlotMask, s);
+}
+
+void ImuSampleChunks::pop_front(size_t n) {
+    n = std::min(n, size_);
+    if (n == size_) {
+        clear();
+        return;
+    }
+    head_ += n;
+    size_ -= n;
+    const size_t whole = head_ >> ImuChunkPool::kChunkShift;
+    if (whole == 0) return;
+    pool_->release(chunks_.front(), chunks_[whole - 1], whole);
+    chunks_.erase(chunks_.begin(), chunks_.begin() + static_cast<std::ptrdiff_t>(whole));
+    head_ &= kSlotMask;
+}
+
+void ImuSampleChunks::truncate(size_t n) {
+    size_ = std::min(n, size_);
+}
+
+void ImuSampleChunks::copy_to(size_t first, size_t n, ImuSample* out) const {
+    n = std::min(n, size_ > first ? size_ - first : 0);
+    for (size_t k = 0; k < n; ++k) out[k] = (*this)[first + k];
+}
+
+void ImuSampleChunks::clear() {
+    if (!chunks_.empty()) {
+        chunks_.back()->next = nullptr;
+        pool_->release(chunks_.front(), chunks_.back(), chunks_.size());
+        chunks_.clear();   // pointers only, no per-element work
+    }
+    head_ = 0;
+    size_ = 0;
+}
+
+// ---- Kernels -----------------------------------------------------------------
+
+// Branch-free over each span so the loop vectorises; the scale is applied
+// once per span since |a| is linear in it
+double imu_mean_accel_magnitude(const ImuSampleChunks& samples, size_t* frames) {
+    double sum   = 0.0;
+    size_t count = 0;
+    samples.for_each_span([&](const ImuFrameSpan& sp) {
+        double   part = 0.0;
+        uint32_t n    = 0;
+        for (size_t j = 0; j < sp.n; ++j) {
+            const float x = sp.x[j], y = sp.y[j], z = sp.z[j];
+            const float m = std::sqrt(x * x + y * y + z * z);
+            const uint32_t a = uint32_t(sp.tk[j]) & 1u;
+            part += a ? double(m) : 0.0;
+            n    += a;
+        }
+        sum   += part;
+        count += n;
+    });
+    if (frames) *frames = count;
+    return count > 0 ? sum * double(samples.accel_scale()) / double(count) : 0.0;
+}
+
+size_t imu_unpack_axes(const ImuSampleChunks& samples, bool accel,
+                       float* x, float* y, float* z, double* first_s, double* last_s) {
+    const float   scale = accel ? samples.accel_scale() : samples.gyro_scale();
+    const int32_t want  = accel ? 1 : 0;
+    size_t n = 0;
+    samples.for_each_span([&](const ImuFrameSpan& sp) {
+        for (size_t j = 0; j < sp.n; ++j) {
+            if ((sp.tk[j] & 1) != want) continue;
+            if (n == 0 && first_s) *first_s = ImuSampleChunks::time_of(sp.base_s, sp.tk[j]);
+            if (last_s) *last_s = ImuSampleChunks::time_of(sp.base_s, sp.tk[j]);
+            x[n] = float(sp.x[j]) * scale;
+            y[n] = float(sp.y[j]) * scale;
+            z[n] = float(sp.z[j]) * scale;
+            ++n;
+        }
+    });
+    return n;
+}
+
+// ---- RSS ---------------------------------------------------------------------
+
+#ifdef __linux__
+static size_t status_kib(const char* key) {
+    std::ifstream f("/proc/self/status");
+    std::string line;
+    const size_t len = std::strlen(key);
+    while (std::getline(f, line)) {
+        if (line.compare(0, len, key) == 0) return std::stoull(line.substr(len)) * 1024;
+    }
+    return 0;
+}
+#endif
+
+size_t imu_current_rss_bytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc{};
+    return K32GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) ? pmc.WorkingSetSize : 0;
+#elif defined(__linux__)
+    return status_kib("VmRSS:");
+#else
+    return 0;
+#endif
+}
+
+size_t imu_peak_rss_bytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc{};
+    return K32GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) ? pmc.PeakWorkingSetSize : 0;
+#elif defined(__linux__)
+    return status_kib("VmHWM:");
+#else
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    return static_cast<size_t>(ru.ru_maxrss);   // bytes on macOS
+#endif
+}
+
+bool imu_reset_peak_rss() {
+#ifdef __linux__
+    std::ofstream f("/proc/self/clear_refs");
+    f << "5";
+    return static_cast<bool>(f.flush());
+#else
+    return false;
+#endif
+}
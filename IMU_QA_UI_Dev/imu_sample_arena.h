@@ -0,0 +1,177 @@
+#pragma once
+#include "imu_types.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+// Fixed-size blocks of frames, recycled through a process-wide free list so
+// a new run reuses the previous run's memory instead of going back to the
+// allocator. Chunks are linked, which lets a whole run be handed back with
+// one splice.
+class ImuChunkPool {
+public:
+    static constexpr size_t kChunkShift   = 12;
+    static constexpr size_t kChunkSamples = size_t(1) << kChunkShift;   // 40 KiB of frames
+
+    // Frames as the device sends them: int16 counts per axis and a time
+    // offset from the chunk's first frame. Columns, so kernels stream one
+    // axis at a time. Left uninitialised: pages are touched on first write.
+    struct Chunk {
+        Chunk*  next;
+        double  base_s;                   // host time the offsets count from
+        int32_t tk[kChunkSamples];        // (offset ticks << 1) | accel
+        int16_t x[kChunkSamples];
+        int16_t y[kChunkSamples];
+        int16_t z[kChunkSamples];
+    };
+
+    static ImuChunkPool& shared();
+
+    ImuChunkPool() = default;
+    ~ImuChunkPool();
+    ImuChunkPool(const ImuChunkPool&) = delete;
+    ImuChunkPool& operator=(const ImuChunkPool&) = delete;
+
+    Chunk* acquire();
+    // head..tail linked through next, count chunks; O(1)
+    void   release(Chunk* head, Chunk* tail, size_t count);
+
+    void   prefill(size_t chunks);   // allocate ahead of a run
+    size_t trim();                   // free idle chunks, returns bytes
+
+    size_t idle_chunks() const;
+    size_t allocated_chunks() const;
+
+private:
+    mutable std::mutex mutex_;
+    Chunk* free_      = nullptr;
+    size_t idle_      = 0;
+    size_t allocated_ = 0;
+};
+
+// Contiguous run of frames inside one chunk, for kernels that convert
+// counts on the fly instead of going through ImuSample
+struct ImuFrameSpan {
+    double         base_s;
+    const int32_t* tk;
+    const int16_t* x;
+    const int16_t* y;
+    const int16_t* z;
+    size_t         n;
+};
+
+// Sample sequence stored as compact frames in pool chunks, 10 bytes per
+// frame against 40 for ImuSample. Counts are scaled back to g / deg/s when
+// read; timestamps keep kTickS resolution and temp is not stored (the
+// device does not send it). Appending never moves existing frames,
+// indexing is a shift and a mask, and clear() returns every chunk to the
+// pool in constant time. Not thread safe (ImuSampleBuffer locks).
+class ImuSampleChunks {
+public:
+    static constexpr size_t kFrameBytes = 3 * sizeof(int16_t) + sizeof(int32_t);
+    static constexpr double kTickS      = 4e-6;   // offsets reach +-71 min
+
+    static bool   is_accel(int32_t tk) { return (tk & 1) != 0; }
+    static double time_of(double base_s, int32_t tk) { return base_s + double(tk >> 1) * kTickS; }
+
+    explicit ImuSampleChunks(ImuChunkPool* pool = &ImuChunkPool::shared()) : pool_(pool) {}
+    ~ImuSampleChunks() { clear(); }
+
+    ImuSampleChunks(const ImuSampleChunks&) = delete;
+    ImuSampleChunks& operator=(const ImuSampleChunks&) = delete;
+
+    // Units per count of each stream; only while empty
+    void  set_scale(float accel_g, float gyro_dps);
+    float accel_scale() const { return accel_scale_; }
+    float gyro_scale() const  { return gyro_scale_; }
+
+    // Take chunks for n samples in total now, so the run never allocates
+    void reserve(size_t n);
+
+    void push_back(const ImuSample& s) { append(&s, 1); }
+    void append(const ImuSample* p, size_t n);
+
+    size_t size() const  { return size_; }
+    bool   empty() const { return size_ == 0; }
+    size_t chunk_count() const { return chunks_.size(); }
+
+    ImuSample operator[](size_t i) const;
+    void      set(size_t i, const ImuSample& s);   // re-encodes against i's chunk
+    bool      is_accel(size_t i) const {
+        const size_t k = i + head_;
+        return is_accel(chunks_[k >> ImuChunkPool::kChunkShift]->tk[k & (ImuChunkPool::kChunkSamples - 1)]);
+    }
+
+    void pop_front(size_t n);   // drained chunks go back to the pool
+    void truncate(size_t n);    // keep the first n
+    void copy_to(size_t first, size_t n, ImuSample* out) const;
+    void clear();               // O(1)
+
+    // Calls f(const ImuFrameSpan&) for each chunk's frames, oldest first
+    template <class F>
+    void for_each_span(F&& f) const {
+        size_t first = head_, left = size_;
+        for (size_t c = 0; left > 0; ++c) {
+            const ImuChunkPool::Chunk* k = chunks_[c];
+            const size_t n = std::min(left, ImuChunkPool::kChunkSamples - first);
+            f(ImuFrameSpan{k->base_s, k->tk + first, k->x + first, k->y + first, k->z + first, n});
+            left -= n;
+            first = 0;
+        }
+    }
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = ImuSample;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = ImuSample;   // decoded on the fly
+
+        const_iterator(const ImuSampleChunks* c, size_t i) : c_(c), i_(i) {}
+        reference operator*() const { return (*c_)[i_]; }
+        const_iterator& operator++() { ++i_; return *this; }
+        bool operator==(const const_iterator& o) const { return i_ == o.i_; }
+        bool operator!=(const const_iterator& o) const { return i_ != o.i_; }
+
+    private:
+        const ImuSampleChunks* c_;
+        size_t                 i_;
+    };
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const   { return const_iterator(this, size_); }
+
+private:
+    ImuChunkPool*                     pool_;
+    std::vector<ImuChunkPool::Chunk*> chunks_;   // in order, also linked
+    size_t head_ = 0;                            // first sample's slot in chunks_[0]
+    size_t size_ = 0;
+
+    float accel_scale_ = float(1.0 / kAccelCountsPerG);
+    float gyro_scale_  = float(1.0 / kGyroCountsPerDps);
+    double accel_counts_ = kAccelCountsPerG;
+    double gyro_counts_  = kGyroCountsPerDps;
+
+    void grow();
+    void encode(ImuChunkPool::Chunk* c, size_t slot, const ImuSample& s) const;
+};
+
+// Kernels over the stored counts. Mean |a| of the accel frames in g
+// (0 when there are none), count of accel frames in *frames.
+double imu_mean_accel_magnitude(const ImuSampleChunks& samples, size_t* frames);
+
+// Accel (accel = true) or gyro axes of every frame of that stream, in
+// units, into x / y / z (room for samples.size() each). Returns the count;
+// first / last frame times go to *first_s / *last_s when any.
+size_t imu_unpack_axes(const ImuSampleChunks& samples, bool accel,
+                       float* x, float* y, float* z, double* first_s, double* last_s);
+
+// Resident set of this process now and at its peak, bytes (0 if unknown).
+// On Linux the peak can be reset, so a phase can be measured on its own.
+size_t imu_current_rss_bytes();
+size_t imu_peak_rss_bytes();
+bool   imu_reset_peak_rss();
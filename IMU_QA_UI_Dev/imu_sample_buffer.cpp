@@ -0,0 +1,250 @@
+#include "imu_sample_buffer.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+
+// Station reservations are taken in chunks so the shared atomic is not
+// touched for every sample
+constexpr size_t kReserveChunk = 1024;
+
+// Bytes a sample occupies in the buffer (compact frame, not ImuSample)
+constexpr size_t kSampleBytes = ImuSampleChunks::kFrameBytes;
+
+// Bytes a sample occupies in the spill file (whole ImuSample record)
+constexpr size_t kSpillRecordBytes = sizeof(ImuSample);
+
+} // namespace
+
+bool ImuMemoryBudget::try_reserve(size_t bytes) {
+    size_t cur = used_.load(std::memory_order_relaxed);
+    do {
+        if (cur + bytes > limit_) return false;
+    } while (!used_.compare_exchange_weak(cur, cur + bytes, std::memory_order_relaxed));
+
+    size_t now  = cur + bytes;
+    size_t peak = peak_.load(std::memory_order_relaxed);
+    while (now > peak && !peak_.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+    return true;
+}
+
+void ImuMemoryBudget::release(size_t bytes) {
+    used_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+ImuSampleBuffer::~ImuSampleBuffer() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (station_ && reserved_) station_->release(reserved_ * kSampleBytes);
+    reserved_ = 0;
+    if (spill_) std::fclose(spill_);
+}
+
+void ImuSampleBuffer::configure(size_t capacity_bytes, const ImuBufferConfig& cfg,
+                                ImuMemoryBudget* station, const std::string& spill_name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (station_ && reserved_) station_->release(reserved_ * kSampleBytes);
+    reserved_ = 0;
+
+    capacity_        = std::max<size_t>(capacity_bytes / kSampleBytes, 2);
+    policy_          = cfg.policy;
+    block_timeout_s_ = cfg.block_timeout_s;
+    station_         = station;
+
+    std::string name = spill_name;
+    std::replace(name.begin(), name.end(), ':', '-');
+    spill_path_ = (std::filesystem::path(cfg.spill_directory) / (name + ".bin")).string();
+}
+
+void ImuSampleBuffer::reserve(size_t n) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buf_.reserve(std::min(n, capacity_));
+}
+
+void ImuSampleBuffer::push(const ImuSample& s) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (buf_.size() < capacity_ && (!station_ || buf_.size() < reserved_)) {
+        buf_.push_back(s);
+        note_size_locked();
+        return;
+    }
+    if (!make_room_locked(lock, 1)) {
+        ++stats_.dropped;
+        return;
+    }
+    buf_.push_back(s);
+    note_size_locked();
+}
+
+void ImuSampleBuffer::push(const ImuSample* samples, size_t count) {
+    if (count == 0) return;
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // Larger than the whole buffer: only the newest capacity_ samples can stay
+    if (count > capacity_) {
+        stats_.dropped += count - capacity_;
+        samples += count - capacity_;
+        count = capacity_;
+    }
+    if (!fits_locked(count) && !make_room_locked(lock, count)) {
+        stats_.dropped += count;
+        return;
+    }
+    buf_.append(samples, count);
+    note_size_locked();
+}
+
+std::vector<ImuSample> ImuSampleBuffer::drain() {
+    std::vector<ImuSample> out;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        out.resize(buf_.size());
+        buf_.copy_to(0, buf_.size(), out.data());
+        buf_.clear();
+        trim_reservation_locked();
+    }
+    not_full_.notify_all();
+    return out;
+}
+
+void ImuSampleBuffer::clear() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buf_.clear();
+        trim_reservation_locked();
+    }
+    not_full_.notify_all();
+}
+
+bool ImuSampleBuffer::has_room(size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return fits_locked(count);
+}
+
+size_t ImuSampleBuffer::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return buf_.size();
+}
+
+ImuOverflowStats ImuSampleBuffer::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void ImuSampleBuffer::reset_stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_ = ImuOverflowStats{};
+}
+
+bool ImuSampleBuffer::fits_locked(size_t count) {
+    const size_t need = buf_.size() + count;
+    if (need > capacity_) return false;
+    if (!station_) return true;
+    while (reserved_ < need) {
+        if (!station_->try_reserve(kReserveChunk * kSampleBytes)) return false;
+        reserved_ += kReserveChunk;
+    }
+    return true;
+}
+
+bool ImuSampleBuffer::make_room_locked(std::unique_lock<std::mutex>& lock, size_t count) {
+    if (fits_locked(count)) return true;
+
+    if (policy_ == OverflowPolicy::Block) {
+        ++stats_.blocked;
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                            std::chrono::duration<double>(block_timeout_s_));
+        while (!fits_locked(count)) {
+            if (not_full_.wait_until(lock, deadline) == std::cv_status::timeout) {
+                return fits_locked(count);
+            }
+        }
+        return true;
+    }
+
+    // Shrink until the new samples fit; give up if even an empty buffer does
+    // not (station budget exhausted by other devices)
+    while (!fits_locked(count) && !buf_.empty()) {
+        switch (policy_) {
+            case OverflowPolicy::DropOldest:
+                drop_oldest_locked(std::max<size_t>(count, buf_.size() / 8));
+                break;
+            case OverflowPolicy::Decimate:
+                if (buf_.size() < 4) {
+                    drop_oldest_locked(buf_.size());
+                } else {
+                    decimate_locked();
+                }
+                break;
+            case OverflowPolicy::SpillToDisk:
+                spill_oldest_locked(std::max<size_t>(count, buf_.size() / 2));
+                break;
+            case OverflowPolicy::Block:
+                break;
+        }
+        trim_reservation_locked();
+    }
+    return fits_locked(count);
+}
+
+void ImuSampleBuffer::drop_oldest_locked(size_t count) {
+    count = std::min(count, buf_.size());
+    buf_.pop_front(count);
+    stats_.dropped += count;
+}
+
+// Keep every other accel and every other gyro sample, oldest to newest.
+// Sensors are decimated independently so neither stream disappears.
+void ImuSampleBuffer::decimate_locked() {
+    bool keep_accel = true;
+    bool keep_gyro  = true;
+    size_t w = 0;
+    for (size_t i = 0; i < buf_.size(); ++i) {
+        bool& keep = buf_.is_accel(i) ? keep_accel : keep_gyro;
+        if (keep) buf_.set(w++, buf_[i]);
+        keep = !keep;
+    }
+    stats_.decimated += buf_.size() - w;
+    buf_.truncate(w);
+}
+
+// Spill file: raw ImuSample records, appended in arrival order
+void ImuSampleBuffer::spill_oldest_locked(size_t count) {
+    count = std::min(count, buf_.size());
+    if (!spill_) {
+        std::error_code ec;
+        std::filesystem::create_directories(
+            std::filesystem::path(spill_path_).parent_path(), ec);
+        spill_ = std::fopen(spill_path_.c_str(), "ab");
+        if (!spill_) {
+            std::cerr << "[buffer] Cannot open spill file " << spill_path_
+                      << ", dropping instead\n";
+            drop_oldest_locked(count);
+            return;
+        }
+    }
+
+    std::vector<ImuSample> tmp(count);
+    buf_.copy_to(0, count, tmp.data());
+    size_t n = std::fwrite(tmp.data(), kSpillRecordBytes, tmp.size(), spill_);
+    std::fflush(spill_);
+    buf_.pop_front(count);
+    stats_.spilled += n;
+    stats_.dropped += count - n;
+}
+
+void ImuSampleBuffer::trim_reservation_locked() {
+    if (!station_) return;
+    size_t keep = (buf_.size() + kReserveChunk - 1) / kReserveChunk * kReserveChunk;
+    if (reserved_ > keep) {
+        station_->release((reserved_ - keep) * kSampleBytes);
+        reserved_ = keep;
+    }
+}
+
+void ImuSampleBuffer::note_size_locked() {
+    size_t bytes = buf_.size() * kSampleBytes;
+    if (bytes > stats_.peak_bytes) stats_.peak_bytes = bytes;
+}
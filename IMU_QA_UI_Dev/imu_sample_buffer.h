@@ -0,0 +1,88 @@
+#pragma once
+#include "imu_sample_arena.h"
+#include "imu_types.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Station-wide byte budget shared by every sample buffer
+class ImuMemoryBudget {
+public:
+    explicit ImuMemoryBudget(size_t limit_bytes) : limit_(limit_bytes) {}
+
+    bool try_reserve(size_t bytes);
+    void release(size_t bytes);
+
+    size_t used() const  { return used_; }
+    size_t peak() const  { return peak_; }
+    size_t limit() const { return limit_; }
+
+private:
+    const size_t        limit_;
+    std::atomic<size_t> used_{0};
+    std::atomic<size_t> peak_{0};
+};
+
+// Thread-safe FIFO of samples with a byte cap and an overflow policy.
+// Used both for the BLE callback -> drain queue in each session and for the
+// per-run accumulation in ImuQaManager. Unbounded until configure() is called.
+class ImuSampleBuffer {
+public:
+    ImuSampleBuffer() = default;
+    ~ImuSampleBuffer();
+
+    ImuSampleBuffer(const ImuSampleBuffer&) = delete;
+    ImuSampleBuffer& operator=(const ImuSampleBuffer&) = delete;
+
+    // capacity_bytes: this buffer's limit; station: optional shared limit;
+    // spill_name: file stem under cfg.spill_directory for SpillToDisk
+    void configure(size_t capacity_bytes, const ImuBufferConfig& cfg,
+                   ImuMemoryBudget* station, const std::string& spill_name);
+
+    // Take storage for n samples up front (clamped to the capacity), so
+    // pushes during the run neither allocate nor move earlier samples
+    void reserve(size_t n);
+
+    void push(const ImuSample& s);
+    void push(const ImuSample* samples, size_t count);
+
+    // Move everything out and release the memory reservation
+    std::vector<ImuSample> drain();
+    void clear();
+
+    bool   has_room(size_t count);
+    size_t size() const;
+
+    // Direct access for single-threaded consumers (no concurrent push)
+    const ImuSampleChunks& samples() const { return buf_; }
+
+    ImuOverflowStats stats() const;
+    void reset_stats();
+
+private:
+    mutable std::mutex      mutex_;
+    std::condition_variable not_full_;
+    ImuSampleChunks         buf_;   // pool chunks; clear() is O(1)
+
+    size_t           capacity_        = static_cast<size_t>(-1);   // samples
+    OverflowPolicy   policy_          = OverflowPolicy::DropOldest;
+    double           block_timeout_s_ = 0.05;
+    ImuMemoryBudget* station_         = nullptr;
+    size_t           reserved_        = 0;   // samples reserved from station_
+
+    std::string spill_path_;
+    std::FILE*  spill_ = nullptr;
+
+    ImuOverflowStats stats_;
+
+    bool fits_locked(size_t count);
+    bool make_room_locked(std::unique_lock<std::mutex>& lock, size_t count);
+    void drop_oldest_locked(size_t count);
+    void decimate_locked();
+    void spill_oldest_locked(size_t count);
+    void trim_reservation_locked();
+    void note_size_locked();
+};
@@ -0,0 +1,148 @@
+#include "imu_settle.h"
+#include <algorithm>
+
+void ImuSettleEstimator::reset(double start_s) {
+    from_s_ = start_s + cfg_.skip_s;
+    for (auto& a : accel_) a.reset();
+    for (auto& g : gyro_) g.reset();
+    window_.clear();
+    for (int k = 0; k < 3; ++k) sum_[k] = sum_sq_[k] = 0.0;
+    window_still_ = false;
+}
+
+void ImuSettleEstimator::push_gyro(double t, const float v[3]) {
+    window_.push_back(GyroFrame{t, {v[0], v[1], v[2]}});
+    for (int k = 0; k < 3; ++k) {
+        sum_[k]    += v[k];
+        sum_sq_[k] += double(v[k]) * v[k];
+    }
+    while (window_.size() > 1 && t - window_[1].t >= cfg_.still_window_s) {
+        const GyroFrame& old = window_.front();
+        for (int k = 0; k < 3; ++k) {
+            sum_[k]    -= old.v[k];
+            sum_sq_[k] -= double(old.v[k]) * old.v[k];
+        }
+        window_.pop_front();
+    }
+
+    const size_t n = window_.size();
+    if (n < 2 || t - window_.front().t < cfg_.still_window_s) return;   // not a full window yet
+    double worst = 0.0;
+    for (int k = 0; k < 3; ++k) {
+        const double var = (sum_sq_[k] - sum_[k] * sum_[k] / double(n)) / double(n - 1);
+        worst = std::max(worst, var);
+    }
+    window_still_ = worst <= stillness_dps_ * stillness_dps_;
+    if (!window_still_) {
+        // Moving: what was averaged so far is not a rest estimate
+        for (auto& a : accel_) a.reset();
+        for (auto& g : gyro_) g.reset();
+    }
+}
+
+bool ImuSettleEstimator::still() const {
+    return window_still_ && accel_[0].n >= cfg_.min_frames && gyro_[0].n >= cfg_.min_frames;
+}
+
+void ImuSettleEstimator::push(const ImuSample* s, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        const ImuSample& f = s[i];
+        if (f.timestamp_s < from_s_) continue;
+        // Accel and gyro arrive as separate frames, the other half is zero
+        if (f.ax != 0.0f || f.ay != 0.0f || f.az != 0.0f) {
+            accel_[0].push(f.ax);
+            accel_[1].push(f.ay);
+            accel_[2].push(f.az);
+        } else {
+            gyro_[0].push(f.gx);
+            gyro_[1].push(f.gy);
+            gyro_[2].push(f.gz);
+            const float v[3] = {f.gx, f.gy, f.gz};
+            push_gyro(f.timestamp_s, v);
+        }
+    }
+}
+
+ImuSettleEstimate ImuSettleEstimator::estimate() const {
+    ImuSettleEstimate e;
+    e.accel_frames = size_t(accel_[0].n);
+    e.gyro_frames  = size_t(gyro_[0].n);
+    for (int k = 0; k < 3; ++k) {
+        e.gyro_bias_dps[k] = float(gyro_[k].mean);
+        e.gravity_g[k]     = float(accel_[k].mean);
+        e.gyro_sigma_dps   = std::max(e.gyro_sigma_dps, gyro_[k].sigma());
+    }
+    e.valid = e.accel_frames >= cfg_.min_frames && e.gyro_frames >= cfg_.min_frames &&
+              e.gyro_sigma_dps <= stillness_dps_;
+    return e;
+}
+
+ImuBatchSettle::ImuBatchSettle(const ImuSettleConfig& cfg, double stillness_dps, size_t units,
+                               double t0_s, double limit_s)
+    : cfg_(cfg), limit_s_(limit_s), estimates_(units), settling_(units, 1), ready_(units, 0) {
+    est_.reserve(units);
+    for (size_t i = 0; i < units; ++i) {
+        est_.emplace_back(cfg, stillness_dps);
+        est_.back().reset(t0_s);
+    }
+}
+
+void ImuBatchSettle::push(size_t i, const ImuSample* s, size_t n) {
+    if (settling_[i]) est_[i].push(s, n);
+}
+
+void ImuBatchSettle::poll(double now_s, bool common_start, std::vector<size_t>& started) {
+    bool all_ready = true;
+    for (size_t i = 0; i < est_.size(); ++i) {
+        if (!settling_[i]) continue;
+        ready_[i] = now_s >= limit_s_ || (cfg_.adaptive && est_[i].still());
+        all_ready = all_ready && ready_[i];
+    }
+    for (size_t i = 0; i < est_.size(); ++i) {
+        if (settling_[i] && (common_start ? all_ready : ready_[i] != 0)) started.push_back(i);
+    }
+}
+
+const ImuSettleEstimate& ImuBatchSettle::finish(size_t i) {
+    settling_[i] = 0;
+    if (cfg_.calibrate) estimates_[i] = est_[i].estimate();
+    return estimates_[i];
+}
+
+bool ImuBatchSettle::settling_any() const {
+    return std::find(settling_.begin(), settling_.end(), 1) != settling_.end();
+}
+
+void ImuBatchSettle::remove_bias(size_t i, ImuSample* s, size_t n) const {
+    if (applied(i)) imu_remove_gyro_bias(s, n, estimates_[i].gyro_bias_dps);
+}
+
+void imu_remove_gyro_bias(ImuSample* s, size_t n, const float bias_dps[3]) {
+    for (size_t i = 0; i < n; ++i) {
+        ImuSample& f = s[i];
+        if (f.ax != 0.0f || f.ay != 0.0f || f.az != 0.0f) continue;
+        f.gx -= bias_dps[0];
+        f.gy -= bias_dps[1];
+        f.gz -= bias_dps[2];
+    }
+}
+
+void imu_fold_gyro_bias(ImuDeviceCal& cal, const float residual_dps[3]) {
+    // calibrated = m * (nominal - b) - r = m * (nominal - (b + m^-1 r))
+    const float* m = cal.gyro.m;
+    const double det = double(m[0]) * (double(m[4]) * m[8] - double(m[5]) * m[7]) -
+                       double(m[1]) * (double(m[3]) * m[8] - double(m[5]) * m[6]) +
+                       double(m[2]) * (double(m[3]) * m[7] - double(m[4]) * m[6]);
+    if (det == 0.0) return;
+    const double inv[9] = {
+        (double(m[4]) * m[8] - double(m[5]) * m[7]) / det, (double(m[2]) * m[7] - double(m[1]) * m[8]) / det,
+        (double(m[1]) * m[5] - double(m[2]) * m[4]) / det, (double(m[5]) * m[6] - double(m[3]) * m[8]) / det,
+        (double(m[0]) * m[8] - double(m[2]) * m[6]) / det, (double(m[2]) * m[3] - double(m[0]) * m[5]) / det,
+        (double(m[3]) * m[7] - double(m[4]) * m[6]) / det, (double(m[1]) * m[6] - double(m[0]) * m[7]) / det,
+        (double(m[0]) * m[4] - double(m[1]) * m[3]) / det,
+    };
+    for (int r = 0; r < 3; ++r) {
+        cal.gyro.bias[r] += float(inv[r * 3] * residual_dps[0] + inv[r * 3 + 1] * residual_dps[1] +
+                                  inv[r * 3 + 2] * residual_dps[2]);
+    }
+}
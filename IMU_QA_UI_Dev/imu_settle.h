@@ -0,0 +1,94 @@
+#pragma once
+#include "imu_calibration.h"
+#include "imu_stream_stats.h"
+#include "imu_types.h"
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+// What one settle phase says about a unit at rest on the fixture
+struct ImuSettleEstimate {
+    bool   valid = false;            // enough still data to use
+    float  gyro_bias_dps[3] = {0, 0, 0};
+    float  gravity_g[3]     = {0, 0, 0};
+    double gyro_sigma_dps   = 0.0;   // worst axis, how still the unit was
+    size_t accel_frames     = 0;
+    size_t gyro_frames      = 0;
+};
+
+// Mean of every axis over the settle frames after skip_s. The gyro mean is
+// the zero-rate bias left after the stored calibration; the accel mean is
+// gravity in the unit's frame. A unit that was not still (gyro sigma above
+// the stillness limit) or sent too few frames gives no estimate.
+//
+// Stillness is judged on a sliding window of gyro frames with running
+// sums, O(1) per frame. Sigma rather than magnitude, so an uncalibrated
+// unit with a large zero-rate bias still counts as still. Whenever the
+// window shows motion the estimate starts over from the frames after it.
+class ImuSettleEstimator {
+public:
+    ImuSettleEstimator(const ImuSettleConfig& cfg, double stillness_dps)
+        : cfg_(cfg), stillness_dps_(stillness_dps) {}
+
+    // Start over; frames before start_s + skip_s are ignored
+    void reset(double start_s);
+    void push(const ImuSample* s, size_t n);
+    // A full window of still gyro data and enough frames for an estimate
+    bool still() const;
+    ImuSettleEstimate estimate() const;
+
+private:
+    ImuSettleConfig cfg_;
+    double          stillness_dps_;
+    double          from_s_ = 0.0;
+    ImuRunningStats accel_[3], gyro_[3];
+
+    struct GyroFrame {
+        double t;
+        float  v[3];
+    };
+    std::deque<GyroFrame> window_;
+    double sum_[3] = {0, 0, 0}, sum_sq_[3] = {0, 0, 0};
+    bool   window_still_ = false;
+
+    void push_gyro(double t, const float v[3]);
+};
+
+// Settle phase of units armed together (run_test, run_soak): one estimator
+// each, and the point each unit's window may start. A unit is ready once
+// it is still (adaptive) or at limit_s; with common_start no unit starts
+// before all are ready. finish() ends a unit's settle and takes its
+// estimate (calibrate), which remove_bias() then applies (apply).
+class ImuBatchSettle {
+public:
+    ImuBatchSettle(const ImuSettleConfig& cfg, double stillness_dps, size_t units,
+                   double t0_s, double limit_s);
+
+    // Settle frames of unit i; ignored once its settle is over
+    void push(size_t i, const ImuSample* s, size_t n);
+    // Units whose window starts at now_s are appended to started
+    void poll(double now_s, bool common_start, std::vector<size_t>& started);
+    const ImuSettleEstimate& finish(size_t i);
+
+    bool settling(size_t i) const { return settling_[i] != 0; }
+    bool settling_any() const;
+    const ImuSettleEstimate& estimate(size_t i) const { return estimates_[i]; }
+    // Bias removal active for unit i
+    bool applied(size_t i) const { return cfg_.apply && estimates_[i].valid; }
+    void remove_bias(size_t i, ImuSample* s, size_t n) const;
+
+private:
+    ImuSettleConfig                 cfg_;
+    double                          limit_s_;
+    std::vector<ImuSettleEstimator> est_;
+    std::vector<ImuSettleEstimate>  estimates_;
+    std::vector<char>               settling_;
+    std::vector<char>               ready_;
+};
+
+// Subtract a zero-rate bias from the gyro frames of a chunk
+void imu_remove_gyro_bias(ImuSample* s, size_t n, const float bias_dps[3]);
+
+// Fold a residual gyro bias (calibrated units) into cal, so that the
+// stored bias removes it from then on
+void imu_fold_gyro_bias(ImuDeviceCal& cal, const float residual_dps[3]);
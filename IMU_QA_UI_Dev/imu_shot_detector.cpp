@@ -0,0 +1,129 @@
+#include "imu_shot_detector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Frames needed before the noise estimate is trusted
+constexpr uint64_t kWarmupFrames = 32;
+
+} // namespace
+
+ImuShotDetector::ImuShotDetector(const ImuShotConfig& cfg) : cfg_(cfg) {}
+
+void ImuShotDetector::configure(const ImuShotConfig& cfg) {
+    cfg_ = cfg;
+    reset();
+}
+
+void ImuShotDetector::reset() {
+    baseline_ = 1.0;
+    noise_    = 0.0;
+    last_t_   = 0.0;
+    warm_     = 0;
+    in_shot_  = false;
+    peak_g_   = 0.0f;
+    peak_dps_ = 0.0f;
+    last_dps_ = 0.0f;
+    refractory_until_ = 0.0;
+    shots_    = 0;
+}
+
+double ImuShotDetector::threshold_g() const {
+    return std::max(cfg_.min_threshold_g, cfg_.threshold_sigma * noise_);
+}
+
+bool ImuShotDetector::push(const ImuSample& s, ImuShotEvent& out) {
+    const double t = s.timestamp_s;
+    const bool accel = s.ax != 0.0f || s.ay != 0.0f || s.az != 0.0f;
+
+    if (!accel) {
+        float dps = std::sqrt(s.gx * s.gx + s.gy * s.gy + s.gz * s.gz);
+        last_dps_ = dps;
+        if (in_shot_) {
+            peak_dps_ = std::max(peak_dps_, dps);
+            if (t - start_s_ >= cfg_.max_duration_s) {
+                finish(t, out);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const double mag = std::sqrt(double(s.ax) * s.ax + double(s.ay) * s.ay + double(s.az) * s.az);
+    const double dev = std::fabs(mag - baseline_);
+
+    if (in_shot_) {
+        peak_g_ = std::max(peak_g_, static_cast<float>(mag));
+        if (dev > cfg_.release_ratio * threshold_) last_above_s_ = t;
+        if (t - last_above_s_ >= cfg_.quiet_s || t - start_s_ >= cfg_.max_duration_s) {
+            finish(t, out);
+            return true;
+        }
+        return false;
+    }
+
+    if (t < refractory_until_) {
+        last_t_ = t;
+        return false;
+    }
+
+    const double thr = threshold_g();
+    if (warm_ >= kWarmupFrames && dev > thr) {
+        in_shot_      = true;
+        start_s_      = t;
+        last_above_s_ = t;
+        threshold_    = thr;
+        peak_g_       = static_cast<float>(mag);
+        peak_dps_     = last_dps_;   // rotation often leads the accel peak
+        return false;
+    }
+
+    adapt(t, mag, dev);
+    return false;
+}
+
+void ImuShotDetector::adapt(double t, double mag, double dev) {
+    // First-order low pass with time constant baseline_tau_s; the first
+    // frames converge quickly by averaging
+    double a;
+    if (warm_ < kWarmupFrames) {
+        a = 1.0 / static_cast<double>(warm_ + 1);
+    } else {
+        double dt = std::clamp(t - last_t_, 0.0, cfg_.baseline_tau_s);
+        a = dt / (cfg_.baseline_tau_s + dt);
+    }
+    baseline_ += a * (mag - baseline_);
+    noise_    += a * (dev - noise_);
+    last_t_    = t;
+    ++warm_;
+}
+
+void ImuShotDetector::finish(double t, ImuShotEvent& out) {
+    out.timestamp_s = start_s_;
+    out.duration_s  = last_above_s_ - start_s_;
+    out.peak_g      = peak_g_;
+    out.peak_dps    = peak_dps_;
+    out.detected_s  = t;
+
+    in_shot_          = false;
+    refractory_until_ = t + cfg_.refractory_s;
+    last_t_           = t;
+    ++shots_;
+}
+
+int ImuMotionDetector::push(const ImuSample& s, float& rate_dps) {
+    if (s.gx == 0.0f && s.gy == 0.0f && s.gz == 0.0f) return 0;   // accel frame
+    rate_dps = std::sqrt(s.gx * s.gx + s.gy * s.gy + s.gz * s.gz);
+    if (rate_dps > motion_dps_) {
+        last_motion_s_ = s.timestamp_s;
+        if (!moving_) {
+            moving_ = true;
+            return 1;
+        }
+    } else if (moving_ && s.timestamp_s - last_motion_s_ >= hold_s_) {
+        moving_ = false;
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "imu_types.h"
+
+// Streaming recoil detector for one device, fed every decoded frame.
+//
+// |a| is compared with a slowly adapting baseline (~1 g at rest). A shot
+// starts when the deviation exceeds max(min_threshold_g, threshold_sigma *
+// noise), where noise is the running mean absolute deviation, and ends once
+// the deviation stays below release_ratio * threshold for quiet_s. Baseline
+// and noise only adapt outside shots and refractory periods, so recoil does
+// not raise its own threshold. Gyro frames contribute the peak rate.
+//
+// O(1) per frame and allocation free; not thread safe (one per device).
+class ImuShotDetector {
+public:
+    explicit ImuShotDetector(const ImuShotConfig& cfg = ImuShotConfig{});
+
+    void configure(const ImuShotConfig& cfg);
+    void reset();
+
+    // Returns true and fills `out` when this frame closes a shot
+    bool push(const ImuSample& s, ImuShotEvent& out);
+
+    bool   in_shot() const      { return in_shot_; }
+    double threshold_g() const;
+    double baseline_g() const   { return baseline_; }
+    uint64_t shot_count() const { return shots_; }
+
+private:
+    ImuShotConfig cfg_;
+
+    // Baseline / noise tracking
+    double   baseline_  = 1.0;
+    double   noise_     = 0.0;
+    double   last_t_    = 0.0;
+    uint64_t warm_      = 0;   // accel frames folded into the baseline
+
+    // Current event
+    bool   in_shot_     = false;
+    double start_s_     = 0.0;
+    double last_above_s_ = 0.0;
+    double threshold_   = 0.0;  // frozen at trigger time
+    float  peak_g_      = 0.0f;
+    float  peak_dps_    = 0.0f;
+    float  last_dps_    = 0.0f;  // most recent gyro magnitude
+
+    double   refractory_until_ = 0.0;
+    uint64_t shots_            = 0;
+
+    void adapt(double t, double mag, double dev);
+    void finish(double t, ImuShotEvent& out);
+};
+
+// Moving / still state from the gyro frames, with hysteresis in time:
+// one frame above motion_dps starts motion, hold_s below it ends it.
+class ImuMotionDetector {
+public:
+    void configure(double motion_dps, double hold_s) {
+        motion_dps_ = motion_dps;
+        hold_s_     = hold_s;
+        reset();
+    }
+    void reset() {
+        moving_ = false;
+        last_motion_s_ = 0.0;
+    }
+
+    // +1 when motion starts, -1 when it ends, 0 otherwise; rate_dps is |w|
+    int push(const ImuSample& s, float& rate_dps);
+
+    bool moving() const { return moving_; }
+
+private:
+    double motion_dps_    = 20.0;
+    double hold_s_        = 0.2;
+    bool   moving_        = false;
+    double last_motion_s_ = 0.0;
+};
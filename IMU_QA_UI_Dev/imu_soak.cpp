@@ -0,0 +1,180 @@
+#include "imu_soak.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double kHourSeconds = 3600.0;
+
+inline bool is_accel(const ImuSample& s) {
+    return s.ax != 0.0f || s.ay != 0.0f || s.az != 0.0f;
+}
+
+inline QaStatus worse(QaStatus a, QaStatus b) {
+    return static_cast<int>(a) > static_cast<int>(b) ? a : b;
+}
+
+} // namespace
+
+ImuSoakTracker::ImuSoakTracker(const std::string& device_id, const ImuQaConfig& cfg)
+    : id_(device_id), cfg_(cfg) {}
+
+void ImuSoakTracker::push(const ImuSample* samples, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const ImuSample& s = samples[i];
+
+        if (!hour_started_) {
+            hour_.start_s = s.timestamp_s;
+            hour_started_ = true;
+        } else if (s.timestamp_s - hour_.start_s >= kHourSeconds) {
+            close_hour();
+            hour_.start_s = s.timestamp_s;
+        }
+
+        if (is_accel(s)) {
+            double mag   = std::sqrt(double(s.ax) * s.ax + double(s.ay) * s.ay + double(s.az) * s.az);
+            double pitch = imu_pitch_deg(s.ax, s.ay, s.az);
+            double roll  = imu_roll_deg(s.ay, s.az);
+            if (!have_ref_) {
+                ref_pitch_ = pitch;
+                ref_roll_  = roll;
+                have_ref_  = true;
+            }
+
+            cur_.gravity.push(mag);
+            cur_.pitch.push(pitch);
+            cur_.roll.push(roll);
+            cur_.pitch_trend.push(s.timestamp_s, pitch);
+            cur_.roll_trend.push(s.timestamp_s, roll);
+
+            double dev = std::max(std::fabs(pitch - ref_pitch_), std::fabs(roll - ref_roll_));
+            cur_.max_dev_deg = std::max(cur_.max_dev_deg, dev);
+            if (dev > cfg_.abnormal_threshold_deg) ++cur_.abnormal;
+
+            hour_.pitch.push(pitch);
+            hour_.roll.push(roll);
+        } else {
+            const float g[3] = {s.gx, s.gy, s.gz};
+            for (int k = 0; k < 3; ++k) {
+                cur_.gyro[k].push(g[k]);
+                hour_.gyro[k].push(g[k]);
+            }
+        }
+    }
+}
+
+void ImuSoakTracker::set_reference(const float gravity_g[3]) {
+    ref_pitch_ = imu_pitch_deg(gravity_g[0], gravity_g[1], gravity_g[2]);
+    ref_roll_  = imu_roll_deg(gravity_g[1], gravity_g[2]);
+    have_ref_  = true;
+}
+
+ImuSoakWindow ImuSoakTracker::close_window(double start_s, double end_s, double gap_seconds) {
+    ImuSoakWindow w{};
+    w.index          = windows_;
+    w.start_s        = start_s;
+    w.end_s          = end_s;
+    w.accel_samples  = cur_.gravity.n;
+    w.gyro_samples   = cur_.gyro[0].n;
+    w.gravity_mean_g = cur_.gravity.mean;
+    w.tilt_sigma_deg = std::max(cur_.pitch.sigma(), cur_.roll.sigma());
+    // Slopes are per second
+    w.tilt_drift_deg_per_min = 60.0 * std::max(std::fabs(cur_.pitch_trend.slope()),
+                                               std::fabs(cur_.roll_trend.slope()));
+    w.mac_deg        = cur_.max_dev_deg;
+    w.abnormal_count = cur_.abnormal;
+    w.gyro_sigma_dps = 0.0;
+    for (int k = 0; k < 3; ++k) {
+        w.gyro_bias_dps[k] = cur_.gyro[k].mean;
+        w.gyro_sigma_dps   = std::max(w.gyro_sigma_dps, cur_.gyro[k].sigma());
+    }
+    w.gap_seconds = gap_seconds;
+    w.status      = grade(w);
+
+    // Next window is judged against this one's attitude
+    if (cur_.pitch.n > 0) {
+        ref_pitch_ = cur_.pitch.mean;
+        ref_roll_  = cur_.roll.mean;
+    }
+
+    ++windows_;
+    worst_       = worse(worst_, w.status);
+    worst_mac_   = std::max(worst_mac_, w.mac_deg);
+    worst_sigma_ = std::max(worst_sigma_, w.tilt_sigma_deg);
+    if (cur_.gravity.n > 0) gravity_all_.push(cur_.gravity.mean);
+    abnormal_all_ += w.abnormal_count;
+    samples_all_  += w.accel_samples + w.gyro_samples;
+    gap_all_      += gap_seconds;
+    span_all_     += end_s - start_s;
+
+    cur_ = Window{};
+    return w;
+}
+
+void ImuSoakTracker::close_hour() {
+    const double mid = hour_.start_s + 0.5 * kHourSeconds;
+    if (hour_.pitch.n > 0) {
+        pitch_hourly_.push(mid, hour_.pitch.mean);
+        roll_hourly_.push(mid, hour_.roll.mean);
+    }
+    if (hour_.gyro[0].n > 0) {
+        for (int k = 0; k < 3; ++k) gyro_hourly_[k].push(mid, hour_.gyro[k].mean);
+    }
+    ++hours_closed_;
+    hour_ = Hour{};
+}
+
+double ImuSoakTracker::tilt_trend_deg_per_hour() const {
+    return kHourSeconds * std::max(std::fabs(pitch_hourly_.slope()),
+                                   std::fabs(roll_hourly_.slope()));
+}
+
+double ImuSoakTracker::gyro_bias_trend_dps_per_hour() const {
+    double worst = 0.0;
+    for (const auto& t : gyro_hourly_) worst = std::max(worst, std::fabs(t.slope()));
+    return kHourSeconds * worst;
+}
+
+QaStatus ImuSoakTracker::grade(const ImuSoakWindow& w) const {
+    const double span = w.end_s - w.start_s;
+    if (w.accel_samples == 0 || w.gyro_samples == 0) return QaStatus::FAIL;
+    if (span > 0.0 && (span - w.gap_seconds) / span < cfg_.min_coverage) return QaStatus::FAIL;
+
+    if (std::fabs(w.gravity_mean_g - 1.0) > cfg_.gravity_deviation_g) return QaStatus::FAIL;
+    if (w.tilt_sigma_deg > cfg_.max_noise_sigma_deg)                  return QaStatus::FAIL;
+    if (w.tilt_drift_deg_per_min > cfg_.max_drift_deg_per_min)        return QaStatus::FAIL;
+    if (w.mac_deg > cfg_.max_mac_deg)                                 return QaStatus::FAIL;
+    if (w.abnormal_count > cfg_.max_abnormal_per_window)              return QaStatus::FAIL;
+
+    for (double b : w.gyro_bias_dps) {
+        if (std::fabs(b) > cfg_.gyro_stillness_deg_per_s) return QaStatus::WARN;
+    }
+    if (w.gap_seconds > 0.0) return QaStatus::WARN;
+    return QaStatus::PASS;
+}
+
+ImuQaResult ImuSoakTracker::final_result() const {
+    ImuQaResult res{};
+    res.device_id         = id_;
+    res.status            = windows_ > 0 ? worst_ : QaStatus::FAIL;
+    res.sample_count      = samples_all_;
+    res.mac_deg           = worst_mac_;
+    res.noise_sigma       = worst_sigma_;
+    res.drift_deg_per_min = tilt_trend_deg_per_hour() / 60.0;
+    res.gravity_mean_g    = gravity_all_.mean;
+    res.abnormal_count    = abnormal_all_;
+    res.gap_seconds       = gap_all_;
+    res.coverage          = span_all_ > 0.0 ? std::max(0.0, span_all_ - gap_all_) / span_all_ : 0.0;
+    res.diff_mac_deg           = std::numeric_limits<double>::quiet_NaN();
+    res.diff_noise_sigma       = std::numeric_limits<double>::quiet_NaN();
+    res.diff_drift_deg_per_min = std::numeric_limits<double>::quiet_NaN();
+    res.reference_lag_s        = std::numeric_limits<double>::quiet_NaN();
+    res.spur_axis              = -1;
+
+    // Long-term drift only means something with a few hourly points
+    if (hours_closed_ >= 2 && res.drift_deg_per_min > cfg_.max_drift_deg_per_min) {
+        res.status = QaStatus::FAIL;
+    }
+    return res;
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include "imu_stream_stats.h"
+#include "imu_types.h"
+#include <string>
+#include <vector>
+
+struct ImuSoakConfig {
+    double      duration_hours   = 8.0;
+    double      interim_minutes  = 10.0;   // one interim verdict per window
+    std::string output_directory = "qa_soak";
+
+    // Rolling compressed raw capture (see ImuCaptureWriter)
+    bool   capture_raw          = true;
+    double capture_roll_minutes = 60.0;
+};
+
+// Metrics and verdict for one interim window of one device
+struct ImuSoakWindow {
+    int      index;
+    double   start_s;
+    double   end_s;
+    uint64_t accel_samples;
+    uint64_t gyro_samples;
+    double   gravity_mean_g;
+    double   tilt_sigma_deg;          // max of pitch / roll sigma
+    double   tilt_drift_deg_per_min;  // max |slope| of pitch / roll
+    double   mac_deg;                 // max deviation from the reference attitude
+    int      abnormal_count;
+    double   gyro_bias_dps[3];
+    double   gyro_sigma_dps;          // max over axes
+    double   gap_seconds;
+    QaStatus status;
+};
+
+// Streaming per-device soak statistics in constant memory: samples are
+// folded into the current window's running stats and discarded; closing a
+// window yields its verdict and feeds the hourly drift trend.
+class ImuSoakTracker {
+public:
+    ImuSoakTracker(const std::string& device_id, const ImuQaConfig& cfg);
+
+    void push(const ImuSample* samples, size_t count);
+
+    // Reference attitude from the settle gravity estimate instead of the
+    // first sample
+    void set_reference(const float gravity_g[3]);
+
+    ImuSoakWindow close_window(double start_s, double end_s, double gap_seconds);
+
+    // Overall verdict: worst window, hourly trend as drift
+    ImuQaResult final_result() const;
+
+    // Slopes of the hourly means, per hour
+    double tilt_trend_deg_per_hour() const;
+    double gyro_bias_trend_dps_per_hour() const;
+
+    const std::string& id() const { return id_; }
+
+private:
+    struct Window {
+        ImuRunningStats gravity;
+        ImuRunningStats pitch;
+        ImuRunningStats roll;
+        ImuLinearTrend  pitch_trend;
+        ImuLinearTrend  roll_trend;
+        ImuRunningStats gyro[3];
+        double          max_dev_deg = 0.0;
+        int             abnormal    = 0;
+    };
+
+    struct Hour {
+        double          start_s = 0.0;
+        ImuRunningStats pitch;
+        ImuRunningStats roll;
+        ImuRunningStats gyro[3];
+    };
+
+    std::string id_;
+    ImuQaConfig cfg_;
+
+    Window cur_;
+    Hour   hour_;
+    bool   hour_started_ = false;
+
+    // Attitude the window is compared against: first sample, then the
+    // previous window's mean
+    bool   have_ref_  = false;
+    double ref_pitch_ = 0.0;
+    double ref_roll_  = 0.0;
+
+    ImuLinearTrend pitch_hourly_;
+    ImuLinearTrend roll_hourly_;
+    ImuLinearTrend gyro_hourly_[3];
+    int            hours_closed_ = 0;
+
+    // Aggregate over all windows for final_result()
+    int              windows_      = 0;
+    QaStatus         worst_        = QaStatus::PASS;
+    double           worst_mac_    = 0.0;
+    double           worst_sigma_  = 0.0;
+    ImuRunningStats  gravity_all_;
+    int              abnormal_all_ = 0;
+    uint64_t         samples_all_  = 0;
+    double           gap_all_      = 0.0;
+    double           span_all_     = 0.0;
+
+    void close_hour();
+    QaStatus grade(const ImuSoakWindow& w) const;
+};
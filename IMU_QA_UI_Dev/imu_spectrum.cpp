@@ -0,0 +1,196 @@
+#include "imu_spectrum.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Neighbours either side a spur is compared with, and the Hann main lobe
+// (+-2 bins) that is left out of that comparison
+constexpr int kSpurSpan  = 8;
+constexpr int kSpurGuard = 2;
+
+// Plain product; std::complex operator* adds NaN / inf recovery that keeps
+// the butterflies from vectorising
+inline std::complex<float> cmul(std::complex<float> a, std::complex<float> b) {
+    return {a.real() * b.real() - a.imag() * b.imag(),
+            a.real() * b.imag() + a.imag() * b.real()};
+}
+
+inline bool is_pow2(size_t n) { return n >= 4 && (n & (n - 1)) == 0; }
+
+} // namespace
+
+ImuRealFft::ImuRealFft(size_t n) {
+    if (!is_pow2(n)) {
+        size_t p = 4;
+        while (p < n) p <<= 1;
+        n = p;
+    }
+    n_ = n;
+    m_ = n / 2;
+
+    int bits = 0;
+    while ((size_t(1) << bits) < m_) ++bits;
+    rev_.resize(m_);
+    for (size_t j = 0; j < m_; ++j) {
+        uint32_t r = 0;
+        for (int b = 0; b < bits; ++b) r |= uint32_t((j >> b) & 1u) << (bits - 1 - b);
+        rev_[j] = r;
+    }
+
+    tw_.resize(std::max<size_t>(m_ / 2, 1));
+    for (size_t j = 0; j < tw_.size(); ++j) {
+        const double a = -2.0 * kPi * double(j) / double(m_);
+        tw_[j] = {float(std::cos(a)), float(std::sin(a))};
+    }
+    split_.resize(m_ + 1);
+    for (size_t k = 0; k <= m_; ++k) {
+        const double a = -2.0 * kPi * double(k) / double(n_);
+        split_[k] = {float(std::cos(a)), float(std::sin(a))};
+    }
+    buf_.resize(m_);
+}
+
+void ImuRealFft::forward(const float* in, std::complex<float>* out) {
+    std::complex<float>* a = buf_.data();
+    for (size_t j = 0; j < m_; ++j) a[rev_[j]] = {in[2 * j], in[2 * j + 1]};
+
+    // Iterative decimation in time over the packed even / odd samples
+    for (size_t len = 2; len <= m_; len <<= 1) {
+        const size_t half = len / 2;
+        const size_t step = m_ / len;
+        for (size_t i = 0; i < m_; i += len) {
+            for (size_t j = 0; j < half; ++j) {
+                const std::complex<float> u = a[i + j];
+                const std::complex<float> v = cmul(a[i + j + half], tw_[j * step]);
+                a[i + j]        = u + v;
+                a[i + j + half] = u - v;
+            }
+        }
+    }
+
+    // X[k] = E[k] + W^k O[k], with E / O recovered from Z[k] and Z[m-k]*
+    for (size_t k = 0; k <= m_; ++k) {
+        const std::complex<float> zk  = a[k == m_ ? 0 : k];
+        const std::complex<float> zmk = std::conj(a[k == 0 ? 0 : m_ - k]);
+        const std::complex<float> e   = 0.5f * (zk + zmk);
+        const std::complex<float> d   = zk - zmk;
+        const std::complex<float> o   = {0.5f * d.imag(), -0.5f * d.real()};   // d / 2i
+        out[k] = e + cmul(split_[k], o);
+    }
+}
+
+ImuWelchPsd::ImuWelchPsd(size_t segment, double overlap) : fft_(segment) {
+    const size_t n = fft_.size();
+    overlap = std::clamp(overlap, 0.0, 0.9);
+    hop_ = std::max<size_t>(1, static_cast<size_t>(std::lround(double(n) * (1.0 - overlap))));
+
+    window_.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const double w = 0.5 - 0.5 * std::cos(2.0 * kPi * double(i) / double(n));
+        window_[i] = float(w);
+        window_power_ += w * w;
+    }
+    seg_.resize(n);
+    spec_.resize(n / 2 + 1);
+}
+
+size_t ImuWelchPsd::compute(const float* x, size_t n, double fs, std::vector<double>& psd) {
+    const size_t len = fft_.size();
+    psd.assign(bins(), 0.0);
+    if (n < len || fs <= 0.0) return 0;
+
+    size_t segments = 0;
+    for (size_t start = 0; start + len <= n; start += hop_) {
+        const float* s = x + start;
+        double mean = 0.0;
+        for (size_t i = 0; i < len; ++i) mean += s[i];
+        const float m = float(mean / double(len));
+        for (size_t i = 0; i < len; ++i) seg_[i] = (s[i] - m) * window_[i];
+
+        fft_.forward(seg_.data(), spec_.data());
+        for (size_t k = 0; k < spec_.size(); ++k) psd[k] += double(std::norm(spec_[k]));
+        ++segments;
+    }
+
+    // One-sided density: everything but DC and Nyquist counts twice
+    const double scale = 1.0 / (double(segments) * fs * window_power_);
+    for (size_t k = 0; k < psd.size(); ++k) {
+        psd[k] *= (k == 0 || k + 1 == psd.size()) ? scale : 2.0 * scale;
+    }
+    return segments;
+}
+
+ImuSpectrumAnalyzer::ImuSpectrumAnalyzer(const ImuSpectrumConfig& cfg)
+    : cfg_(cfg), welch_(cfg.segment, cfg.overlap) {}
+
+ImuSpectrumMetrics ImuSpectrumAnalyzer::analyze(const ImuSampleChunks& samples) {
+    ImuSpectrumMetrics m;
+
+    // Counts are scaled into the axis buffers in one pass per stream
+    double first[2] = {0.0, 0.0}, last[2] = {0.0, 0.0};
+    size_t count[2] = {0, 0};
+    for (int g = 0; g < 2; ++g) {
+        auto* ax = axis_ + 3 * g;
+        for (int k = 0; k < 3; ++k) ax[k].resize(samples.size());
+        count[g] = imu_unpack_axes(samples, g == 0, ax[0].data(), ax[1].data(), ax[2].data(),
+                                   &first[g], &last[g]);
+        for (int k = 0; k < 3; ++k) ax[k].resize(count[g]);
+    }
+
+    // Frames are stamped on arrival in BLE batches, so only the mean rate
+    // over the run is meaningful; the PSD treats frames as evenly spaced
+    auto rate = [&](int g) {
+        return count[g] > 1 && last[g] > first[g] ? double(count[g] - 1) / (last[g] - first[g]) : 0.0;
+    };
+    m.accel_fs_hz = rate(0);
+    m.gyro_fs_hz  = rate(1);
+
+    bool any = false;
+    for (int a = 0; a < 6; ++a) {
+        const double fs  = a < 3 ? m.accel_fs_hz : m.gyro_fs_hz;
+        const size_t seg = welch_.compute(axis_[a].data(), axis_[a].size(), fs, psd_[a]);
+        if (seg == 0) continue;
+        m.segments = any ? std::min(m.segments, seg) : seg;
+        any = true;
+        band_and_spur(a, fs, m);
+    }
+    return m;
+}
+
+void ImuSpectrumAnalyzer::band_and_spur(int axis, double fs, ImuSpectrumMetrics& m) const {
+    const std::vector<double>& p = psd_[axis];
+    const int    top = int(p.size()) - 1;
+    const double df  = fs / double(welch_.segment());
+    const int lo = std::max(1, int(std::ceil(cfg_.band_lo_hz / df)));
+    const int hi = cfg_.band_hi_hz > 0.0 ? std::min(top, int(std::floor(cfg_.band_hi_hz / df))) : top;
+    if (lo > hi) return;
+
+    double energy = 0.0;
+    for (int k = lo; k <= hi; ++k) energy += p[k] * df;
+    const double rms = std::sqrt(energy);
+    if (axis < 3) m.accel_band_rms_g  = std::max(m.accel_band_rms_g, rms);
+    else          m.gyro_band_rms_dps = std::max(m.gyro_band_rms_dps, rms);
+
+    double around[2 * kSpurSpan];
+    for (int k = lo; k <= hi; ++k) {
+        if ((k > 1 && p[k] < p[k - 1]) || (k < top && p[k] < p[k + 1])) continue;   // local peaks only
+        int n = 0;
+        for (int j = k - kSpurSpan; j <= k + kSpurSpan; ++j) {
+            if (j < 1 || j > top || std::abs(j - k) <= kSpurGuard) continue;
+            around[n++] = p[j];
+        }
+        if (n < 4) continue;
+        std::nth_element(around, around + n / 2, around + n);
+        const double floor_psd = around[n / 2];
+        if (floor_psd <= 0.0) continue;
+        const double db = 10.0 * std::log10(p[k] / floor_psd);
+        if (db > m.spur_db) {
+            m.spur_db   = db;
+            m.spur_hz   = double(k) * df;
+            m.spur_axis = axis;
+        }
+    }
+}
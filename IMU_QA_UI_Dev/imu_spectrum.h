@@ -0,0 +1,83 @@
+#pragma once
+#include "imu_sample_arena.h"
+#include "imu_types.h"
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Radix-2 real FFT: an n/2-point complex FFT of the even/odd interleaved
+// input followed by the real split. Tables are built once per size; the
+// transform itself does not allocate.
+class ImuRealFft {
+public:
+    explicit ImuRealFft(size_t n = 256);   // power of two >= 4
+
+    size_t size() const { return n_; }
+
+    // out[0..n/2], unnormalised
+    void forward(const float* in, std::complex<float>* out);
+
+private:
+    size_t n_ = 0;
+    size_t m_ = 0;                          // complex length n/2
+    std::vector<uint32_t>            rev_;  // bit reversal of 0..m-1
+    std::vector<std::complex<float>> tw_;   // exp(-2 pi i j / m), j < m/2
+    std::vector<std::complex<float>> split_;// exp(-2 pi i k / n), k <= m/2
+    std::vector<std::complex<float>> buf_;
+};
+
+// Welch averaged periodogram: Hann windowed segments with the given
+// overlap, mean removed per segment, one-sided density in units^2 / Hz.
+class ImuWelchPsd {
+public:
+    explicit ImuWelchPsd(size_t segment = 256, double overlap = 0.5);
+
+    size_t segment() const { return fft_.size(); }
+    size_t bins() const    { return fft_.size() / 2 + 1; }
+
+    // psd gets bins() values, bin k at k * fs / segment. Returns the number
+    // of segments averaged (0 when x is shorter than one segment).
+    size_t compute(const float* x, size_t n, double fs, std::vector<double>& psd);
+
+private:
+    ImuRealFft                       fft_;
+    size_t                           hop_;
+    std::vector<float>               window_;
+    double                           window_power_ = 0.0;   // sum w^2
+    std::vector<float>               seg_;
+    std::vector<std::complex<float>> spec_;
+};
+
+struct ImuSpectrumMetrics {
+    double accel_fs_hz       = 0.0;
+    double gyro_fs_hz        = 0.0;
+    double accel_band_rms_g  = 0.0;   // worst axis
+    double gyro_band_rms_dps = 0.0;   // worst axis
+    double spur_db           = 0.0;
+    double spur_hz           = 0.0;
+    int    spur_axis         = -1;
+    size_t segments          = 0;     // fewest of any analysed axis
+};
+
+// Per-device noise spectrum of a run: Welch PSD of each accel and gyro axis
+// at the stream's mean frame rate, RMS inside the configured band and the
+// strongest narrow spur relative to the median of its neighbouring bins.
+// Buffers are reused between devices; not thread safe.
+class ImuSpectrumAnalyzer {
+public:
+    explicit ImuSpectrumAnalyzer(const ImuSpectrumConfig& cfg = ImuSpectrumConfig{});
+
+    ImuSpectrumMetrics analyze(const ImuSampleChunks& samples);
+
+    // PSD of the last analysed axis (0..5), bin k at k * fs / segment
+    const std::vector<double>& psd(int axis) const { return psd_[axis]; }
+
+private:
+    ImuSpectrumConfig   cfg_;
+    ImuWelchPsd         welch_;
+    std::vector<float>  axis_[6];
+    std::vector<double> psd_[6];
+
+    void band_and_spur(int axis, double fs, ImuSpectrumMetrics& m) const;
+};
@@ -0,0 +1,65 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+// Welford running mean / variance, O(1) memory
+struct ImuRunningStats {
+    uint64_t n    = 0;
+    double   mean = 0.0;
+    double   m2   = 0.0;
+    double   min  = std::numeric_limits<double>::infinity();
+    double   max  = -std::numeric_limits<double>::infinity();
+
+    void push(double x) {
+        ++n;
+        double d = x - mean;
+        mean += d / static_cast<double>(n);
+        m2   += d * (x - mean);
+        if (x < min) min = x;
+        if (x > max) max = x;
+    }
+
+    double variance() const { return n > 1 ? m2 / static_cast<double>(n - 1) : 0.0; }
+    double sigma() const    { return std::sqrt(variance()); }
+    void   reset()          { *this = ImuRunningStats{}; }
+};
+
+// Streaming least-squares slope of y over x. x is taken relative to the
+// first point so large host timestamps do not cost precision.
+struct ImuLinearTrend {
+    uint64_t n   = 0;
+    double   x0  = 0.0;
+    double   sx  = 0.0;
+    double   sy  = 0.0;
+    double   sxx = 0.0;
+    double   sxy = 0.0;
+
+    void push(double x, double y) {
+        if (n == 0) x0 = x;
+        x -= x0;
+        ++n;
+        sx  += x;
+        sy  += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+
+    double slope() const {
+        if (n < 2) return 0.0;
+        double dn  = static_cast<double>(n);
+        double den = dn * sxx - sx * sx;
+        return den != 0.0 ? (dn * sxy - sx * sy) / den : 0.0;
+    }
+
+    void reset() { *this = ImuLinearTrend{}; }
+};
+
+// Tilt angles from a gravity vector, degrees
+inline double imu_pitch_deg(double ax, double ay, double az) {
+    return std::atan2(-ax, std::sqrt(ay * ay + az * az)) * (180.0 / 3.14159265358979323846);
+}
+
+inline double imu_roll_deg(double ay, double az) {
+    return std::atan2(ay, az) * (180.0 / 3.14159265358979323846);
+}
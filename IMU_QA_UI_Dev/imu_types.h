@@ -1,7 +1,12 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 
+// Raw int16 counts per physical unit in the 0x08 (accel) / 0x0A (gyro) frames
+constexpr double kAccelCountsPerG  = 32768.0 / 16.0;
+constexpr double kGyroCountsPerDps = 28571.0 / 500.0;
+
 struct ImuSample {
     double timestamp_s;  // host time in seconds
     float ax, ay, az;
@@ -9,10 +14,302 @@ struct ImuSample {
     float temp;
 };
 
+// Interval without data from a device (stall or disconnect), host seconds
+struct ImuGap {
+    double start_s;
+    double end_s;
+    bool   open;   // still ongoing when queried
+};
+
+// What a full sample buffer does with new data
+enum class OverflowPolicy {
+    Block,        // producer waits (bounded) for the consumer to make room
+    DropOldest,   // discard the oldest samples
+    Decimate,     // halve the resolution of what is buffered
+    SpillToDisk   // move the oldest samples to a spill file
+};
+
+inline const char* overflow_policy_name(OverflowPolicy p) {
+    return p == OverflowPolicy::Block      ? "block" :
+           p == OverflowPolicy::DropOldest ? "drop-oldest" :
+           p == OverflowPolicy::Decimate   ? "decimate" : "spill";
+}
+
+// Memory limits for buffered samples (ImuSampleChunks::kFrameBytes each)
+struct ImuBufferConfig {
+    size_t session_queue_bytes  = 1u << 20;    // BLE callback -> drain queue, per device
+    size_t session_budget_bytes = 64u << 20;   // samples kept for one run, per device
+    size_t station_budget_bytes = 1u << 30;    // everything above, all devices together
+
+    OverflowPolicy policy          = OverflowPolicy::DropOldest;
+    double         block_timeout_s = 0.05;     // Block: longest a push may wait
+    std::string    spill_directory = "qa_spill";
+
+    // Accel + gyro frames/s per device; run buffers are pre-sized for
+    // this rate over test_seconds
+    double         expected_frame_rate_hz = 400.0;
+};
+
+// Per-buffer overflow accounting; every policy action is counted
+struct ImuOverflowStats {
+    uint64_t blocked   = 0;   // pushes that had to wait for room
+    uint64_t dropped   = 0;   // samples discarded (drop-oldest or block timeout)
+    uint64_t decimated = 0;   // samples removed by decimation
+    uint64_t spilled   = 0;   // samples moved to the spill file
+    size_t   peak_bytes = 0;
+
+    void add(const ImuOverflowStats& o) {
+        blocked   += o.blocked;
+        dropped   += o.dropped;
+        decimated += o.decimated;
+        spilled   += o.spilled;
+        peak_bytes = peak_bytes > o.peak_bytes ? peak_bytes : o.peak_bytes;
+    }
+    uint64_t total() const { return blocked + dropped + decimated + spilled; }
+};
+
+// Recoil shot detector, see ImuShotDetector
+struct ImuShotConfig {
+    bool   enabled         = true;
+    double threshold_sigma = 8.0;    // trigger at this many noise units above baseline
+    double min_threshold_g = 1.5;    // never trigger below this |a| deviation
+    double release_ratio   = 0.5;    // shot continues while above ratio * threshold
+    double quiet_s         = 0.005;  // below release this long ends the shot
+    double max_duration_s  = 0.100;  // force-close longer events
+    double refractory_s    = 0.050;  // no new trigger this long after a shot (caps ~15 shots/s)
+    double baseline_tau_s  = 0.5;    // adaptation time of baseline / noise
+};
+
+// One detected shot
+struct ImuShotEvent {
+    double timestamp_s;   // first frame above threshold
+    double duration_s;    // until the last frame above the release level
+    float  peak_g;        // max |a|
+    float  peak_dps;      // max |w| during the shot
+    double detected_s;    // host time of the frame that closed the shot
+};
+
+// Per-shot recoil analytics, see ImuRecoilAnalyzer. Axes depend on how
+// the unit is mounted on the firearm (0 = x, 1 = y, 2 = z).
+struct ImuRecoilConfig {
+    bool   enabled           = true;
+    int    pitch_axis        = 1;      // gyro axis of muzzle rise
+    int    yaw_axis          = 2;      // gyro axis of lateral movement
+    int    bore_axis         = 0;      // accel axis along the barrel
+    double pre_window_s      = 0.05;   // gyro bias / accel baseline before the shot
+    double post_window_s     = 0.30;   // recovery observed after the shot
+    double rtz_tolerance_deg = 0.5;    // back within this of the pre-shot attitude
+    double string_gap_s      = 5.0;    // a longer pause starts a new string
+    size_t history_frames    = 4096;   // frame ring, must cover pre + shot + post
+};
+
+// Recoil metrics of one shot
+struct ImuShotMetrics {
+    double timestamp_s;        // shot start
+    double completed_s;        // host time of the frame that completed the analysis
+    int    string_index;       // from 1
+    int    shot_index;         // within the string, from 1
+    double split_s;            // since the previous shot of the string, 0 for the first
+    double muzzle_rise_deg;    // peak pitch excursion, signed
+    double return_to_zero_s;   // shot start until pitch is back within tolerance, NaN if not seen
+    double lateral_deg;        // yaw at return to zero (end of the window otherwise)
+    double impulse_mps;        // integrated bore accel during the shot (recoil dv)
+    float  peak_g;
+    float  peak_dps;
+};
+
+// Pre/post-trigger burst capture around events, see ImuBurstCapture
+struct ImuBurstConfig {
+    bool   enabled        = true;
+    double pre_s          = 0.2;      // kept before the trigger
+    double post_s         = 0.2;      // kept after the (last) trigger
+    double max_record_s   = 2.0;      // retriggers extend a record up to this
+    double trigger_g      = 0.0;      // level trigger on | |a| - 1 g |, 0 = shots only
+    double trigger_dps    = 0.0;      // level trigger on |w|, 0 = off
+    double max_rate_hz    = 2000.0;   // accel + gyro frames/s, sizes the pre-trigger ring
+    size_t max_pending    = 256;      // completed records held until drained
+};
+
+// Mahony attitude filter, see ImuOrientationBank
+struct ImuOrientationConfig {
+    float kp = 1.0f;    // accel correction gain
+    float ki = 0.05f;   // gyro bias integration gain
+    float accel_gate_g = 0.2f;   // skip correction when | |a| - 1 g | exceeds this
+};
+
+// Differential evaluation against a known-good ("golden") unit on the same
+// fixture, see ImuDifferentialEvaluator. Both streams are averaged onto a
+// common time grid and the DUT tilt minus the reference tilt is graded,
+// which removes table vibration and temperature the units share.
+struct ImuReferenceConfig {
+    std::string device_id;          // golden unit's MAC; empty = absolute only
+    double      bin_s     = 0.01;   // grid spacing both streams are averaged onto
+    double      max_lag_s = 0.05;   // arrival skew searched in either direction
+};
+
+// Welch noise spectrum per axis, see ImuSpectrumAnalyzer. Limits of 0
+// are not graded.
+struct ImuSpectrumConfig {
+    bool   enabled            = true;
+    size_t segment            = 256;     // FFT length, power of two
+    double overlap            = 0.5;     // of a segment, Hann windowed
+    double band_lo_hz         = 5.0;     // band energy / spur search range
+    double band_hi_hz         = 0.0;     // 0 = Nyquist
+    double max_gyro_band_dps  = 0.0;     // RMS in band, worst gyro axis -> FAIL
+    double max_accel_band_g   = 0.0;     // RMS in band, worst accel axis -> FAIL
+    // Narrow peak over the local floor -> WARN; 0 = report only. Opt-in
+    // (e.g. 20 dB), so fixtures not set up for it keep their verdicts
+    double max_spur_db        = 0.0;
+};
+
+// Shot / motion event delivery, see ImuEventBus
+struct ImuEventConfig {
+    size_t      queue_capacity = 4096;
+    bool        socket         = false;   // serve events to other processes (--events-socket)
+    std::string socket_path    = "/tmp/recoil_tracker_events.sock";   // Linux / macOS
+    uint16_t    tcp_port       = 47810;                              // Windows, loopback only
+    double      motion_dps     = 20.0;   // |w| above this is motion
+    double      motion_hold_s  = 0.2;    // below it this long ends the motion
+};
+
+// Live per-device state for dashboards, see ImuLiveStream. The waveform
+// resolution follows from the budget, so 50 units cost what 5 do.
+struct ImuLiveConfig {
+    bool        enabled     = false;   // opt-in (--live)
+    std::string socket_path = "/tmp/recoil_tracker_live.sock";   // Linux / macOS
+    uint16_t    tcp_port    = 47811;                             // Windows, loopback only
+    double      update_hz   = 10.0;
+    size_t      budget_bytes_per_s = 256u << 10;   // all devices together
+    // Min/max pairs per device and update. Samples carry their arrival
+    // time, so buckets much shorter than a connection event stay empty.
+    int         max_points  = 16;
+};
+
+// Where a worker thread runs; the defaults leave it to the OS
+struct ImuThreadPlacement {
+    int cpu         = -1;   // pin to this core, -1 = any
+    int rt_priority = 0;    // SCHED_FIFO 1..99 (time critical on Windows), 0 = normal
+};
+
+// Worker threads that keep processing off the BLE callbacks and the
+// run_test thread, see ImuExecutor
+struct ImuExecutorConfig {
+    // Opt-in (--executors): off, frames are decoded in the BLE callback and
+    // windows processed on the calling thread, with no extra threads
+    bool   enabled          = false;
+    ImuThreadPlacement decode;      // raw frames -> samples, detectors
+    ImuThreadPlacement analysis;    // per-window processing and evaluation
+    ImuThreadPlacement io;          // exporter writer and event dispatcher
+    bool   reserve_cores    = false;   // keep threads created later (BLE, dbus) off pinned cores
+    double decode_period_s  = 0.001;
+    size_t raw_queue_frames = 8192;    // per device, callback -> decode
+};
+
+// Per-unit sensor calibration, see ImuCalibrationStore. Units without an
+// entry keep the nominal scale.
+struct ImuCalibrationConfig {
+    bool        enabled = true;
+    std::string path    = "imu_calibration.csv";   // loaded once at startup
+};
+
+// Settle phase and in-fixture calibration, see ImuSettleEstimator. A unit
+// is still once its gyro sigma over still_window_s stays within
+// gyro_stillness_deg_per_s.
+struct ImuSettleConfig {
+    bool   adaptive    = true;    // start a unit's window once it is still
+    double still_window_s = 1.0;
+    bool   calibrate   = true;    // estimate gyro bias and gravity per unit
+    double skip_s      = 1.0;     // handling right after arming is not used
+    size_t min_frames  = 200;     // per sensor, fewer: no estimate
+    bool   apply       = true;    // remove the gyro bias from the window samples
+    bool   write_store = false;   // fold it into the calibration file as well
+};
+
+// Append-only results store, see ImuResultsDb; every run_test verdict is
+// added with the config hash, the unit's firmware and the test profile
+struct ImuResultsDbConfig {
+    bool        enabled = false;   // opt-in (--results-db); one writer per store
+    std::string path    = "qa_results/results.imur";
+};
+
+// Advertisement filtering during discovery, see ImuAdvRegistry. With a
+// prefilter set, an advertiser must match the name prefix or advertise the
+// service (UUID prefix) to be considered; both empty = no prefilter.
+struct ImuScanConfig {
+    std::string name_prefix;
+    std::string service_uuid;
+    double      rssi_alpha = 0.2;    // EWMA weight of each new RSSI reading
+    double      stale_s    = 15.0;   // not heard for this long: not offered a slot
+};
+
+// Forced link outage, stream seconds since the emulated link was created
+struct ImuLinkOutage {
+    double at_s;
+    double duration_s;
+};
+
+// BLE link conditions for ImuLinkEmulator. When enabled, discover_and_connect
+// runs emulated units over these conditions instead of scanning the radio;
+// the same seed gives the same delay / loss / outage decisions.
+struct ImuLinkConditions {
+    bool     enabled       = false;
+    uint64_t seed          = 1;
+    int      devices       = 4;        // emulated units
+    double   frame_rate_hz = 400.0;    // accel + gyro frames/s each unit sends
+
+    double interval_s        = 0.0075;  // connection interval
+    int    frames_per_event  = 6;       // notifications one connection event carries
+    double latency_s         = 0.002;   // host stack delay after the event
+    double jitter_s          = 0.001;   // mean of an exponential extra delay per event
+    double spike_prob        = 0.0;     // per event: the radio misses events ...
+    double spike_s           = 0.1;     // ... for this long, frames pile up behind
+    double loss              = 0.0;     // share of notifications lost
+    double loss_burst        = 1.0;     // mean notifications per loss run
+    double reorder           = 0.0;     // per notification: swapped with the one before
+    double disconnect_mean_s = 0.0;     // mean up time between random outages, 0 = none
+    double outage_s          = 2.0;     // length of a random outage
+    std::vector<ImuLinkOutage> outages; // plus these, in order
+};
+
 struct ImuQaConfig {
-    double settle_seconds = 5.0;
+    std::string profile = "default";   // test profile name, stored with each result
+
+    double settle_seconds = 5.0;   // longest settle; adaptive settle ends sooner
     double test_seconds   = 60.0;
 
+    // Send 0xF0 before re-enabling pooled sessions at the start of a run
+    bool   reset_on_rearm = false;
+
+    // Print each unit's first samples after its verdict and every shot as
+    // it is detected (debugging)
+    bool   verbose = false;
+
+    // Stream watchdog: no frame for this long while streaming is a dropout,
+    // which is recorded as a gap and recovered in the background
+    double stall_timeout_s        = 1.0;
+    bool   auto_reconnect         = true;
+    // Extend the test window by the longest dropout, up to this much
+    bool   extend_window_on_gap   = true;
+    double max_window_extension_s = 15.0;
+    // Share of test_seconds that must be covered by data, otherwise FAIL
+    double min_coverage           = 0.95;
+
+    ImuBufferConfig buffers;
+    ImuShotConfig   shots;
+    ImuRecoilConfig recoil;
+    ImuBurstConfig  bursts;
+    ImuOrientationConfig orientation;
+    ImuReferenceConfig reference;
+    ImuSpectrumConfig  spectrum;
+    ImuExecutorConfig  executors;
+    ImuEventConfig  events;
+    ImuLiveConfig   live;
+    ImuScanConfig   scan;
+    ImuCalibrationConfig calibration;
+    ImuSettleConfig settle;
+    ImuResultsDbConfig results_db;
+    ImuLinkConditions emulation;   // replaces the radio when enabled
+
     double abnormal_threshold_deg   = 0.30;
     double gravity_deviation_g      = 0.05;
     double gyro_stillness_deg_per_s = 0.5;
@@ -28,13 +325,41 @@ enum class QaStatus {
     FAIL
 };
 
+inline const char* qa_status_name(QaStatus s) {
+    return s == QaStatus::PASS ? "PASS" :
+           s == QaStatus::WARN ? "WARN" : "FAIL";
+}
+
 struct ImuQaResult {
     std::string device_id;  // MAC or serial
     QaStatus    status;
+    size_t      sample_count;
     double      mac_deg;      // angle stability
     double      noise_sigma;  // σ
     double      drift_deg_per_min;
     double      gravity_mean_g;
     int         abnormal_count;
+    int         gap_count;
+    double      gap_seconds;   // inside the test window
+    double      coverage;      // data time / test_seconds, capped at 1
+    int         reconnects;
+    ImuOverflowStats overflow;   // session queue + run buffer
+    int         shot_count;    // recoil events seen during the run
+    // Same metrics on DUT minus reference unit; NaN without a reference
+    double      diff_mac_deg;
+    double      diff_noise_sigma;
+    double      diff_drift_deg_per_min;
+    double      reference_lag_s;   // alignment applied to the reference stream
+    // Noise spectrum, see ImuSpectrumConfig
+    double      gyro_band_rms_dps;
+    double      accel_band_rms_g;
+    double      spur_db;       // strongest narrow peak over its neighbours, 0 if none
+    double      spur_hz;
+    int         spur_axis;     // 0..2 accel x/y/z, 3..5 gyro x/y/z, -1 none
+    // Settle-phase estimate; when settle_calibrated the gyro bias was
+    // removed from the window samples
+    bool        settle_calibrated;
+    double      settle_gyro_bias_dps[3];
+    double      settle_gravity_g[3];
     // add fields as needed
 };
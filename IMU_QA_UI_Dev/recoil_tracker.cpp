@@ -1,28 +1,264 @@
+#include "imu_link_emulator.h"
 #include "imu_qa_manager.h"
+#include "imu_result_exporter.h"
+#include "imu_results_db.h"
 #include "imu_types.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <iostream>
 
-int main() {
-    ImuQaConfig cfg;
-    // TODO: load from JSON instead of hardcoding
+#ifdef _WIN32
+#include <conio.h>
+#endif
 
-    ImuQaManager manager(cfg);
+// Run tag used to name the export files, e.g. 20250114_153012
+static std::string make_run_tag() {
+    std::time_t now = std::time(nullptr);
+    std::tm tm{};
+#ifdef _WIN32
+    localtime_s(&tm, &now);
+#else
+    localtime_r(&now, &tm);
+#endif
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y%m%d_%H%M%S", &tm);
+    return buf;
+}
+
+#ifdef _WIN32
+static const char* kExitHint = "ESC or Backspace to exit";
+#else
+static const char* kExitHint = "q + Enter to exit";
+#endif
 
+// Returns false when the operator asks to exit
+static bool wait_for_continue() {
+#ifdef _WIN32
+    int ch = _getch();
+    std::cout << "\n";
+    return !(ch == 27 || ch == 8);
+#else
+    std::string line;
+    if (!std::getline(std::cin, line)) return false;
+    return !(line == "q" || line == "Q");
+#endif
+}
+
+// recoil_tracker --soak <hours> [--interim <minutes>]
+static int run_soak_mode(ImuQaManager& manager, ImuResultExporter& exporter,
+                         const ImuSoakConfig& soak) {
     if (!manager.discover_and_connect(10)) {
+        manager.shutdown();
         return 1;
     }
 
-    auto results = manager.run_test();
+    if (!exporter.open("soak_" + make_run_tag())) {
+        std::cerr << "Export disabled, results will only be printed.\n";
+    }
+
+    auto results = manager.run_soak(soak);
+
+    std::cout << "\n=== SOAK RESULTS ===\n";
+    for (const auto& r : results) {
+        std::cout << r.device_id << " -> " << qa_status_name(r.status) << "\n";
+    }
+
+    exporter.close();
+    manager.shutdown();
+    return 0;
+}
+
+// recoil_tracker --pipeline <batches> [--batch-size <n>] [--max-links <n>]
+// (two fixtures in turn, no operator prompts between batches)
+static int run_pipeline_mode(ImuQaManager& manager, ImuResultExporter& exporter,
+                             const ImuPipelineConfig& pipe) {
+    if (!exporter.open("pipeline_" + make_run_tag())) {
+        std::cerr << "Export disabled, results will only be printed.\n";
+    }
 
-    std::cout << "\n=== QA RESULTS ===\n";
+    auto results = manager.run_pipeline(pipe);
+
+    std::cout << "\n=== PIPELINE RESULTS ===\n";
     for (const auto& r : results) {
-        std::cout << r.device_id << " -> "
-                  << (r.status == QaStatus::PASS ? "PASS" :
-                      r.status == QaStatus::WARN ? "WARN" : "FAIL")
-                  << "\n";
+        std::cout << r.device_id << " -> " << qa_status_name(r.status) << "\n";
+    }
+
+    exporter.close();
+    manager.shutdown();
+    return results.empty() ? 1 : 0;
+}
+
+// recoil_tracker [--results-db <path>] --history <mac>: a unit's stored
+// verdicts, newest first (qa_results/results.imur without --results-db)
+static int run_history_mode(const ImuQaConfig& cfg, const std::string& mac) {
+    ImuResultsDb db;
+    if (!db.open(cfg.results_db.path)) return 1;
+    const auto entries = db.history(mac, 50);
+    std::cout << mac << ": " << entries.size() << " result(s)\n";
+    for (const auto& e : entries) {
+        ImuResultRecord rec;
+        if (!db.read(e, rec)) continue;
+        const std::time_t t = std::time_t(rec.time_us / 1000000);
+        std::tm tm{};
+#ifdef _WIN32
+        localtime_s(&tm, &t);
+#else
+        localtime_r(&t, &tm);
+#endif
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm);
+        const auto& r = rec.result;
+        std::printf("  %s  %-4s  MAC %.4f°  σ %.4f°  drift %.4f°/min  coverage %.1f%%  fw %s  profile %s  cfg %016llx\n",
+                    stamp, qa_status_name(r.status), r.mac_deg, r.noise_sigma, r.drift_deg_per_min,
+                    r.coverage * 100.0, rec.firmware.empty() ? "-" : rec.firmware.c_str(),
+                    rec.profile.c_str(), (unsigned long long)rec.config_hash);
     }
+    return 0;
+}
 
-    // TODO: write CSV
+// recoil_tracker --yield <days>: daily PASS / WARN / FAIL counts
+static int run_yield_mode(const ImuQaConfig& cfg, int days) {
+    ImuResultsDb db;
+    if (!db.open(cfg.results_db.path)) return 1;
+    const int64_t day_us = int64_t(86400) * 1000000;
+    const int64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    const int64_t end_us = (now_us / day_us + 1) * day_us;   // UTC days
+    for (const auto& b : db.yield(end_us - days * day_us, end_us, day_us)) {
+        const uint32_t total = b.pass + b.warn + b.fail;
+        if (total == 0) continue;
+        const std::time_t t = std::time_t(b.start_us / 1000000);
+        std::tm tm{};
+#ifdef _WIN32
+        gmtime_s(&tm, &t);
+#else
+        gmtime_r(&t, &tm);
+#endif
+        char day[16];
+        std::strftime(day, sizeof(day), "%Y-%m-%d", &tm);
+        std::printf("%s  %6u tested  %6u PASS  %6u WARN  %6u FAIL  yield %.1f%%\n", day, total,
+                    b.pass, b.warn, b.fail, 100.0 * b.pass / total);
+    }
     return 0;
 }
 
+// recoil_tracker [options]
+// (--reference <mac> names the golden unit for run_test grading;
+//  --emulate <clean|busy|lossy|flaky|worst> [--seed <n>] runs emulated
+//  units over those link conditions instead of the radio;
+//  --write-cal stores each unit's settle-phase gyro bias in the
+//  calibration file; --results-db, --events-socket and --live turn on
+//  the results store, the event socket and the dashboard stream;
+//  --executors moves decoding and analysis onto worker threads)
+int main(int argc, char** argv) {
+    ImuQaConfig cfg;
+    // TODO: load from JSON instead of hardcoding
+
+    ImuSoakConfig soak;
+    bool soak_mode = false;
+    ImuPipelineConfig pipe;
+    std::string history_mac;
+    int yield_days = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--soak") == 0 && i + 1 < argc) {
+            soak.duration_hours = std::atof(argv[++i]);
+            soak_mode = soak.duration_hours > 0.0;
+        } else if (std::strcmp(argv[i], "--interim") == 0 && i + 1 < argc) {
+            soak.interim_minutes = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--reference") == 0 && i + 1 < argc) {
+            cfg.reference.device_id = argv[++i];
+        } else if (std::strcmp(argv[i], "--emulate") == 0 && i + 1 < argc &&
+                   imu_link_profile(argv[i + 1], cfg.emulation)) {
+            cfg.emulation.enabled = true;
+            ++i;
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            cfg.emulation.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--write-cal") == 0) {
+            cfg.settle.write_store = true;
+        } else if (std::strcmp(argv[i], "--events-socket") == 0 && i + 1 < argc) {
+            cfg.events.socket      = true;
+            cfg.events.socket_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--live") == 0 && i + 1 < argc) {
+            cfg.live.enabled     = true;
+            cfg.live.socket_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--max-spur-db") == 0 && i + 1 < argc) {
+            cfg.spectrum.max_spur_db = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--executors") == 0) {
+            cfg.executors.enabled = true;
+        } else if (std::strcmp(argv[i], "--verbose") == 0) {
+            cfg.verbose = true;
+        } else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            cfg.profile = argv[++i];
+        } else if (std::strcmp(argv[i], "--results-db") == 0 && i + 1 < argc) {
+            cfg.results_db.enabled = true;
+            cfg.results_db.path    = argv[++i];
+        } else if (std::strcmp(argv[i], "--history") == 0 && i + 1 < argc) {
+            history_mac = argv[++i];
+        } else if (std::strcmp(argv[i], "--yield") == 0 && i + 1 < argc) {
+            yield_days = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--pipeline") == 0 && i + 1 < argc) {
+            pipe.batches = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--batch-size") == 0 && i + 1 < argc) {
+            pipe.batch_size = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--max-links") == 0 && i + 1 < argc) {
+            pipe.max_connections = std::atoi(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--reference <mac>] [--soak <hours> [--interim <minutes>]]"
+                         " [--emulate <clean|busy|lossy|flaky|worst> [--seed <n>]] [--write-cal]"
+                         " [--pipeline <batches> [--batch-size <n>] [--max-links <n>]]"
+                         " [--profile <name>] [--results-db <path>] [--history <mac>] [--yield <days>]"
+                         " [--max-spur-db <dB>] [--events-socket <path>]"
+                         " [--live <path>] [--executors] [--verbose]\n";
+            return 1;
+        }
+    }
+
+    // Queries of the results store need no radio or manager
+    if (!history_mac.empty()) return run_history_mode(cfg, history_mac);
+    if (yield_days > 0) return run_yield_mode(cfg, yield_days);
+
+    ImuExportConfig export_cfg;
+    ImuResultExporter exporter(export_cfg);
+
+    // One manager for the whole session so connected units are reused
+    // between cycles instead of being rescanned and reconnected each time.
+    ImuQaManager manager(cfg);
+    manager.set_exporter(&exporter);
+
+    if (soak_mode) return run_soak_mode(manager, exporter, soak);
+    if (pipe.batches > 0) return run_pipeline_mode(manager, exporter, pipe);
+
+    while (true) {
+        if (!manager.discover_and_connect(10)) {
+            std::cout << "\nPress Enter to retry, " << kExitHint << "...";
+            if (!wait_for_continue()) break;
+            continue;
+        }
+
+        if (!exporter.open(make_run_tag())) {
+            std::cerr << "Export disabled, results will only be printed.\n";
+        }
+
+        auto results = manager.run_test();
+
+        std::cout << "\n=== QA RESULTS ===\n";
+        for (const auto& r : results) {
+            std::cout << r.device_id << " -> " << qa_status_name(r.status) << "\n";
+        }
+
+        exporter.close();
+        std::cout << "Exported " << exporter.samples_written() << " samples, "
+                  << exporter.bursts_written() << " burst records ("
+                  << exporter.bytes_written() << " bytes)\n";
+
+        std::cout << "\nPress Enter to test again, " << kExitHint << "...";
+        if (!wait_for_continue()) break;
+    }
+
+    manager.shutdown();
+    return 0;
+}